@@ -0,0 +1,539 @@
+#include "division_engine/canvas/animator.hpp"
+#include "division_engine/canvas/components/render_bounds.hpp"
+#include "division_engine/canvas/components/render_order.hpp"
+#include "division_engine/canvas/components/renderable_rect.hpp"
+#include "division_engine/canvas/components/renderable_text.hpp"
+#include "division_engine/canvas/flat_layout.hpp"
+#include "division_engine/canvas/rect.hpp"
+#include "division_engine/canvas/rect_drawer.hpp"
+#include "division_engine/canvas/render_manager.hpp"
+#include "division_engine/canvas/render_order_index.hpp"
+#include "division_engine/canvas/state.hpp"
+#include "division_engine/canvas/text_drawer.hpp"
+#include "division_engine/canvas/view_tree/any_view.hpp"
+#include "division_engine/canvas/view_tree/decorated_box.hpp"
+#include "division_engine/canvas/view_tree/flat_render.hpp"
+#include "division_engine/canvas/view_tree/keyed_list.hpp"
+#include "division_engine/canvas/view_tree/padding.hpp"
+#include "division_engine/canvas/view_tree/sized_box.hpp"
+#include "division_engine/color.hpp"
+#include "division_engine/core/core_runner.hpp"
+
+#include <flecs.h>
+#include <glm/vec2.hpp>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <span>
+#include <string>
+#include <tuple>
+#include <vector>
+
+using namespace division_engine;
+using namespace division_engine::canvas;
+using namespace division_engine::canvas::components;
+using namespace division_engine::canvas::view_tree;
+using namespace division_engine::core;
+
+const auto FONT_PATH =
+    std::filesystem::path { "resources" } / "fonts" / "Roboto-Medium.ttf";
+
+const size_t BATCH_RENDERER_COUNT = 10'000;
+const size_t ORDER_RENDERER_COUNT = 100'000;
+const size_t CREATION_RENDERER_COUNT = 100'000;
+const size_t ORDER_FRAME_COUNT = 100;
+const size_t ORDER_MOVES_PER_FRAME = 10;
+const size_t VIEW_ITEM_COUNT = 10'000;
+const size_t VIEW_FRAME_COUNT = 20;
+const auto LAYOUT_ITEM_COUNTS = std::array { size_t { 10'000 }, size_t { 100'000 } };
+const size_t LAYOUT_FRAME_COUNT = 20;
+const auto LAYOUT_THREAD_COUNTS = std::array { 1, 2, 4, 8 };
+const size_t ANIMATION_TWEEN_COUNT = 50'000;
+const size_t ANIMATION_FRAME_COUNT = 20;
+// Long enough for none of the tweens to finish while measured
+const float ANIMATION_DURATION = 1000;
+const float ANIMATION_FRAME_TIME = 1.f / 60;
+const auto VIEW_SCREEN_RECT = Rect::from_bottom_left(glm::vec2 { 0 }, glm::vec2 { 512 });
+
+struct Velocity
+{
+    glm::vec2 value;
+};
+
+template<typename TFunc>
+double measure_ms(size_t iterations, TFunc&& func)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++)
+    {
+        func();
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    return std::chrono::duration<double, std::milli>(elapsed).count() /
+           static_cast<double>(iterations);
+}
+
+void print_row(const std::string& name, double ms, const std::string& details = "")
+{
+    std::cout << std::left << std::setw(40) << name << std::right << std::setw(10)
+              << std::fixed << std::setprecision(3) << ms << " ms  " << details
+              << std::endl;
+}
+
+// Interleaved rect and text renderers with different component lists, as the
+// view_tree renderers create them. Without the registry every change of the
+// component list made a new batch
+void benchmark_batches(DivisionContext* context)
+{
+    for (const auto shared_batches : { false, true })
+    {
+        State state { context };
+        RenderManager render_manager;
+        render_manager.register_renderer<RectDrawer>(state);
+        render_manager.register_renderer<TextDrawer>(state, FONT_PATH);
+
+        const auto bounds = Rect::from_center(glm::vec2 { 0 }, glm::vec2 { 8 });
+
+        const auto create_ms = measure_ms(
+            1,
+            [&]
+            {
+                for (size_t i = 0; i < BATCH_RENDERER_COUNT; i++)
+                {
+                    if (i % 2 == 0)
+                    {
+                        if (!shared_batches)
+                        {
+                            render_manager
+                                .new_batch<RenderableRect, RenderBounds, Velocity>(state);
+                        }
+                        render_manager.create_renderer(
+                            state,
+                            std::make_tuple(
+                                RenderableRect { .color = color::RED },
+                                RenderBounds { bounds },
+                                Velocity { glm::vec2 { 1 } }
+                            )
+                        );
+                    }
+                    else
+                    {
+                        if (!shared_batches)
+                        {
+                            render_manager.new_batch<RenderBounds, RenderableText>(state);
+                        }
+                        render_manager.create_renderer(
+                            state,
+                            std::make_tuple(
+                                RenderBounds { bounds }, RenderableText { .text = "Text" }
+                            )
+                        );
+                    }
+                }
+            }
+        );
+
+        const auto frame_ms = measure_ms(1, [&] { render_manager.update(state); });
+
+        const auto* world_info = ecs_get_world_info(state.world.c_ptr());
+        const auto details = "tables: " + std::to_string(world_info->table_count) +
+                             ", batches: " +
+                             std::to_string(render_manager.batch_count()) +
+                             ", passes: " +
+                             std::to_string(state.render_queue.pass_count());
+
+        const std::string name =
+            shared_batches ? "batches, registry" : "batches, new per call";
+        print_row(name + ": create", create_ms);
+        print_row(name + ": first frame", frame_ms, details);
+    }
+}
+
+// Renderers created one by one and in bulk. The bulk path writes the tables
+// once and takes a single order range
+void benchmark_creation(DivisionContext* context)
+{
+    const auto bounds = Rect::from_center(glm::vec2 { 0 }, glm::vec2 { 8 });
+
+    {
+        State state { context };
+        RenderManager render_manager;
+
+        const auto create_ms = measure_ms(
+            1,
+            [&]
+            {
+                for (size_t i = 0; i < CREATION_RENDERER_COUNT; i++)
+                {
+                    render_manager.create_renderer(
+                        state,
+                        std::make_tuple(
+                            RenderableRect { .color = color::RED },
+                            RenderBounds { bounds }
+                        )
+                    );
+                }
+            }
+        );
+
+        const auto renderers = "renderers: " + std::to_string(CREATION_RENDERER_COUNT);
+        print_row("create_renderer", create_ms, renderers);
+    }
+
+    {
+        State state { context };
+        RenderManager render_manager;
+
+        std::vector<RenderableRect> rects(
+            CREATION_RENDERER_COUNT, RenderableRect { .color = color::RED }
+        );
+        std::vector<RenderBounds> render_bounds(CREATION_RENDERER_COUNT);
+        for (auto& renderer_bounds : render_bounds)
+        {
+            renderer_bounds.value = bounds;
+        }
+
+        const auto create_ms = measure_ms(
+            1,
+            [&]
+            {
+                render_manager.create_renderers(
+                    state,
+                    std::make_tuple(std::span { rects }, std::span { render_bounds })
+                );
+            }
+        );
+
+        const auto renderers = "renderers: " + std::to_string(CREATION_RENDERER_COUNT);
+        print_row("create_renderers", create_ms, renderers);
+    }
+}
+
+// Sorted iteration of renderers animated every frame, through a flecs
+// order_by query and through the order index the drawers keep. The index
+// path scatters the unsorted tables into the slots, as the drawers do
+void benchmark_order(DivisionContext* context)
+{
+    State state { context };
+    RenderManager render_manager;
+
+    std::vector<RenderableRect> rects(ORDER_RENDERER_COUNT);
+    std::vector<RenderBounds> bounds(ORDER_RENDERER_COUNT);
+    const auto renderers = render_manager.create_renderers(
+        state, std::make_tuple(std::span { rects }, std::span { bounds })
+    );
+
+    auto animated = state.world.query<RenderBounds>();
+    auto sorted = state.world.query_builder<const RenderOrder, const RenderBounds>()
+                      .order_by<RenderOrder>(
+                          [](flecs::entity_t,
+                             const RenderOrder* x,
+                             flecs::entity_t,
+                             const RenderOrder* y) -> int
+                          {
+                              const auto x_key = x->sort_key();
+                              const auto y_key = y->sort_key();
+                              return static_cast<int>(x_key > y_key) -
+                                     static_cast<int>(x_key < y_key);
+                          }
+                      )
+                      .build();
+    auto unsorted = state.world.query<const RenderBounds>();
+
+    RenderOrderIndex order_index;
+    order_index.observe(state.world, [](auto&& builder) { return builder; });
+
+    std::vector<float> sorted_x(ORDER_RENDERER_COUNT);
+    size_t frame = 0;
+    const auto animate = [&](size_t move_count)
+    {
+        animated.each([](RenderBounds& bounds) { bounds.value.center.x += 1; });
+        for (size_t i = 0; i < move_count; i++)
+        {
+            const auto index = (frame * move_count + i) * 7919 % renderers.size();
+            render_manager.move_to_top(
+                state, flecs::entity { state.world, renderers[index] }, 0
+            );
+        }
+        frame++;
+    };
+
+    for (const auto move_count : { size_t { 0 }, ORDER_MOVES_PER_FRAME })
+    {
+        const auto order_by_ms = measure_ms(
+            ORDER_FRAME_COUNT,
+            [&]
+            {
+                animate(move_count);
+
+                size_t slot = 0;
+                sorted.each([&](const RenderOrder&, const RenderBounds& bounds)
+                            { sorted_x[slot++] = bounds.value.center.x; });
+            }
+        );
+
+        const auto index_ms = measure_ms(
+            ORDER_FRAME_COUNT,
+            [&]
+            {
+                animate(move_count);
+
+                order_index.apply_pending();
+                unsorted.each(
+                    [&](flecs::entity entity, const RenderBounds& bounds)
+                    { sorted_x[order_index.slot(entity)] = bounds.value.center.x; }
+                );
+            }
+        );
+
+        const auto moves = std::to_string(move_count) + " moves";
+        print_row("order_by, " + moves, order_by_ms);
+        print_row("order index, " + moves, index_ms);
+    }
+}
+
+// The items cycle through three view types, so the list keeps them as AnyView
+AnyView make_any_item(size_t index)
+{
+    const auto box = DecoratedBox { .background_color = color::RED };
+    switch (index % 3)
+    {
+        case 0:
+            return box;
+        case 1:
+            return SizedBox { Size { 8, 8 }, box };
+        default:
+            return Padding { EdgeInsets::all(1), box };
+    }
+}
+
+// Builds the view tree and renders it every frame, as the view_tree example
+// does. The items of the typed list are all of the same type, so it measures
+// the list without the type erasure
+template<typename TItemView, typename TMakeItem>
+void benchmark_view_tree(
+    DivisionContext* context,
+    const std::string& name,
+    TMakeItem&& make_item
+)
+{
+    using list_type = KeyedList<size_t, TItemView>;
+
+    State state { context };
+    RenderManager render_manager;
+
+    const auto build = [&]
+    {
+        list_type view;
+        view.items.reserve(VIEW_ITEM_COUNT);
+        for (size_t i = 0; i < VIEW_ITEM_COUNT; i++)
+        {
+            view.items.push_back(typename list_type::Item {
+                .key = i,
+                .view = make_item(i),
+            });
+        }
+        return view;
+    };
+
+    auto view = build();
+    typename list_type::Renderer renderer { state, render_manager, view };
+
+    const auto build_ms = measure_ms(VIEW_FRAME_COUNT, [&] { view = build(); });
+    const auto frame_ms = measure_ms(
+        VIEW_FRAME_COUNT,
+        [&]
+        {
+            view = build();
+            auto rect = VIEW_SCREEN_RECT;
+            renderer.render(state, render_manager, rect, view);
+        }
+    );
+
+    const auto items = "items: " + std::to_string(VIEW_ITEM_COUNT);
+    print_row(name + ": build", build_ms, items);
+    print_row(name + ": build and render", frame_ms, items);
+}
+
+void benchmark_view_trees(DivisionContext* context)
+{
+    benchmark_view_tree<AnyView>(context, "any view tree", make_any_item);
+    benchmark_view_tree<SizedBox<DecoratedBox>>(
+        context,
+        "typed view tree",
+        [](size_t)
+        {
+            return SizedBox {
+                Size { 8, 8 }, DecoratedBox { .background_color = color::RED }
+            };
+        }
+    );
+}
+
+// Lays out the same unchanged tree every frame through the recursive `render`
+// and through the flat layout, with and without the task pool of the state
+void benchmark_layouts(DivisionContext* context)
+{
+    using item_type = Padding<SizedBox<DecoratedBox>>;
+    using list_type = KeyedList<size_t, item_type>;
+
+    for (const auto item_count : LAYOUT_ITEM_COUNTS)
+    {
+        State state { context };
+        RenderManager render_manager;
+
+        list_type view;
+        view.items.reserve(item_count);
+        for (size_t i = 0; i < item_count; i++)
+        {
+            view.items.push_back(list_type::Item {
+                .key = i,
+                .view = Padding {
+                    EdgeInsets::all(1),
+                    SizedBox {
+                        Size { 8, 8 },
+                        DecoratedBox { .background_color = color::RED },
+                    },
+                },
+            });
+        }
+
+        list_type::Renderer renderer { state, render_manager, view };
+        FlatLayout layout;
+
+        const auto recursive_ms = measure_ms(
+            LAYOUT_FRAME_COUNT,
+            [&]
+            {
+                auto rect = VIEW_SCREEN_RECT;
+                renderer.render(state, render_manager, rect, view);
+            }
+        );
+        const auto flat_ms = measure_ms(
+            LAYOUT_FRAME_COUNT,
+            [&]
+            {
+                render_flat(
+                    state, render_manager, layout, renderer, view, VIEW_SCREEN_RECT
+                );
+            }
+        );
+
+        const auto items = std::to_string(item_count) + " items";
+        print_row("recursive layout, " + items, recursive_ms);
+        print_row("flat layout, " + items, flat_ms);
+
+        // The pool is sized with the world threads, like in the apps
+        for (const auto thread_count : LAYOUT_THREAD_COUNTS)
+        {
+            state.set_thread_count(thread_count);
+            const auto flat_pool_ms = measure_ms(
+                LAYOUT_FRAME_COUNT,
+                [&]
+                {
+                    render_flat(
+                        state,
+                        render_manager,
+                        layout,
+                        renderer,
+                        view,
+                        VIEW_SCREEN_RECT,
+                        &state.task_pool()
+                    );
+                }
+            );
+
+            const auto threads = "threads: " + std::to_string(thread_count);
+            print_row("flat layout with pool, " + items, flat_pool_ms, threads);
+        }
+    }
+}
+
+// Renderers moved by the animator every frame. The advance and the write
+// systems are run on their own and as a part of the whole frame
+void benchmark_animator(DivisionContext* context)
+{
+    State state { context };
+    RenderManager render_manager;
+    render_manager.register_renderer<RectDrawer>(state);
+
+    for (size_t i = 0; i < ANIMATION_TWEEN_COUNT; i++)
+    {
+        const auto position = glm::vec2 { static_cast<float>(i % 512), 0 };
+        const auto renderer = render_manager.create_renderer(
+            state,
+            std::make_tuple(
+                RenderableRect { .color = color::RED },
+                RenderBounds { Rect::from_center(position, glm::vec2 { 4 }) }
+            )
+        );
+        state.animator.move_to(
+            renderer,
+            position + glm::vec2 { 0, 512 },
+            ANIMATION_DURATION,
+            Easing::Linear
+        );
+    }
+    render_manager.update(state);
+
+    const auto systems = state.animator.systems();
+    const auto advance_ms = measure_ms(
+        ANIMATION_FRAME_COUNT, [&] { systems[0].run(ANIMATION_FRAME_TIME); }
+    );
+    const auto write_ms = measure_ms(
+        ANIMATION_FRAME_COUNT, [&] { systems[1].run(ANIMATION_FRAME_TIME); }
+    );
+    const auto frame_ms = measure_ms(
+        ANIMATION_FRAME_COUNT, [&] { state.world.progress(ANIMATION_FRAME_TIME); }
+    );
+
+    const auto tweens = "tweens: " + std::to_string(state.animator.size());
+    print_row("animator: advance", advance_ms, tweens);
+    print_row("animator: write", write_ms, tweens);
+    print_row("animator: frame", frame_ms, tweens);
+}
+
+// Runs every benchmark in the first frame, then exits
+struct BenchmarkManager
+{
+    DivisionContext* context;
+
+    void draw()
+    {
+        benchmark_batches(context);
+        benchmark_creation(context);
+        benchmark_order(context);
+        benchmark_view_trees(context);
+        benchmark_layouts(context);
+        benchmark_animator(context);
+        std::exit(EXIT_SUCCESS);
+    }
+
+    void error(int error_code, const char* error_message)
+    {
+        std::cerr << "Error code: " << error_code << ". Message: " << error_message
+                  << std::endl;
+    }
+};
+
+struct BenchmarkManagerBuilder
+{
+    BenchmarkManager* build(DivisionContext* context)
+    {
+        return new BenchmarkManager { context };
+    }
+};
+
+int main(int argc, char** argv)
+{
+    const size_t WINDOW_SIZE = 512;
+    CoreRunner { "Benchmark", { WINDOW_SIZE, WINDOW_SIZE } }.run(
+        BenchmarkManagerBuilder {}
+    );
+}
@@ -25,9 +25,12 @@
 #include <functional>
 #include <iostream>
 #include <locale>
+#include <span>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 using namespace division_engine;
 using namespace division_engine::canvas;
@@ -39,8 +42,10 @@ const size_t RECT_SIZE = 8;
 const size_t TEXT_RECT_SIZE = 256;
 
 const auto FONT_SIZE = 20;
+const uint32_t OVERLAY_LAYER = 1;
 const auto FONT_PATH =
     std::filesystem::path { "resources" } / "fonts" / "Roboto-Medium.ttf";
+const auto IMAGE_PATH = std::filesystem::path { "resources" } / "images" / "nevsky.jpg";
 
 struct Velocity
 {
@@ -56,41 +61,50 @@ struct MyManager
     MyManager operator=(MyManager&) = delete;
     ~MyManager() = default;
 
-    MyManager(DivisionContext* context_ptr)
-      : _state(context_ptr)
-      , _query(_state.world.query<RenderBounds, RenderableRect, Velocity>())
+    MyManager(DivisionContext* context_ptr, FrameScheduler& frame_scheduler)
+      : _state(
+            context_ptr,
+            color::WHITE,
+            static_cast<int32_t>(std::thread::hardware_concurrency()),
+            &frame_scheduler
+        )
     {
         _renderer_manager.register_renderer<RectDrawer>(_state);
         _renderer_manager.register_renderer<TextDrawer>(_state, FONT_PATH);
 
+        register_update_rects_system();
+
         const auto with_white_tex =
             _state.world.entity().set(RenderTexture { _state.white_texture_id });
 
-        _state.clear_color = color::WHITE;
-
         const auto screen_size = _state.context.get_screen_size();
 
+        std::vector<RenderableRect> rects(RECT_COUNT);
+        std::vector<RenderBounds> bounds(RECT_COUNT);
+        std::vector<Velocity> velocities(RECT_COUNT);
         for (int i = 0; i < RECT_COUNT; i++)
         {
-            _renderer_manager
-                .create_renderer(
-                    _state,
-                    std::make_tuple(
-                        RenderableRect {
-                            .color = glm::linearRand(color::WHITE, color::BLACK),
-                        },
-                        RenderBounds {
-                            Rect::from_center(
-                                glm::linearRand(glm::vec2 { 0 }, screen_size),
-                                glm::vec2 { RECT_SIZE }
-                            ),
-                        }
-                    ),
-                    with_white_tex.id()
-                )
-                .set(Velocity { glm::linearRand(glm::vec2 { -1 }, glm::vec2 { 1 }) });
+            rects[i] = RenderableRect {
+                .color = glm::linearRand(color::WHITE, color::BLACK),
+            };
+            bounds[i] = RenderBounds {
+                Rect::from_center(
+                    glm::linearRand(glm::vec2 { 0 }, screen_size),
+                    glm::vec2 { RECT_SIZE }
+                ),
+            };
+            velocities[i] =
+                Velocity { glm::linearRand(glm::vec2 { -1 }, glm::vec2 { 1 }) };
         }
 
+        _renderer_manager.create_renderers(
+            _state,
+            std::make_tuple(
+                std::span { rects }, std::span { bounds }, std::span { velocities }
+            ),
+            with_white_tex.id()
+        );
+
         _renderer_manager
             .create_renderer(
                 _state,
@@ -107,71 +121,121 @@ struct MyManager
             )
             .set(Velocity { glm::linearRand(glm::vec2 { -1 }, glm::vec2 { 1 }) });
 
-        _renderer_manager
-            .create_renderer(
-                _state,
-                std::make_tuple(
-                    RenderableRect {
-                        .color = color::RED,
-                        .border_radius = BorderRadius::all(10),
-                    },
-                    RenderBounds {
-                        Rect::from_center(
-                            glm::linearRand(glm::vec2 { 0 }, screen_size),
-                            glm::vec2 { 256 }
-                        ),
-                    }
-                ),
-                with_white_tex.id()
-            )
-            .set(Velocity { glm::linearRand(glm::vec2 { -1 }, glm::vec2 { 1 }) });
+        const auto image =
+            _renderer_manager
+                .create_renderer(
+                    _state,
+                    std::make_tuple(
+                        RenderableRect {
+                            .color = color::WHITE,
+                            .border_radius = BorderRadius::all(10),
+                        },
+                        RenderBounds {
+                            Rect::from_center(
+                                glm::linearRand(glm::vec2 { 0 }, screen_size),
+                                glm::vec2 { 256 }
+                            ),
+                        }
+                    ),
+                    _state.load_image(IMAGE_PATH).id()
+                )
+                .set(Velocity { glm::linearRand(glm::vec2 { -1 }, glm::vec2 { 1 }) });
+
+        // Only the radius is tweened, the bouncing system keeps moving the bounds
+        const auto round_radius = 128.f;
+        const auto round_duration = 2.f;
+        _state.animator.round_to(
+            image, BorderRadius::all(round_radius), round_duration, Easing::EaseOut
+        );
     }
 
     void draw()
     {
         _state.update();
+        draw_frame_counter();
         _renderer_manager.update(_state);
 
-        update_rects();
-
         _state.render_queue.draw(_state.context.get_ptr(), _state.clear_color);
     }
 
-    void update_rects()
+    void draw_frame_counter()
     {
         const auto screen_size = _state.context.get_screen_size();
+        const auto bounds = Rect::from_top_left(
+            glm::vec2 { 0, screen_size.y }, glm::vec2 { TEXT_RECT_SIZE, FONT_SIZE * 2 }
+        );
 
-        _query.each(
-            [screen_size](RenderBounds& bounds, RenderableRect& rect, Velocity& vel)
-            {
-                auto& rect_bounds = bounds.value;
-                auto& dir = vel.value;
+        _state.immediate.draw_rect(
+            bounds,
+            RenderableRect { .color = color::BLACK },
+            RenderOrder { 0, OVERLAY_LAYER },
+            _state.white_texture_id
+        );
+        _state.immediate.draw_text(
+            bounds,
+            "Frame " + std::to_string(_state.frame_count()),
+            color::WHITE,
+            FONT_SIZE,
+            RenderOrder { 1, OVERLAY_LAYER }
+        );
+    }
 
-                rect_bounds.center += dir;
-                if (rect_bounds.right() > screen_size.x)
-                {
-                    rect_bounds.set_right(screen_size.x);
-                    dir.x = -dir.x;
-                }
-                else if (rect_bounds.left() < 0)
+    // The bounds are written in place, so they are an inout term of the system
+    // and the drawers see the written tables as changed
+    void register_update_rects_system()
+    {
+        _state.world.system<RenderBounds, const RenderableRect, Velocity>()
+            .term_at(1)
+            .inout()
+            .kind(flecs::OnUpdate)
+            .multi_threaded()
+            .iter(
+                [this](
+                    flecs::iter& it,
+                    RenderBounds* bounds_ptr,
+                    const RenderableRect*,
+                    Velocity* velocity_ptr
+                )
                 {
-                    rect_bounds.set_left(0);
+                    const auto screen_size = _state.context.get_screen_size();
 
-                    dir.x = -dir.x;
+                    for (auto i : it)
+                    {
+                        update_rect(screen_size, bounds_ptr[i], velocity_ptr[i]);
+                    }
                 }
+            );
+    }
 
-                if (rect_bounds.top() > screen_size.y)
-                {
-                    rect_bounds.set_top(screen_size.y);
-                    dir.y = -dir.y;
-                }
-                else if (rect_bounds.bottom() < 0)
-                {
-                    rect_bounds.set_bottom(0);
-                    dir.y = -dir.y;
-                }
-            }
-        );
+    static void
+    update_rect(const glm::vec2& screen_size, RenderBounds& bounds, Velocity& vel)
+    {
+        auto& rect_bounds = bounds.value;
+        auto& dir = vel.value;
+
+        rect_bounds.center += dir;
+        if (rect_bounds.right() > screen_size.x)
+        {
+            rect_bounds.set_right(screen_size.x);
+            dir.x = -dir.x;
+        }
+        else if (rect_bounds.left() < 0)
+        {
+            rect_bounds.set_left(0);
+
+            dir.x = -dir.x;
+        }
+
+        if (rect_bounds.top() > screen_size.y)
+        {
+            rect_bounds.set_top(screen_size.y);
+            dir.y = -dir.y;
+        }
+        else if (rect_bounds.bottom() < 0)
+        {
+            rect_bounds.set_bottom(0);
+            dir.y = -dir.y;
+        }
     }
 
     void error(int error_code, const char* error_message)
@@ -181,7 +245,6 @@ struct MyManager
     }
 
     State _state;
-    flecs::query<RenderBounds, RenderableRect, Velocity> _query;
     RenderManager _renderer_manager;
 };
 
@@ -189,11 +252,17 @@ struct MyManagerBuilder
 {
     using manager_type = MyManager;
 
-    MyManager* build(DivisionContext* context) { return new MyManager { context }; }
+    FrameScheduler* frame_scheduler;
+
+    MyManager* build(DivisionContext* context)
+    {
+        return new MyManager { context, *frame_scheduler };
+    }
 };
 
 int main(int argc, char** argv)
 {
     const size_t WINDOW_SIZE = 512;
-    CoreRunner { "Canvas example", { WINDOW_SIZE, WINDOW_SIZE } }.run(MyManagerBuilder {});
+    CoreRunner core_runner { "Canvas example", { WINDOW_SIZE, WINDOW_SIZE } };
+    core_runner.run(MyManagerBuilder { &core_runner.frame_scheduler() });
 }
\ No newline at end of file
@@ -58,8 +58,9 @@ struct MyLifecycleManager
     MyLifecycleManager& operator=(const MyLifecycleManager&) = default;
     MyLifecycleManager& operator=(MyLifecycleManager&&) = delete;
 
-    MyLifecycleManager(DivisionContext* context)
+    MyLifecycleManager(DivisionContext* context, FrameScheduler& frame_scheduler)
       : _ctx(Context { context })
+      , _frame_scheduler(&frame_scheduler)
     {
         using std::filesystem::path;
 
@@ -166,9 +167,15 @@ struct MyLifecycleManager
 
     ~MyLifecycleManager() { std::cout << "Lifecycle manager was destroyed" << std::endl; }
 
+    // The scene is static, so the frames are drawn on resize only. The skipped
+    // frames are the idle wakeups of the run loop between them
     void draw()
     {
         _ctx.draw_render_passes({ &_render_pass, 1 }, { 1, 1, 1, 1 });
+
+        std::cout << "Drawn frames: " << _frame_scheduler->drawn_frame_count()
+                  << ", skipped frames: " << _frame_scheduler->skipped_frame_count()
+                  << std::endl;
     }
 
     void error(int32_t errorCode, const char* errorMessage)
@@ -184,17 +191,20 @@ private:
     DivisionIdWithBinding _white_texture {};
     DivisionRenderPassInstance _render_pass {};
     Context _ctx;
+    FrameScheduler* _frame_scheduler;
 };
 
 struct MyLifecycleManagerBuilder
 {
     using manager_type = MyLifecycleManager;
 
+    FrameScheduler* frame_scheduler;
+
     manager_type* build(DivisionContext* context)
     {
         std::cout << "Hello from lifecycle builder" << std::endl;
 
-        return new MyLifecycleManager { context };
+        return new MyLifecycleManager { context, *frame_scheduler };
     }
 };
 
@@ -206,5 +216,6 @@ int main(int argc, char** argv)
         { SCREEN_SIZE, SCREEN_SIZE },
     };
 
-    coreRunner.run(MyLifecycleManagerBuilder {});
+    coreRunner.frame_scheduler().set_mode(RenderMode::OnDemand);
+    coreRunner.run(MyLifecycleManagerBuilder { &coreRunner.frame_scheduler() });
 }
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "division_engine/canvas/border_radius.hpp"
+#include "division_engine/canvas/components/render_bounds.hpp"
 #include "division_engine/canvas/rect.hpp"
 #include "division_engine/canvas/rect_drawer.hpp"
 #include "division_engine/canvas/render_manager.hpp"
@@ -9,21 +10,27 @@
 #include "division_engine/canvas/view_tree/decorated_box.hpp"
 #include "division_engine/canvas/view_tree/list.hpp"
 #include "division_engine/canvas/view_tree/padding.hpp"
+#include "division_engine/canvas/view_tree/render_entities.hpp"
+#include "division_engine/canvas/view_tree/scroll.hpp"
 #include "division_engine/canvas/view_tree/sized_box.hpp"
 #include "division_engine/canvas/view_tree/stack.hpp"
+#include "division_engine/canvas/view_tree/static_view.hpp"
 #include "division_engine/canvas/view_tree/text.hpp"
 #include "division_engine/canvas/view_tree/view.hpp"
 #include "division_engine/canvas/view_tree/view_builder.hpp"
 #include "division_engine/color.hpp"
 #include "division_engine/core/context.hpp"
 #include "division_engine/core/core_runner.hpp"
+#include "division_engine/core/exception.hpp"
 #include "division_engine_core/context.h"
 #include "glm/ext/vector_float2.hpp"
 #include "glm/ext/vector_float4.hpp"
+#include "glm/gtc/epsilon.hpp"
 #include "glm/vec2.hpp"
 #include "glm/vec4.hpp"
 
 #include <chrono>
+#include <cmath>
 #include <filesystem>
 #include <iostream>
 #include <memory>
@@ -31,6 +38,7 @@
 #include <tuple>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 using namespace division_engine;
 using namespace core;
@@ -41,6 +49,56 @@ using std::filesystem::path;
 
 const path FONT_PATH = path { "resources" } / "fonts" / "Roboto-Regular.ttf";
 
+// Laid out at compile time, rendering it only moves the rects
+static constexpr auto LEGEND = SizedBox {
+    Size { 200, 60 },
+    Padding {
+        EdgeInsets::all(4),
+        HorizontalList {
+            DecoratedBox { .background_color = color::RED },
+            DecoratedBox { .background_color = color::GREEN },
+            DecoratedBox { .background_color = color::BLUE },
+        },
+    },
+};
+static_assert(StaticView<LEGEND>::LEAVES[1].rect == StaticRect { 68, -4, 64, 52 });
+
+// Renders LEGEND through the runtime layout of its views and checks that every
+// leaf gets the rect laid out at compile time
+void check_static_layout(State& state, RenderManager& render_manager)
+{
+    using legend_view_t = std::remove_cvref_t<decltype(LEGEND)>;
+    using static_view_t = StaticView<LEGEND>;
+
+    const auto size = glm::vec2 { static_view_t::SIZE };
+    const auto top_left = glm::vec2 { 0, size.y };
+    auto rect = Rect::from_top_left(top_left, size);
+
+    legend_view_t::Renderer renderer { state, render_manager, LEGEND };
+    renderer.render(state, render_manager, rect, LEGEND);
+
+    std::vector<flecs::entity> entities;
+    collect_render_entities(renderer, entities);
+    if (entities.size() != static_view_t::LEAVES.size())
+    {
+        throw core::Exception { "The static layout has a different leaf count" };
+    }
+
+    const auto edges = [](const Rect& r)
+    { return glm::vec4 { r.left(), r.top(), r.right(), r.bottom() }; };
+
+    const float EPSILON = 1e-3;
+    for (size_t i = 0; i < entities.size(); i++)
+    {
+        const auto expected = static_view_t::LEAVES[i].rect.to_rect(top_left);
+        const auto& actual = entities[i].get<components::RenderBounds>()->value;
+        if (!glm::all(glm::epsilonEqual(edges(actual), edges(expected), EPSILON)))
+        {
+            throw core::Exception { "The static layout differs from the runtime one" };
+        }
+    }
+}
+
 template<typename T>
 concept UIBuilder = requires(T t, State& state) {
                         {
@@ -53,6 +111,7 @@ struct MyUIBuilder
     using time_point_t = std::chrono::time_point<std::chrono::steady_clock>;
 
     time_point_t _prev_time = std::chrono::steady_clock::now();
+    float _scroll_offset = 0;
 
     View auto build_ui(State& state)
     {
@@ -63,6 +122,16 @@ struct MyUIBuilder
 
         _prev_time = now;
 
+        // Scrolling only writes the offset uniform, the rows keep their bounds
+        const auto row = [](glm::vec4 color)
+        {
+            return SizedBox {
+                Size { 100, 50 },
+                DecoratedBox { .background_color = color },
+            };
+        };
+        _scroll_offset = std::fmod(_scroll_offset + delta_ms * 0.05f, 200.f); // NOLINT
+
         return HorizontalList {
             SizedBox {
                 Size { 200, 100 },
@@ -75,6 +144,24 @@ struct MyUIBuilder
                     },
                 },
             },
+            StaticView<LEGEND> {},
+            SizedBox {
+                Size { 100, 200 },
+                Scroll {
+                    400,
+                    _scroll_offset,
+                    VerticalList {
+                        row(color::RED),
+                        row(color::GREEN),
+                        row(color::BLUE),
+                        row(color::BLACK),
+                        row(color::RED),
+                        row(color::GREEN),
+                        row(color::BLUE),
+                        row(color::BLACK),
+                    },
+                },
+            },
         };
     }
 };
@@ -98,6 +185,8 @@ public:
     {
         _render_manager.register_renderer<RectDrawer>(_state);
         _render_manager.register_renderer<TextDrawer>(_state, FONT_PATH);
+
+        check_static_layout(_state, _render_manager);
     }
 
     void draw()
@@ -0,0 +1,198 @@
+#pragma once
+
+#include "border_radius.hpp"
+#include "components/render_bounds.hpp"
+#include "components/renderable_rect.hpp"
+#include "components/renderable_text.hpp"
+#include "division_engine/core/frame_scheduler.hpp"
+
+#include <flecs.h>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace division_engine::canvas
+{
+enum class AnimatedProperty : uint8_t
+{
+    // Center of the bounds
+    Position,
+    // Size of the bounds, around the same center
+    Size,
+    // Color of the rect or of the text
+    Color,
+    BorderRadius,
+};
+
+enum class Easing : uint8_t
+{
+    Linear,
+    EaseIn,
+    EaseOut,
+    EaseInOut,
+};
+
+// Tweens of the renderer components. The running tweens are kept in dense
+// arrays and advanced in a single branchless sweep at the frame start, then
+// written to the tables of the animated renderers only. A finished tween is
+// removed by moving the last one into its place.
+// The view tree renderers write the props of their view only when the view
+// changes them, so a finished tween keeps its value until then.
+// With a frame scheduler, a new tween requests a frame and the running tweens
+// request the next one, so the on-demand mode draws every frame of a tween
+class Animator
+{
+public:
+    static constexpr size_t PROPERTY_COUNT = 4;
+    static constexpr uint32_t NO_TWEEN = std::numeric_limits<uint32_t>::max();
+
+    explicit Animator(core::FrameScheduler* frame_scheduler = nullptr)
+      : _frame_scheduler(frame_scheduler)
+    {
+    }
+
+    Animator(const Animator&) = delete;
+    Animator(Animator&&) = delete;
+    Animator& operator=(const Animator&) = delete;
+    Animator& operator=(Animator&&) = delete;
+    ~Animator();
+
+    // The tweens are advanced and written in the PreStore phase, after the user
+    // systems and before the renderers
+    void observe(flecs::world& world);
+
+    // Tweens the property from its current value to the target. A running
+    // tween of the property is replaced and continues from where it stopped.
+    // Throws when the renderer has no component with the property
+    void animate(
+        flecs::entity entity,
+        AnimatedProperty property,
+        const glm::vec4& target,
+        float duration,
+        Easing easing = Easing::EaseInOut
+    );
+
+    void move_to(
+        flecs::entity entity,
+        glm::vec2 center,
+        float duration,
+        Easing easing = Easing::EaseInOut
+    )
+    {
+        animate(
+            entity,
+            AnimatedProperty::Position,
+            glm::vec4 { center.x, center.y, 0, 0 },
+            duration,
+            easing
+        );
+    }
+
+    void resize_to(
+        flecs::entity entity,
+        glm::vec2 size,
+        float duration,
+        Easing easing = Easing::EaseInOut
+    )
+    {
+        animate(
+            entity,
+            AnimatedProperty::Size,
+            glm::vec4 { size.x, size.y, 0, 0 },
+            duration,
+            easing
+        );
+    }
+
+    void fade_to(
+        flecs::entity entity,
+        const glm::vec4& color,
+        float duration,
+        Easing easing = Easing::EaseInOut
+    )
+    {
+        animate(entity, AnimatedProperty::Color, color, duration, easing);
+    }
+
+    void round_to(
+        flecs::entity entity,
+        const BorderRadius& border_radius,
+        float duration,
+        Easing easing = Easing::EaseInOut
+    )
+    {
+        animate(
+            entity,
+            AnimatedProperty::BorderRadius,
+            border_radius.top_left_right_bottom,
+            duration,
+            easing
+        );
+    }
+
+    // The property keeps its current value
+    void stop(flecs::entity entity, AnimatedProperty property);
+
+    size_t size() const { return _entities.size(); }
+
+    // The system advancing the tweens, followed by the one writing them
+    std::span<flecs::system> systems() { return _systems; }
+
+private:
+    using RenderBounds = components::RenderBounds;
+    using RenderableRect = components::RenderableRect;
+    using RenderableText = components::RenderableText;
+
+    struct AnimatedEntity
+    {
+        flecs::entity_t entity;
+        std::array<uint32_t, PROPERTY_COUNT> tweens;
+    };
+
+    core::FrameScheduler* _frame_scheduler;
+    std::vector<flecs::system> _systems;
+
+    // The running tweens, one element of every array per tween
+    std::vector<flecs::entity_t> _entities;
+    std::vector<AnimatedProperty> _properties;
+    std::vector<glm::vec4> _from;
+    std::vector<glm::vec4> _delta;
+    std::vector<glm::vec4> _values;
+    std::vector<float> _elapsed;
+    std::vector<float> _inverse_durations;
+    // Every easing is a cubic of the progress without the constant term, so
+    // all the tweens are evaluated by the same code
+    std::vector<float> _ease1;
+    std::vector<float> _ease2;
+    std::vector<float> _ease3;
+
+    // Tweens of the animated renderers by the entity index
+    std::vector<AnimatedEntity> _animated;
+    // Tweens that reached their target, removed at the next frame start after
+    // the target is written
+    std::vector<uint32_t> _finished;
+
+    void advance(flecs::world& world, float delta_time);
+    void write(
+        flecs::iter& it,
+        RenderBounds* bounds,
+        RenderableRect* rects,
+        RenderableText* texts
+    ) const;
+
+    void remove_finished(flecs::world& world);
+    // Moves the last tween into the place of the removed one
+    void remove_tween(uint32_t tween);
+
+    AnimatedEntity& animated_entity(flecs::entity_t entity);
+    const AnimatedEntity* find_animated_entity(flecs::entity_t entity) const;
+
+    static glm::vec4 current_value(flecs::entity entity, AnimatedProperty property);
+};
+}
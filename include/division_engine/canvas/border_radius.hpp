@@ -8,11 +8,16 @@ struct BorderRadius
 {
     glm::vec4 top_left_right_bottom;
 
-    static BorderRadius none() { return BorderRadius { glm::vec4 { 0 } }; }
+    bool operator==(const BorderRadius&) const = default;
 
-    static BorderRadius all(float value) { return BorderRadius { glm::vec4 { value } }; }
+    static constexpr BorderRadius none() { return BorderRadius { glm::vec4 { 0 } }; }
 
-    static BorderRadius symmetric(float horizontal, float vertical)
+    static constexpr BorderRadius all(float value)
+    {
+        return BorderRadius { glm::vec4 { value } };
+    }
+
+    static constexpr BorderRadius symmetric(float horizontal, float vertical)
     {
         return BorderRadius { { vertical, horizontal, horizontal, vertical } };
     }
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "components/render_clip.hpp"
+#include "components/render_translation.hpp"
+#include "rect.hpp"
+#include "scroll_translations.hpp"
+
+#include <flecs.h>
+#include <glm/vec2.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+namespace division_engine::canvas
+{
+// Clip rects and scroll translations of the nested views. Every pushed rect is
+// intersected with the clips of the same translation, so the top of the stack
+// is the area the views are drawn in. Under a translation the clips are in the
+// content space and don't change with the offset, the outer ones make up the
+// viewport of the translation instead
+class ClipStack
+{
+public:
+    // The rect is in the space of the views being rendered
+    void push(const Rect& rect)
+    {
+        _rects.push_back(has_clip() ? _rects.back().intersected(rect) : rect);
+    }
+
+    void pop() { _rects.pop_back(); }
+
+    // Nothing is clipped when no rect is pushed under the current translation
+    std::optional<Rect> current() const
+    {
+        return has_clip() ? std::optional { _rects.back() } : std::nullopt;
+    }
+
+    // The current clip moved by the offset and cut by the viewport
+    std::optional<Rect> screen_clip() const
+    {
+        auto clip = current();
+        if (clip.has_value())
+        {
+            *clip = clip->translated(translation_offset());
+        }
+
+        if (!_translations.empty())
+        {
+            const auto& viewport = _translations.back().viewport;
+            clip = clip.has_value() ? clip->intersected(viewport) : viewport;
+        }
+
+        return clip;
+    }
+
+    // The offset is the overall one, including the offsets of the outer scrolls.
+    // The viewport is the screen area the translated views are cut by
+    void push_translation(uint32_t index, glm::vec2 offset, const Rect& viewport)
+    {
+        _translations.push_back(Translation {
+            .index = index,
+            .offset = offset,
+            .viewport = viewport,
+            .clip_base = _rects.size(),
+        });
+    }
+
+    void pop_translation() { _translations.pop_back(); }
+
+    uint32_t translation() const
+    {
+        return _translations.empty() ? ScrollTranslations::NO_TRANSLATION
+                                     : _translations.back().index;
+    }
+
+    glm::vec2 translation_offset() const
+    {
+        return _translations.empty() ? glm::vec2 { 0 } : _translations.back().offset;
+    }
+
+    // Sets the current clip and translation to the renderer, or removes them
+    // when nothing is clipped or translated
+    void apply(flecs::entity entity) const
+    {
+        set_clip(entity, current());
+        set_translation(entity, translation());
+    }
+
+    // An unchanged clip is not written
+    static void set_clip(flecs::entity entity, const std::optional<Rect>& clip_rect)
+    {
+        if (clip_rect.has_value())
+        {
+            const auto* clip = entity.get<components::RenderClip>();
+            if (clip == nullptr || clip->value != *clip_rect)
+            {
+                entity.set(components::RenderClip { *clip_rect });
+            }
+        }
+        else if (entity.has<components::RenderClip>())
+        {
+            entity.remove<components::RenderClip>();
+        }
+    }
+
+    // An unchanged translation is not written
+    static void set_translation(flecs::entity entity, uint32_t index)
+    {
+        if (index != ScrollTranslations::NO_TRANSLATION)
+        {
+            const auto* translation = entity.get<components::RenderTranslation>();
+            if (translation == nullptr || translation->index != index)
+            {
+                entity.set(components::RenderTranslation { index });
+            }
+        }
+        else if (entity.has<components::RenderTranslation>())
+        {
+            entity.remove<components::RenderTranslation>();
+        }
+    }
+
+private:
+    struct Translation
+    {
+        uint32_t index;
+        glm::vec2 offset;
+        Rect viewport;
+        // The rects below it belong to the outer translations
+        size_t clip_base;
+    };
+
+    std::vector<Rect> _rects;
+    std::vector<Translation> _translations;
+
+    bool has_clip() const
+    {
+        const auto clip_base =
+            _translations.empty() ? 0 : _translations.back().clip_base;
+        return _rects.size() > clip_base;
+    }
+};
+}
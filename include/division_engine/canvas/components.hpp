@@ -1,7 +1,10 @@
 #pragma once
 
+#include "components/animated.hpp"
 #include "components/render_batch.hpp"
+#include "components/render_clip.hpp"
 #include "components/render_order.hpp"
 #include "components/render_texture.hpp"
+#include "components/render_translation.hpp"
 #include "components/renderable_rect.hpp"
 #include "components/renderable_text.hpp"
\ No newline at end of file
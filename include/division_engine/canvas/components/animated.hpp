@@ -0,0 +1,10 @@
+#pragma once
+
+namespace division_engine::canvas::components
+{
+// Tags the renderers with running tweens. They are moved to their own tables,
+// so the animator visits and marks as changed only the animated renderers
+struct Animated
+{
+};
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "division_engine/core/input_event.hpp"
+
+#include <flecs.h>
+
+#include <functional>
+
+namespace division_engine::canvas::components
+{
+// Receives the pointer events of the renderer when it is the topmost one at
+// the event position
+struct PointerHandler
+{
+    std::function<void(flecs::entity entity, const core::InputEvent& event)> on_event;
+};
+}
@@ -4,6 +4,11 @@
 
 namespace division_engine::canvas::components
 {
+// Screen bounds of a renderer. The drawers and the damage tracker find the
+// changed bounds by the change detection of their tables, so the bounds are
+// written either by `set`, by `get_mut` followed by `modified`, or in place by
+// a system or a query that declares them as an inout term. A write through a
+// const or an `in` term isn't seen until the table changes otherwise
 struct RenderBounds
 {
     Rect value;
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "division_engine/canvas/rect.hpp"
+
+#include <glm/vec4.hpp>
+
+#include <limits>
+
+namespace division_engine::canvas::components
+{
+// Area the renderer is drawn in, in the space of its bounds, so the clips
+// under a scroll view don't change with the offset. The renderers outside of
+// it are culled, and the rest are cut by it in the vertex shaders
+struct RenderClip
+{
+    // Left, bottom, right, top of the renderers without a clip
+    static constexpr glm::vec4 NO_CLIP_RECT {
+        std::numeric_limits<float>::lowest(),
+        std::numeric_limits<float>::lowest(),
+        std::numeric_limits<float>::max(),
+        std::numeric_limits<float>::max(),
+    };
+
+    Rect value;
+
+    glm::vec4 clip_rect() const
+    {
+        return glm::vec4 { value.left(), value.bottom(), value.right(), value.top() };
+    }
+};
+}
@@ -1,16 +1,38 @@
 #pragma once
 
 #include <cstdint>
+#include <limits>
 
 namespace division_engine::canvas::components
 {
 struct RenderOrder
 {
+    // Orders of the same layer are handed out with a gap, so a renderer can be
+    // placed between two others without renumbering its neighbours
+    static constexpr uint32_t GAP = 1 << 8;
+    // Layer of the idle pooled renderers. They keep a RenderOrder and stay in
+    // their table, but the drawers and the indices skip them
+    static constexpr uint32_t IDLE_LAYER = std::numeric_limits<uint32_t>::max();
+
     uint32_t order;
+    uint32_t layer = 0;
+
+    static constexpr RenderOrder idle() { return RenderOrder { 0, IDLE_LAYER }; }
+
+    bool is_idle() const { return layer == IDLE_LAYER; }
+
+    uint64_t sort_key() const
+    {
+        return (static_cast<uint64_t>(layer) << 32) | static_cast<uint64_t>(order);
+    }
+
+    bool operator==(const RenderOrder&) const = default;
 
     int compare(const RenderOrder& other) const
     {
-        return static_cast<int>(order) - static_cast<int>(other.order);
+        const auto x = sort_key();
+        const auto y = other.sort_key();
+        return static_cast<int>(x > y) - static_cast<int>(x < y);
     }
 };
-}
\ No newline at end of file
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cstdint>
+
+namespace division_engine::canvas::components
+{
+// Index of the scroll offset added to the renderer in the vertex shaders. The
+// bounds stay in the space of the scrolled content, while the clip is on the
+// screen
+struct RenderTranslation
+{
+    uint32_t index;
+
+    bool operator==(const RenderTranslation&) const = default;
+};
+}
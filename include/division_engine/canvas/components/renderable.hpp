@@ -0,0 +1,9 @@
+#pragma once
+
+namespace division_engine::canvas::components
+{
+// Marks the component a drawer draws the renderers by, e.g. `RenderableRect`.
+// Renderers are batched by it, whatever other components they carry
+template<typename T>
+inline constexpr bool is_renderable = false;
+}
@@ -2,6 +2,7 @@
 
 #include "division_engine/canvas/border_radius.hpp"
 #include "division_engine/color.hpp"
+#include "renderable.hpp"
 
 #include <glm/vec2.hpp>
 #include <glm/vec4.hpp>
@@ -11,8 +12,16 @@ namespace division_engine::canvas::components
 
 struct RenderableRect
 {
+    // Samples the whole texture: origin in `xy` and size in `zw`
+    static constexpr glm::vec4 FULL_UV_RECT { 0, 0, 1, 1 };
+
     glm::vec4 color = color::WHITE;
     BorderRadius border_radius = BorderRadius::none();
+    // Part of the batch texture sampled by the rect, e.g. `AtlasRegion::uv_rect`
+    glm::vec4 uv_rect = FULL_UV_RECT;
 };
 
+template<>
+inline constexpr bool is_renderable<RenderableRect> = true;
+
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "division_engine/color.hpp"
+#include "renderable.hpp"
 #include <glm/vec4.hpp>
 #include <string>
 
@@ -16,4 +17,7 @@ struct RenderableText
     float font_size = DEFAULT_FONT_SIZE;
 };
 
+template<>
+inline constexpr bool is_renderable<RenderableText> = true;
+
 }
\ No newline at end of file
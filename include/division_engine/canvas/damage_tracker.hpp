@@ -0,0 +1,85 @@
+#pragma once
+
+#include "immediate_draw_list.hpp"
+#include "components/render_translation.hpp"
+#include "rect.hpp"
+#include "scroll_translations.hpp"
+
+#include <flecs.h>
+#include <glm/vec2.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace division_engine::canvas
+{
+// Screen areas changed since the last drawn frame, merged into a few regions.
+// The render queue redraws only the passes intersecting the regions
+class DamageTracker
+{
+public:
+    static constexpr size_t MAX_REGIONS = 4;
+    // Above this part of the screen the whole frame is redrawn
+    static constexpr float FULL_REDRAW_AREA_RATIO = 0.5f;
+
+    DamageTracker() = default;
+    DamageTracker(const DamageTracker&) = delete;
+    DamageTracker(DamageTracker&&) = delete;
+    DamageTracker& operator=(const DamageTracker&) = delete;
+    DamageTracker& operator=(DamageTracker&&) = delete;
+    ~DamageTracker();
+
+    // Tracks the bounds of the renderers. A change of the bounds or of the
+    // renderable components damages both the old and the new bounds. The
+    // scrolled renderers damage the viewport of their translation instead
+    void observe(
+        flecs::world& world,
+        flecs::entity render_phase,
+        const ScrollTranslations& translations
+    );
+
+    void add(const Rect& rect);
+
+    // Damages the whole screen
+    void invalidate() { _full = true; }
+
+    // Damages the items of this frame and of the previous one
+    void add_immediate(const ImmediateDrawList& immediate);
+
+    // Merges the overlapping regions and falls back to the full redraw when
+    // they cover most of the screen
+    void resolve(glm::vec2 screen_size);
+
+    bool full() const { return _full; }
+
+    std::span<const Rect> regions() const { return _regions; }
+
+    void clear();
+
+private:
+    struct TrackedBounds
+    {
+        flecs::entity_t entity;
+        Rect bounds;
+    };
+
+    const ScrollTranslations* _translations = nullptr;
+    std::vector<flecs::system> _systems;
+    std::vector<flecs::observer> _observers;
+    // Last drawn bounds by the entity index
+    std::vector<TrackedBounds> _tracked;
+    std::vector<Rect> _regions;
+    std::vector<Rect> _immediate_bounds;
+    bool _full = true;
+
+    // The bounds of the scrolled renderers don't include the scroll offset
+    const Rect& damaged_rect(
+        const Rect& bounds,
+        const components::RenderTranslation* translation
+    ) const;
+    void track(flecs::entity_t entity, const Rect& bounds);
+    void untrack(flecs::entity_t entity);
+};
+}
@@ -6,17 +6,17 @@ struct EdgeInsets
 {
     float top = 0, bottom = 0, left = 0, right = 0;
 
-    static EdgeInsets vertical(float value)
+    static constexpr EdgeInsets vertical(float value)
     {
         return EdgeInsets { .top = value, .bottom = value, .left = 0, .right = 0 };
     }
 
-    static EdgeInsets horizontal(float value)
+    static constexpr EdgeInsets horizontal(float value)
     {
         return EdgeInsets { .top = 0, .bottom = 0, .left = value, .right = value };
     }
 
-    static EdgeInsets symmetric(float horizontal, float vertical)
+    static constexpr EdgeInsets symmetric(float horizontal, float vertical)
     {
         return EdgeInsets {
             .top = vertical,
@@ -26,9 +26,11 @@ struct EdgeInsets
         };
     }
 
-    static EdgeInsets all(float value)
+    static constexpr EdgeInsets all(float value)
     {
         return EdgeInsets { value, value, value, value };
     }
+
+    bool operator==(const EdgeInsets&) const = default;
 };
 }
\ No newline at end of file
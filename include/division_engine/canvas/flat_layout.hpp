@@ -0,0 +1,109 @@
+#pragma once
+
+#include "division_engine/core/task_pool.hpp"
+#include "rect.hpp"
+
+#include <flecs.h>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace division_engine::canvas
+{
+// Layout tree flattened into arrays in depth-first order. A node is followed by
+// its subtree, so the sizes are measured in one backward sweep and the rects
+// are placed in one forward sweep. The rects of the leaves are written to their
+// renderers in a single deferred batch
+class FlatLayout
+{
+public:
+    enum class NodeKind : uint8_t
+    {
+        // Renderer entity filling the rect, e.g. a box or a text
+        Leaf,
+        // Size in the params `xy`
+        SizedBox,
+        // Top, bottom, left, right insets in the params
+        Padding,
+        Clip,
+        Stack,
+        HorizontalList,
+        VerticalList,
+        // Clips the children and places them one after another from the start
+        // offset in the params `y`. Vertical if the params `x` isn't zero
+        VirtualList,
+    };
+
+    static constexpr uint32_t NO_PARENT = std::numeric_limits<uint32_t>::max();
+
+    void clear();
+
+    // Adds a node after the subtree of the previous sibling. Its children are
+    // pushed before `end` is called for the node
+    uint32_t push(
+        NodeKind kind,
+        uint32_t parent,
+        const glm::vec4& params = glm::vec4 { 0 },
+        flecs::entity_t entity = 0
+    );
+    void end(uint32_t node);
+    void set_params(uint32_t node, const glm::vec4& params) { _params[node] = params; }
+
+    // With the task pool, the large subtrees are solved in parallel. A subtree
+    // is measured without its siblings and placed once its own rect is known,
+    // so only the nodes above the subtrees are solved on the calling thread
+    void solve(const Rect& root_rect, core::TaskPool* task_pool = nullptr);
+
+    // Writes the changed bounds and clips of the leaf renderers. The bounds are
+    // written only when the layout changes them, so the values tweened by the
+    // animator stay until then
+    void apply(flecs::world& world);
+
+    size_t size() const { return _kinds.size(); }
+    const Rect& rect(uint32_t node) const { return _rects[node]; }
+
+    // The rect of the node at the same index at the last solve, null before
+    // the first one. While the tree is flattened, it is the rect of the
+    // previous frame for the views choosing their children by their size
+    const Rect* previous_rect(uint32_t node) const
+    {
+        return node < _rects.size() ? &_rects[node] : nullptr;
+    }
+
+private:
+    std::vector<NodeKind> _kinds;
+    std::vector<uint32_t> _parents;
+    // Index after the last node of the subtree, i.e. the next sibling
+    std::vector<uint32_t> _subtree_ends;
+    std::vector<uint32_t> _child_counts;
+    std::vector<glm::vec4> _params;
+    std::vector<flecs::entity_t> _entities;
+
+    std::vector<glm::vec2> _sizes;
+    std::vector<Rect> _rects;
+    std::vector<Rect> _clips;
+    std::vector<uint8_t> _clipped;
+    // The leaf entities and the bounds written by the last apply
+    std::vector<flecs::entity_t> _applied_entities;
+    std::vector<Rect> _applied_rects;
+
+    // Subtrees smaller than this are not worth a task
+    static constexpr uint32_t MIN_TASK_NODES = 64;
+    static constexpr size_t TASKS_PER_THREAD = 4;
+
+    // Roots of the subtrees solved in parallel, and the nodes above them in
+    // depth-first order
+    std::vector<uint32_t> _task_roots;
+    std::vector<uint32_t> _spine;
+
+    void split_tasks(uint32_t grain);
+    void measure(uint32_t node);
+    void place(uint32_t node);
+    void place_list(uint32_t node, bool vertical);
+    void place_virtual_list(uint32_t node);
+};
+}
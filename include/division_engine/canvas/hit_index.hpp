@@ -0,0 +1,144 @@
+#pragma once
+
+#include "division_engine/core/input_event.hpp"
+#include "rect.hpp"
+#include "scroll_translations.hpp"
+
+#include <flecs.h>
+#include <glm/ext/vector_int2.hpp>
+#include <glm/vec2.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace division_engine::canvas
+{
+// Uniform grid over the bounds of the renderers, kept up to date by observing
+// their bounds, orders and clips. A point query visits a single cell, so the
+// topmost renderer is found without scanning every renderer. The bounds
+// written in place are reindexed in the render phase, from the tables changed
+// since the last frame. The cell size follows the count and the size of the
+// renderers, and the grid is rebuilt when it drifts too far.
+// Renderers spanning too many cells are kept in a coarser grid, and only the
+// ones too large for it as well are checked by every query.
+// Scrolled renderers are kept at their unscrolled bounds, and a query visits
+// one more cell per scroll view, moved back by its offset
+class HitIndex
+{
+public:
+    static constexpr float DEFAULT_CELL_SIZE = 128;
+    static constexpr float MIN_CELL_SIZE = 8;
+    static constexpr float MAX_CELL_SIZE = 4096;
+    // The cells are sized for this many renderers on average, but not smaller
+    // than the average renderer
+    static constexpr float RENDERERS_PER_CELL = 8;
+    // The grid is rebuilt when the preferred cell size is this many times
+    // larger or smaller than the current one
+    static constexpr float REBUILD_RATIO = 2;
+    // Larger renderers, e.g. the backgrounds, are added to the coarse cells
+    // instead, and the ones too large for these are checked by every query
+    static constexpr size_t MAX_CELLS_PER_RENDERER = 64;
+    // The coarse cells are this many times larger than the cells
+    static constexpr float COARSE_CELL_RATIO = 16;
+
+    HitIndex() = default;
+    HitIndex(const HitIndex&) = delete;
+    HitIndex(HitIndex&&) = delete;
+    HitIndex& operator=(const HitIndex&) = delete;
+    HitIndex& operator=(HitIndex&&) = delete;
+    ~HitIndex();
+
+    void observe(
+        flecs::world& world,
+        flecs::entity render_phase,
+        const ScrollTranslations& translations
+    );
+
+    // The renderer drawn on top at the point, among the ones whose bounds and
+    // clip contain it
+    std::optional<flecs::entity_t> topmost(glm::vec2 point) const;
+
+    // Delivers the event to the `PointerHandler` of the topmost renderer.
+    // Returns false when the renderer has no handler or nothing was hit
+    bool dispatch(flecs::world& world, const core::InputEvent& event) const;
+
+    size_t size() const { return _size; }
+    float cell_size() const { return _cell_size; }
+    // Renderers too large for the coarse cells, checked by every query
+    size_t unbounded_size() const { return _unbounded.size(); }
+
+    // Rebuilds the grid when the cell size drifted from the preferred one
+    void adapt_cell_size();
+
+private:
+    using Cells = std::unordered_map<uint64_t, std::vector<uint32_t>>;
+
+    enum class Level : uint8_t
+    {
+        Fine,
+        Coarse,
+        // Checked by every query
+        Unbounded,
+    };
+
+    struct CellRange
+    {
+        glm::ivec2 min;
+        glm::ivec2 max;
+    };
+
+    struct Entry
+    {
+        flecs::entity_t entity;
+        Rect bounds;
+        Rect clip;
+        uint64_t order;
+        uint32_t translation;
+        CellRange cells;
+        Level level;
+        bool clipped;
+    };
+
+    std::vector<flecs::system> _systems;
+    std::vector<flecs::observer> _observers;
+    const ScrollTranslations* _translations = nullptr;
+    // Indexed renderers by the entity index
+    std::vector<Entry> _entries;
+    Cells _cells;
+    Cells _coarse_cells;
+    std::vector<uint32_t> _unbounded;
+    size_t _size = 0;
+    float _cell_size = DEFAULT_CELL_SIZE;
+
+    // Renderers with finite bounds, the sum of their sizes and the area they
+    // cover. The area only grows between the rebuilds of the grid
+    size_t _sized_count = 0;
+    glm::vec2 _size_sum { 0 };
+    std::optional<Rect> _covered;
+
+    void insert(flecs::entity_t entity, const Rect& bounds, uint64_t order);
+    // Reinserts an indexed renderer if its bounds or order changed
+    void move(flecs::entity_t entity, const Rect& bounds, uint64_t order);
+    void remove(flecs::entity_t entity);
+    void set_clip(flecs::entity_t entity, const std::optional<Rect>& clip);
+    void set_translation(flecs::entity_t entity, uint32_t translation);
+
+    void link(uint32_t index);
+    void unlink(uint32_t index);
+    void rebuild(float cell_size);
+    void add_stats(const Rect& bounds);
+    void remove_stats(const Rect& bounds);
+    float preferred_cell_size() const;
+    // Cells of the bounds, unless there are more than MAX_CELLS_PER_RENDERER
+    static std::optional<CellRange> cell_range(const Rect& bounds, float cell_size);
+    static float cell_coord(float value, float cell_size);
+
+    // The content point is moved back by the scroll offset of the entry, like
+    // its bounds and clip
+    static bool hits(const Entry& entry, glm::vec2 content_point);
+    static uint64_t cell_key(int32_t x, int32_t y);
+};
+}
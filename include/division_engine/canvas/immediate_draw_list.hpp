@@ -0,0 +1,182 @@
+#pragma once
+
+#include "components/render_order.hpp"
+#include "components/renderable_rect.hpp"
+#include "rect.hpp"
+
+#include <division_engine_core/types/id.h>
+#include <glm/vec4.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace division_engine::canvas
+{
+// Transient geometry drawn for a single frame without creating any entities.
+// The items are consumed by the drawers in the render phase and cleared by
+// `RenderManager::update`. The list isn't synchronized, so it is filled from
+// the main thread only
+class ImmediateDrawList
+{
+public:
+    struct RectItem
+    {
+        Rect bounds;
+        components::RenderableRect rect;
+        DivisionId texture_id;
+        components::RenderOrder order;
+    };
+
+    struct TextItem
+    {
+        Rect bounds;
+        size_t text_offset;
+        size_t text_size;
+        glm::vec4 color;
+        float font_size;
+        components::RenderOrder order;
+    };
+
+    ImmediateDrawList() = default;
+    ImmediateDrawList(const ImmediateDrawList&) = delete;
+    ImmediateDrawList(ImmediateDrawList&&) = delete;
+    ImmediateDrawList& operator=(const ImmediateDrawList&) = delete;
+    ImmediateDrawList& operator=(ImmediateDrawList&&) = delete;
+    ~ImmediateDrawList() = default;
+
+    void draw_rect(
+        const Rect& bounds,
+        const components::RenderableRect& rect,
+        const components::RenderOrder& order,
+        DivisionId texture_id
+    )
+    {
+        _rects.push_back(RectItem {
+            .bounds = bounds,
+            .rect = rect,
+            .texture_id = texture_id,
+            .order = order,
+        });
+        _sorted = false;
+    }
+
+    void draw_text(
+        const Rect& bounds,
+        std::string_view text,
+        const glm::vec4& color,
+        float font_size,
+        const components::RenderOrder& order
+    )
+    {
+        _texts.push_back(TextItem {
+            .bounds = bounds,
+            .text_offset = _text_arena.size(),
+            .text_size = text.size(),
+            .color = color,
+            .font_size = font_size,
+            .order = order,
+        });
+        _text_arena.append(text);
+        _sorted = false;
+    }
+
+    // Sorts the items by their order. The drawers call it before reading the
+    // items, so the sorting is done once per frame
+    void sort()
+    {
+        if (_sorted)
+        {
+            return;
+        }
+
+        const auto by_order = [](const auto& x, const auto& y)
+        { return x.order.sort_key() < y.order.sort_key(); };
+
+        std::ranges::stable_sort(_rects, by_order);
+        std::ranges::stable_sort(_texts, by_order);
+
+        _split_keys.clear();
+        for (const auto& item : _rects)
+        {
+            _split_keys.push_back(item.order.sort_key());
+        }
+        for (const auto& item : _texts)
+        {
+            _split_keys.push_back(item.order.sort_key());
+        }
+        std::ranges::sort(_split_keys);
+        const auto [first, last] = std::ranges::unique(_split_keys);
+        _split_keys.erase(first, last);
+
+        _sorted = true;
+    }
+
+    std::span<const RectItem> rects() const { return _rects; }
+
+    std::span<const TextItem> texts() const { return _texts; }
+
+    std::string_view text(const TextItem& item) const
+    {
+        return std::string_view { _text_arena }.substr(item.text_offset, item.text_size);
+    }
+
+    // Orders of every item. The retained passes are split at them, so the
+    // items are interleaved with the retained renderers of every drawer
+    std::span<const uint64_t> split_keys() const { return _split_keys; }
+
+    bool empty() const { return _rects.empty() && _texts.empty(); }
+
+    void clear()
+    {
+        _rects.clear();
+        _texts.clear();
+        _text_arena.clear();
+        _split_keys.clear();
+        _sorted = true;
+    }
+
+private:
+    std::vector<RectItem> _rects;
+    std::vector<TextItem> _texts;
+    std::string _text_arena;
+    std::vector<uint64_t> _split_keys;
+    bool _sorted = true;
+};
+
+// Calls the callback with every range of the sorted items that shares the
+// group and doesn't cross any of the split keys
+template<typename TKeyAt, typename TGroupAt, typename TCallback>
+void for_each_render_run(
+    size_t count,
+    std::span<const uint64_t> split_keys,
+    TKeyAt&& key_at,
+    TGroupAt&& group_at,
+    TCallback&& callback
+)
+{
+    auto split_it = split_keys.begin();
+
+    size_t first = 0;
+    while (first < count)
+    {
+        const auto first_key = key_at(first);
+        split_it = std::lower_bound(split_it, split_keys.end(), first_key);
+
+        const auto group = group_at(first);
+        auto last = first + 1;
+        while (last < count && group_at(last) == group &&
+               (split_it == split_keys.end() || key_at(last) <= *split_it))
+        {
+            last++;
+        }
+
+        callback(first, last);
+        first = last;
+    }
+}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "components/render_order.hpp"
+
+#include <flecs.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace division_engine::canvas
+{
+// Renderers of every layer sorted by their order, updated by the RenderOrder
+// observers. The render manager looks up the neighbours of a moved renderer
+// here, so moves and compactions don't scan the whole world
+class LayerOrders
+{
+public:
+    // The order and the id of a renderer, sorted by the order first
+    using Entry = std::pair<uint32_t, flecs::entity_t>;
+    using Layer = std::set<Entry>;
+
+    LayerOrders() = default;
+    LayerOrders(const LayerOrders&) = delete;
+    LayerOrders(LayerOrders&&) = delete;
+    LayerOrders& operator=(const LayerOrders&) = delete;
+    LayerOrders& operator=(LayerOrders&&) = delete;
+    ~LayerOrders();
+
+    void observe(flecs::world& world);
+
+    void upsert(flecs::entity_t entity, const components::RenderOrder& order);
+    void remove(flecs::entity_t entity);
+
+    // The renderers of the layer by their order, an empty set for an unused layer
+    const Layer& layer(uint32_t layer) const;
+
+    // Returns the closest renderer below the order, skipping `except`.
+    // Returns the end of the layer when there is none
+    Layer::const_iterator
+    below(uint32_t layer, uint32_t order, flecs::entity_t except) const;
+
+    // Returns the closest renderer above the order, or the end of the layer
+    Layer::const_iterator above(uint32_t layer, uint32_t order) const;
+
+    size_t size() const;
+
+private:
+    struct Slot
+    {
+        flecs::entity_t entity;
+        components::RenderOrder order;
+    };
+
+    std::vector<flecs::observer> _observers;
+    std::unordered_map<uint32_t, Layer> _layers;
+    // Current order of every tracked renderer by the entity index
+    std::vector<Slot> _slots;
+
+    static uint32_t entity_index(flecs::entity_t entity)
+    {
+        return static_cast<uint32_t>(entity);
+    }
+};
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "glm/ext/vector_float2.hpp"
+#include <glm/common.hpp>
 #include <glm/vec2.hpp>
 
 namespace division_engine::canvas
@@ -40,6 +41,11 @@ struct Rect
         return Rect { bottom_left + extents, extents };
     }
 
+    static Rect from_min_max(glm::vec2 min, glm::vec2 max)
+    {
+        return Rect { (min + max) * 0.5f, (max - min) * 0.5f }; // NOLINT
+    }
+
     glm::vec2 size() const { return extents * 2.f; /* NOLINT */ }
     float area() const { return extents.x * 2.f * extents.y * 2.f; /* NOLINT */ }
 
@@ -64,5 +70,32 @@ struct Rect
         return (left() <= point.x) & (point.x <= right()) & (bottom() <= point.y) &
                (point.y <= top());
     }
+
+    bool intersects(Rect rect) const
+    {
+        return (left() <= rect.right()) & (rect.left() <= right()) &
+               (bottom() <= rect.top()) & (rect.bottom() <= top());
+    }
+
+    // The smallest rect containing both rects
+    Rect united(Rect rect) const
+    {
+        return from_min_max(
+            glm::min(center - extents, rect.center - rect.extents),
+            glm::max(center + extents, rect.center + rect.extents)
+        );
+    }
+
+    Rect translated(glm::vec2 offset) const { return Rect { center + offset, extents }; }
+
+    // The overlapping part of both rects, empty when they don't overlap
+    Rect intersected(Rect rect) const
+    {
+        const auto min = glm::max(center - extents, rect.center - rect.extents);
+        const auto max = glm::min(center + extents, rect.center + rect.extents);
+        return from_min_max(min, glm::max(min, max));
+    }
+
+    bool operator==(const Rect& other) const = default;
 };
 }
\ No newline at end of file
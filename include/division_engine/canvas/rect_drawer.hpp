@@ -1,21 +1,33 @@
 #pragma once
 
+#include "components/render_clip.hpp"
 #include "components/render_order.hpp"
 #include "components/render_texture.hpp"
+#include "components/render_translation.hpp"
 #include "components/renderable_rect.hpp"
 
 #include "components/render_bounds.hpp"
 #include "division_engine/canvas/renderer.hpp"
+#include "division_engine/canvas/render_order_index.hpp"
+#include "division_engine/canvas/render_queue.hpp"
+#include "division_engine/canvas/retained_layers.hpp"
 #include "division_engine/core/context.hpp"
+#include "division_engine/core/vertex_buffer_data.hpp"
 #include "division_engine/core/vertex_data.hpp"
 
 #include "state.hpp"
 
 #include <division_engine_core/types/render_pass_instance.h>
+#include <flecs.h>
 #include <glm/vec2.hpp>
 
 #include <array>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <unordered_set>
 #include <vector>
 
 namespace division_engine::canvas
@@ -44,12 +56,19 @@ public:
         glm::vec2 position;
         glm::vec4 color;
         glm::vec4 trbl_border_radius;
+        glm::vec4 uv_rect;
+        glm::vec4 clip_rect;
+        // Index into the scroll translations, exact as a float
+        float translation_index;
 
         static constexpr auto vertex_attributes = std::array {
             DIVISION_DECLARE_VERTEX_ATTRIBUTE(size, 2),
             DIVISION_DECLARE_VERTEX_ATTRIBUTE(position, 3),
             DIVISION_DECLARE_VERTEX_ATTRIBUTE(color, 4),
             DIVISION_DECLARE_VERTEX_ATTRIBUTE(trbl_border_radius, 5),
+            DIVISION_DECLARE_VERTEX_ATTRIBUTE(uv_rect, 6),
+            DIVISION_DECLARE_VERTEX_ATTRIBUTE(clip_rect, 7),
+            DIVISION_DECLARE_VERTEX_ATTRIBUTE(translation_index, 8),
         };
     } __attribute__((__packed__));
 
@@ -86,24 +105,62 @@ public:
     explicit RectDrawer(State& state, size_t rect_capacity = DEFAULT_RECT_CAPACITY);
     ~RectDrawer() override;
 
-    void fill_render_queue(State& state) override;
+    void register_systems(State& state) override;
 
 private:
     using RenderTexture = components::RenderTexture;
     using RenderOrder = components::RenderOrder;
     using RenderBounds = components::RenderBounds;
     using RenderableRect = components::RenderableRect;
+    using RenderClip = components::RenderClip;
+    using RenderTranslation = components::RenderTranslation;
 
+    struct InstanceRange
+    {
+        size_t first_instance;
+        size_t count;
+        DivisionId texture_id;
+        RenderOrder order;
+        Rect bounds;
+        // Empty for the immediate ranges, which are redrawn whole
+        std::vector<Rect> block_bounds;
+
+        bool operator==(const InstanceRange&) const = default;
+    };
+
+    static constexpr auto NO_TEXTURE = std::numeric_limits<DivisionId>::max();
+
+    std::vector<flecs::system> _systems;
+    std::vector<flecs::observer> _observers;
     flecs::query<
         const RenderBounds,
         const RenderableRect,
-        const RenderOrder,
-        const RenderTexture>
-        _query;
+        const RenderTexture,
+        const RenderClip*,
+        const RenderTranslation*>
+        _change_query;
+    // Tables of the change query written since the last frame. The change
+    // state can't be read from the multithreaded fill system
+    std::unordered_set<const ecs_table_t*> _changed_tables;
+    RenderOrderIndex _order_index;
+    // Instances are placed at the slots of the order index, followed by the
+    // immediate items. The texture of every slot is written by the fill
+    // workers and splits the passes
+    std::vector<DivisionId> _slot_textures;
+    std::vector<Rect> _slot_bounds;
+    RetainedLayers<InstanceRange> _retained_layers;
+    std::vector<InstanceRange> _immediate_ranges;
+    // The split keys the retained ranges were built with
+    std::vector<uint64_t> _split_keys;
+    std::optional<core::VertexBufferData<RectVertex, RectInstance>> _vertex_buffer_data;
+    std::span<RectInstance> _instances;
 
     std::vector<DivisionIdWithBinding> _texture_bindings;
+    RenderQueue& _render_queue;
+    const ScrollTranslations& _scroll_translations;
     core::Context _ctx;
-    DivisionIdWithBinding _screen_size_uniform;
+    // The screen size, followed by the scroll translations read by the vertex shader
+    std::array<DivisionIdWithBinding, 2> _uniforms;
 
     DivisionId _shader_id;
     DivisionId _vertex_buffer_id;
@@ -111,13 +168,37 @@ private:
 
     uint32_t _instance_capacity;
 
+    // The retained instances are written this frame. Unless all of them are
+    // refilled, only the tables changed since the last frame are written
+    bool _retained_dirty = false;
+    bool _refill_all = true;
+    bool _textures_changed = true;
+    // The version of the scroll translations the instances were culled with
+    uint64_t _translations_version = 0;
+
     static DivisionId
     make_vertex_buffer(core::Context& context_helper, uint32_t instance_capacity);
 
-    DivisionRenderPassInstance make_render_pass_instance(
-        DivisionIdWithBinding* texture_ptr,
-        size_t first_instance,
-        size_t instance_count
+    void reserve_instances(State& state);
+    void fill_instances(
+        flecs::iter& it,
+        const RenderBounds* render_bounds,
+        const RenderableRect* rects,
+        const RenderTexture* textures,
+        const RenderClip* clips,
+        const RenderTranslation* translations
+    );
+    void enqueue_passes(State& state);
+    void build_retained_ranges(std::span<const uint64_t> split_keys);
+    void add_texture_binding(DivisionId texture_id);
+
+    static RectInstance make_instance(
+        const Rect& bounds,
+        const RenderableRect& rect,
+        const glm::vec4& clip_rect = RenderClip::NO_CLIP_RECT,
+        uint32_t translation_index = ScrollTranslations::NO_TRANSLATION
     );
+
+    RenderQueue::Pass make_render_pass(const InstanceRange& range);
 };
 }
\ No newline at end of file
@@ -2,14 +2,23 @@
 
 #include "components/render_batch.hpp"
 #include "components/render_order.hpp"
+#include "components/renderable.hpp"
+#include "layer_orders.hpp"
 #include "renderer.hpp"
 #include "state.hpp"
 
+#include "division_engine/core/exception.hpp"
 #include "division_engine/utility/algorithm.hpp"
 
 #include <array>
 #include <flecs.h>
 
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <limits>
 #include <memory>
 #include <optional>
 #include <span>
@@ -31,17 +40,20 @@ public:
     template<typename... TRenderers>
     RenderManager()
       : _renderers()
-      , _batch(std::nullopt)
-      , _render_order(0)
+      , _batches()
+      , _batch_count(0)
+      , _layer_tops()
+      , _layers_to_compact()
     {
     }
 
     template<typename TRenderer, typename... TArgs>
-    void register_renderer(TArgs&... args)
+    void register_renderer(State& state, TArgs&... args)
     {
         static_assert(std::is_base_of<Renderer, TRenderer>());
 
-        auto ptr = std::make_unique<TRenderer>(args...);
+        auto ptr = std::make_unique<TRenderer>(state, args...);
+        ptr->register_systems(state);
         _renderers.push_back(std::move(ptr));
     }
 
@@ -49,20 +61,14 @@ public:
     flecs::entity create_renderer(
         State& state,
         std::tuple<TComponents...> components,
-        std::optional<flecs::entity_t> batch_entity = std::nullopt
+        std::optional<flecs::entity_t> batch_entity = std::nullopt,
+        uint32_t layer = 0
     )
     {
-        using components::RenderBatch;
         using components::RenderOrder;
         using division_engine::utility::algorithm::tuple_foreach;
 
-        auto renderer_id = std::type_index(typeid(components));
-        if (!_batch.has_value() || _batch->first != renderer_id)
-        {
-            _batch = std::make_pair(
-                renderer_id, state.world.entity().set(RenderBatch {}).id()
-            );
-        }
+        const auto batch = batch_for<TComponents...>(state, batch_entity);
 
         auto new_entity = state.world.entity();
         tuple_foreach([&](auto& comp) { new_entity.set(comp); }, components);
@@ -71,24 +77,476 @@ public:
             new_entity.is_a(batch_entity.value());
         }
 
-        new_entity.set(RenderOrder { _render_order++ });
-        new_entity.is_a(_batch->second);
+        // The order goes last, so the order index observers see the whole renderer
+        new_entity.is_a(batch);
+        new_entity.set(RenderOrder { next_orders(state, layer, 1), layer });
 
         return new_entity;
     }
 
-    void update(State& state)
+    // Same as `create_renderer`, but reuses an idle renderer of the same batch
+    // from the state pool when there is one
+    template<typename... TComponents>
+    flecs::entity acquire_renderer(
+        State& state,
+        std::tuple<TComponents...> components,
+        std::optional<flecs::entity_t> batch_entity = std::nullopt,
+        uint32_t layer = 0
+    )
+    {
+        using components::RenderOrder;
+        using division_engine::utility::algorithm::tuple_foreach;
+
+        const auto batch = batch_for<TComponents...>(state, batch_entity);
+        auto renderer = state.renderer_pool.acquire(state.world, batch);
+        if (!renderer)
+        {
+            return create_renderer(state, std::move(components), batch_entity, layer);
+        }
+
+        tuple_foreach([&](auto& comp) { renderer.set(comp); }, components);
+        renderer.set(RenderOrder { next_orders(state, layer, 1), layer });
+
+        return renderer;
+    }
+
+    // Creates renderers directly in their final archetype. Each span holds a
+    // component per renderer and the renderers get a contiguous order range.
+    // Throws when the spans differ in length
+    template<typename... TComponents>
+    std::vector<flecs::entity_t> create_renderers(
+        State& state,
+        std::tuple<std::span<TComponents>...> components,
+        std::optional<flecs::entity_t> batch_entity = std::nullopt,
+        uint32_t layer = 0
+    )
     {
-        for (auto& rend : _renderers)
+        using components::RenderOrder;
+        using division_engine::utility::algorithm::tuple_foreach;
+
+        static_assert(
+            sizeof...(TComponents) + 3 <= FLECS_ID_DESC_MAX,
+            "Too many components for the bulk creation"
+        );
+
+        const auto count = std::get<0>(components).size();
+        const auto same_count = std::apply(
+            [count](const auto&... span) { return ((span.size() == count) && ...); },
+            components
+        );
+        if (!same_count)
+        {
+            throw core::Exception { "The component spans differ in length" };
+        }
+
+        if (count == 0)
+        {
+            return {};
+        }
+
+        const auto batch =
+            batch_for<std::remove_const_t<TComponents>...>(state, batch_entity);
+
+        const auto first_order = next_orders(state, layer, count);
+        std::vector<RenderOrder> orders(count);
+        for (size_t i = 0; i < count; i++)
         {
-            rend->fill_render_queue(state);
+            orders[i] = RenderOrder {
+                first_order + static_cast<uint32_t>(i) * RenderOrder::GAP,
+                layer,
+            };
         }
+
+        ecs_bulk_desc_t desc {};
+        std::array<void*, FLECS_ID_DESC_MAX> data {};
+        size_t id_count = 0;
+
+        const auto add_id = [&](flecs::id_t id, void* component_data)
+        {
+            desc.ids[id_count] = id;
+            data[id_count] = component_data;
+            id_count++;
+        };
+
+        tuple_foreach(
+            [&](auto& span)
+            {
+                using component_t =
+                    std::remove_const_t<typename std::remove_reference_t<
+                        decltype(span)>::element_type>;
+
+                add_id(
+                    state.world.component<component_t>().id(),
+                    const_cast<component_t*>(span.data()) // NOLINT
+                );
+            },
+            components
+        );
+
+        add_id(state.world.component<RenderOrder>().id(), orders.data());
+        add_id(ecs_pair(flecs::IsA, batch), nullptr);
+        if (batch_entity.has_value())
+        {
+            add_id(ecs_pair(flecs::IsA, batch_entity.value()), nullptr);
+        }
+
+        desc.count = static_cast<int32_t>(count);
+        desc.data = data.data();
+
+        const auto* entities = ecs_bulk_init(state.world.c_ptr(), &desc);
+        return std::vector<flecs::entity_t>(entities, entities + count);
+    }
+
+    // Returns the batch shared by the renderers with the same renderable
+    // component and the same batch entity. The other components, and their
+    // order, don't split the batches
+    template<typename... TComponents>
+    flecs::entity_t batch_for(
+        State& state,
+        std::optional<flecs::entity_t> batch_entity = std::nullopt
+    )
+    {
+        const auto key = make_batch_key<TComponents...>(batch_entity);
+        const auto it = _batches.find(key);
+        if (it != _batches.end())
+        {
+            return it->second;
+        }
+
+        return new_batch<TComponents...>(state, batch_entity);
+    }
+
+    // Creates a batch that replaces the current one for the key. Renderers
+    // created after the call are split into their own archetype and passes
+    template<typename... TComponents>
+    flecs::entity_t new_batch(
+        State& state,
+        std::optional<flecs::entity_t> batch_entity = std::nullopt
+    )
+    {
+        using components::RenderBatch;
+
+        const auto batch = state.world.entity().set(RenderBatch { _batch_count++ }).id();
+        _batches.insert_or_assign(make_batch_key<TComponents...>(batch_entity), batch);
+
+        return batch;
+    }
+
+    size_t batch_count() const { return _batch_count; }
+
+    // Places the renderer between two renderers of the same layer.
+    // Only the moved renderer is touched while there is a gap between them,
+    // otherwise the closest neighbours are spread to make room for it
+    void move_between(
+        State& state,
+        flecs::entity renderer,
+        flecs::entity below,
+        flecs::entity above
+    )
+    {
+        using components::RenderOrder;
+
+        const auto lower = *below.get<RenderOrder>();
+        const auto upper = *above.get<RenderOrder>();
+        assert(lower.layer == upper.layer && lower.order < upper.order);
+
+        place_below(state, renderer, above, lower.order);
+    }
+
+    // Places the renderer right below another one. The renderer under the
+    // upper one is looked up in the sorted layer
+    void move_below(State& state, flecs::entity renderer, flecs::entity above)
+    {
+        using components::RenderOrder;
+
+        const auto upper = *above.get<RenderOrder>();
+        const auto& layer = state.layer_orders.layer(upper.layer);
+        const auto below = state.layer_orders.below(upper.layer, upper.order, renderer);
+
+        place_below(state, renderer, above, below != layer.end() ? below->first : 0);
+    }
+
+    // Places the renderer above every renderer of the layer
+    void move_to_top(State& state, flecs::entity renderer, uint32_t layer)
+    {
+        using components::RenderOrder;
+
+        renderer.set(RenderOrder { next_orders(state, layer, 1), layer });
+    }
+
+    // Renumbers the layers whose tops got close to the last order, keeping
+    // the relative order of their renderers. Up to COMPACTION_BUDGET renderers
+    // are renumbered per frame, the other layers wait for the next frames
+    void compact_render_orders(State& state)
+    {
+        size_t budget = COMPACTION_BUDGET;
+        auto it = _layers_to_compact.begin();
+        while (it != _layers_to_compact.end() && budget > 0)
+        {
+            // A layer larger than the budget is compacted in a frame of its own
+            const auto size = state.layer_orders.layer(*it).size();
+            if (size > budget && budget < COMPACTION_BUDGET)
+            {
+                break;
+            }
+
+            compact_layer(state, *it);
+            budget -= std::min(size, budget);
+            it = _layers_to_compact.erase(it);
+        }
+    }
+
+    // Runs the world pipeline: user systems first, then the renderers
+    // registered in the render phase. The immediate items are dropped, the
+    // layers running out of orders are compacted and the surplus of idle
+    // pooled renderers is destroyed after the frame is submitted
+    void update(State& state)
+    {
+        state.world.progress();
+        state.damage.add_immediate(state.immediate);
+        state.immediate.clear();
+        compact_render_orders(state);
+        state.renderer_pool.trim(state.world);
     }
 
 private:
+    struct BatchKey
+    {
+        std::type_index renderable_type;
+        flecs::entity_t batch_entity;
+
+        bool operator==(const BatchKey& other) const = default;
+    };
+
+    struct BatchKeyHash
+    {
+        size_t operator()(const BatchKey& key) const
+        {
+            const auto type_hash = std::hash<std::type_index> {}(key.renderable_type);
+            const auto entity_hash = std::hash<flecs::entity_t> {}(key.batch_entity);
+            return type_hash ^ (entity_hash << 1);
+        }
+    };
+
+    // The spread renderers get at least this gap while the layer has room
+    static constexpr uint32_t MIN_GAP = components::RenderOrder::GAP / 16;
+    // Above this top a layer is compacted at the end of the frame
+    static constexpr uint32_t COMPACTION_THRESHOLD =
+        std::numeric_limits<uint32_t>::max() / 2;
+    static constexpr size_t COMPACTION_BUDGET = 1 << 16;
+
     std::vector<std::unique_ptr<Renderer>> _renderers;
-    std::optional<std::pair<std::type_index, flecs::entity_t>> _batch;
-    uint32_t _render_order;
+    std::unordered_map<BatchKey, flecs::entity_t, BatchKeyHash> _batches;
+    uint32_t _batch_count;
+    std::unordered_map<uint32_t, uint32_t> _layer_tops;
+    std::unordered_set<uint32_t> _layers_to_compact;
+
+    // Returns the first of `count` orders placed on top of the layer
+    uint32_t next_orders(State& state, uint32_t layer, size_t count)
+    {
+        using components::RenderOrder;
+
+        constexpr auto max_order = std::numeric_limits<uint32_t>::max();
+        const auto span = static_cast<uint64_t>(count) * RenderOrder::GAP;
+
+        if (_layer_tops[layer] + span > COMPACTION_THRESHOLD)
+        {
+            _layers_to_compact.insert(layer);
+        }
+
+        // Only reached after billions of orders are taken within a frame
+        if (_layer_tops[layer] + span > max_order)
+        {
+            compact_layer(state, layer);
+            _layers_to_compact.erase(layer);
+        }
+
+        const auto top = _layer_tops[layer];
+        if (top + span > max_order)
+        {
+            throw core::Exception { "Render order layer is out of free orders" };
+        }
+
+        _layer_tops[layer] = static_cast<uint32_t>(top + span);
+        return top + RenderOrder::GAP;
+    }
+
+    // Places the renderer between the upper one and the order under it
+    void place_below(
+        State& state,
+        flecs::entity renderer,
+        flecs::entity above,
+        uint32_t lower_order
+    )
+    {
+        using components::RenderOrder;
+
+        const auto upper = *above.get<RenderOrder>();
+        if (upper.order - lower_order < 2)
+        {
+            spread_below(state, renderer, above);
+            return;
+        }
+
+        const auto order = lower_order + (upper.order - lower_order) / 2;
+        renderer.set(RenderOrder { order, upper.layer });
+    }
+
+    // Spreads the renderers around the upper one evenly, with the moved
+    // renderer inserted right below it. The window doubles until the orders
+    // around it have room for MIN_GAP between its renderers, so a move
+    // renumbers a few neighbours and leaves the rest of the layer alone
+    void spread_below(State& state, flecs::entity renderer, flecs::entity above)
+    {
+        using components::RenderOrder;
+        using Entry = LayerOrders::Entry;
+
+        constexpr uint64_t max_order = std::numeric_limits<uint32_t>::max();
+
+        const auto upper = *above.get<RenderOrder>();
+        const auto& layer = state.layer_orders.layer(upper.layer);
+        auto& layer_top = _layer_tops[upper.layer];
+        if (!layer.empty())
+        {
+            layer_top = std::max(layer_top, layer.rbegin()->first);
+        }
+
+        const auto position = layer.lower_bound(Entry { upper.order, above.id() });
+        auto first = position;
+        auto last = position;
+        // Renderers of the window, the moved one included
+        uint64_t count = 1;
+        uint64_t lower_bound = 0;
+        uint64_t upper_bound = 0;
+
+        for (size_t grow = 1;; grow *= 2)
+        {
+            lower_bound = first == layer.begin() ? 0 : std::prev(first)->first;
+            upper_bound = last != layer.end()
+                              ? last->first
+                              : std::min(
+                                    layer_top + (count + 1) * RenderOrder::GAP, max_order
+                                );
+
+            const auto range = upper_bound - lower_bound;
+            if (range >= (count + 1) * MIN_GAP)
+            {
+                break;
+            }
+
+            if (first == layer.begin() && last == layer.end())
+            {
+                if (range >= count + 1)
+                {
+                    break;
+                }
+
+                throw core::Exception { "Render order layer is out of free orders" };
+            }
+
+            for (size_t i = 0; i < grow && first != layer.begin(); i++)
+            {
+                first = std::prev(first);
+                count += first->second != renderer.id() ? 1 : 0;
+            }
+            for (size_t i = 0; i < grow && last != layer.end(); i++)
+            {
+                count += last->second != renderer.id() ? 1 : 0;
+                last = std::next(last);
+            }
+        }
+
+        std::vector<flecs::entity_t> renderers;
+        renderers.reserve(count);
+        for (auto it = first; it != last; it++)
+        {
+            if (it == position)
+            {
+                renderers.push_back(renderer.id());
+            }
+            if (it->second != renderer.id())
+            {
+                renderers.push_back(it->second);
+            }
+        }
+        if (position == last)
+        {
+            renderers.push_back(renderer.id());
+        }
+
+        const auto step = (upper_bound - lower_bound) / (renderers.size() + 1);
+        if (last == layer.end())
+        {
+            layer_top = static_cast<uint32_t>(lower_bound + step * renderers.size());
+        }
+
+        // The observers update the sorted layer only after every order is set
+        state.world.defer_begin();
+        for (size_t i = 0; i < renderers.size(); i++)
+        {
+            flecs::entity { state.world, renderers[i] }.set(RenderOrder {
+                static_cast<uint32_t>(lower_bound + step * (i + 1)),
+                upper.layer,
+            });
+        }
+        state.world.defer_end();
+    }
+
+    void compact_layer(State& state, uint32_t layer)
+    {
+        using components::RenderOrder;
+
+        const auto& renderers = state.layer_orders.layer(layer);
+        std::vector<flecs::entity_t> entities;
+        entities.reserve(renderers.size());
+        for (const auto& [_, entity] : renderers)
+        {
+            entities.push_back(entity);
+        }
+
+        state.world.defer_begin();
+        uint32_t order = 0;
+        for (const auto entity : entities)
+        {
+            order += RenderOrder::GAP;
+            flecs::entity { state.world, entity }.set(RenderOrder { order, layer });
+        }
+        state.world.defer_end();
+
+        _layer_tops[layer] = order;
+    }
+
+    template<typename... TComponents>
+    static BatchKey make_batch_key(std::optional<flecs::entity_t> batch_entity)
+    {
+        return BatchKey {
+            .renderable_type = renderable_type<std::remove_cvref_t<TComponents>...>(),
+            .batch_entity = batch_entity.value_or(0),
+        };
+    }
+
+    // The renderable component among the components of the renderer
+    template<typename... TComponents>
+    static std::type_index renderable_type()
+    {
+        static_assert(
+            (components::is_renderable<TComponents> + ...) == 1,
+            "A renderer must have exactly one renderable component"
+        );
+
+        std::optional<std::type_index> type;
+        (
+            [&]
+            {
+                if constexpr (components::is_renderable<TComponents>)
+                {
+                    type.emplace(typeid(TComponents));
+                }
+            }(),
+            ...
+        );
+        return *type;
+    }
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "components/render_order.hpp"
+
+#include <flecs.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace division_engine::canvas
+{
+// Renderers sorted by their RenderOrder. The observers only collect the changes,
+// which are merged into the sorted entries before the frame, so the frames
+// without order changes do no sorting at all
+class RenderOrderIndex
+{
+public:
+    static constexpr uint32_t NO_SLOT = std::numeric_limits<uint32_t>::max();
+
+    struct Entry
+    {
+        components::RenderOrder order;
+        flecs::entity_t entity;
+    };
+
+    RenderOrderIndex() = default;
+    RenderOrderIndex(const RenderOrderIndex&) = delete;
+    RenderOrderIndex(RenderOrderIndex&&) = delete;
+    RenderOrderIndex& operator=(const RenderOrderIndex&) = delete;
+    RenderOrderIndex& operator=(RenderOrderIndex&&) = delete;
+    ~RenderOrderIndex();
+
+    // Tracks the renderers that have a RenderOrder and match the observer terms.
+    // The terms besides the RenderOrder should be filter terms, so the
+    // changes of the other components don't touch the index
+    template<typename TTermsBuilder>
+    void observe(flecs::world& world, TTermsBuilder&& with_terms)
+    {
+        using components::RenderOrder;
+
+        _observers.push_back(
+            with_terms(world.observer<const RenderOrder>())
+                .event(flecs::OnSet)
+                .yield_existing()
+                .each([this](flecs::entity entity, const RenderOrder& order)
+                      { upsert(entity, order); })
+        );
+
+        _observers.push_back(
+            with_terms(world.observer<const RenderOrder>())
+                .event(flecs::OnRemove)
+                .each([this](flecs::entity entity, const RenderOrder&)
+                      { remove(entity); })
+        );
+    }
+
+    void upsert(flecs::entity_t entity, const components::RenderOrder& order);
+    void remove(flecs::entity_t entity);
+
+    // Merges the collected changes. Returns true if the entries were changed
+    bool apply_pending();
+
+    // Returns the position of the renderer in the sorted entries
+    uint32_t slot(flecs::entity_t entity) const
+    {
+        const auto index = entity_index(entity);
+        if (index >= _slots.size())
+        {
+            return NO_SLOT;
+        }
+
+        const auto slot = _slots[index];
+        return slot < _entries.size() && _entries[slot].entity == entity ? slot
+                                                                         : NO_SLOT;
+    }
+
+    std::span<const Entry> entries() const { return _entries; }
+
+    size_t size() const { return _entries.size(); }
+
+private:
+    struct PendingChange
+    {
+        flecs::entity_t entity;
+        components::RenderOrder order;
+        bool removed;
+    };
+
+    std::vector<flecs::observer> _observers;
+    std::vector<Entry> _entries;
+    // Slots by the entity index, which is the low part of the entity id
+    std::vector<uint32_t> _slots;
+    std::vector<PendingChange> _pending;
+    std::vector<Entry> _inserted;
+
+    static uint32_t entity_index(flecs::entity_t entity)
+    {
+        return static_cast<uint32_t>(entity);
+    }
+};
+}
@@ -1,31 +1,184 @@
 #pragma once
 
+#include "components/render_order.hpp"
+#include "rect.hpp"
+
+#include "division_engine/core/context.hpp"
+#include "division_engine/core/vertex_data.hpp"
+
+#include <division_engine_core/types/id.h>
 #include <division_engine_core/types/render_pass_instance.h>
+#include <glm/vec2.hpp>
 #include <glm/vec4.hpp>
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
-#include <utility>
+#include <map>
+#include <optional>
+#include <span>
 #include <vector>
 
 struct DivisionContext;
 
 namespace division_engine::canvas
 {
+class DamageTracker;
+
+// Whether the backend keeps the frame buffer contents between the frames
+enum class FrameBufferContents : uint8_t
+{
+    Preserved,
+    Discarded,
+};
+
+// Passes are kept by layer. The retained passes stay in the queue until their
+// source replaces them, so only the layers that were changed since the last
+// frame are sorted again and the unchanged frames are submitted as they are
 class RenderQueue
 {
 public:
-    RenderQueue(): _render_passes(), _sorted_passes() {}
+    // The fragment shaders discard the fragments outside of the scissor rect
+    // bound at this location
+    static const size_t SCISSOR_UNIFORM_LOCATION = 3;
+    // Instances of a pass described by a single block bounds
+    static const size_t BLOCK_INSTANCES = 256;
+
+    struct Pass
+    {
+        DivisionRenderPassInstance instance;
+        components::RenderOrder order;
+        // Screen bounds of the drawn instances. Unbounded passes are drawn in
+        // every damaged region
+        std::optional<Rect> bounds;
+        // Screen bounds of every BLOCK_INSTANCES instances of the pass. A
+        // damaged region redraws only the blocks it intersects, and the pass
+        // without blocks is redrawn whole
+        std::vector<Rect> block_bounds {};
+    };
+
+    RenderQueue(core::Context& context, DivisionId screen_size_uniform_id);
     RenderQueue(RenderQueue&&) = delete;
     RenderQueue& operator=(RenderQueue&&) = delete;
     RenderQueue(RenderQueue& render_queue) = delete;
     RenderQueue operator=(RenderQueue& render_queue) = delete;
-    ~RenderQueue(){}
+    ~RenderQueue();
+
+    // The pass is drawn in the next frame only
+    void enqueue_pass(
+        const DivisionRenderPassInstance& pass,
+        const components::RenderOrder& order,
+        const std::optional<Rect>& bounds = std::nullopt
+    );
+
+    // Replaces the passes the source retains in the layer. Empty passes remove
+    // the source from the layer
+    void retain_passes(const void* source, uint32_t layer, std::span<const Pass> passes);
+
+    // Removes the retained passes of the source from all layers
+    void release_passes(const void* source);
 
-    void enqueue_pass(const DivisionRenderPassInstance& pass, uint32_t order);
+    // Passes retained by the sources and enqueued for the next frame
+    size_t pass_count() const;
+
+    // Clears the frame and draws all passes
     void draw(DivisionContext* context, const glm::vec4& clear_color);
 
+    // Draws only the instances intersecting the damaged regions over the
+    // previous frame contents, unless the damage covers most of the screen. A
+    // frame is submitted even without damage, loading the previous contents.
+    // The backend loads the frame buffer when no clear color is given, and
+    // the frame is redrawn whole when it discards the contents
+    void draw(
+        DivisionContext* context,
+        const glm::vec4& clear_color,
+        DamageTracker& damage,
+        FrameBufferContents contents
+    );
+
 private:
-    std::vector<std::pair<DivisionRenderPassInstance, uint32_t>> _render_passes;
+    struct RetainedPasses
+    {
+        const void* source;
+        std::vector<Pass> passes;
+    };
+
+    struct Layer
+    {
+        std::vector<RetainedPasses> retained;
+        std::vector<Pass> transient;
+        std::vector<Pass> sorted;
+        bool dirty = false;
+    };
+
+    struct ClearVertex
+    {
+        glm::vec2 position;
+
+        static constexpr auto vertex_attributes = std::array {
+            DIVISION_DECLARE_VERTEX_ATTRIBUTE(position, 0),
+        };
+    } __attribute__((__packed__));
+
+    // Fills a damaged region with the clear color before its passes are drawn
+    struct ClearInstance
+    {
+        // Left, bottom, right, top
+        glm::vec4 rect;
+        glm::vec4 color;
+
+        static constexpr auto vertex_attributes = std::array {
+            DIVISION_DECLARE_VERTEX_ATTRIBUTE(rect, 1),
+            DIVISION_DECLARE_VERTEX_ATTRIBUTE(color, 2),
+        };
+    } __attribute__((__packed__));
+
+    // Instances of a pass redrawn in a damaged region
+    struct DamagedRun
+    {
+        const DivisionRenderPassInstance* pass;
+        size_t first_instance;
+        size_t instance_count;
+        size_t region;
+    };
+
+    core::Context _ctx;
+    std::map<uint32_t, Layer> _layers;
     std::vector<DivisionRenderPassInstance> _sorted_passes;
+    std::vector<DamagedRun> _damaged_runs;
+    std::vector<DivisionRenderPassInstance> _damaged_passes;
+    // Fragment uniforms of the submitted passes with the scissor appended
+    std::vector<DivisionIdWithBinding> _fragment_uniforms;
+    std::vector<DivisionIdWithBinding> _damaged_fragment_uniforms;
+    // The first scissor covers the whole screen, the rest are the regions
+    std::vector<DivisionId> _scissor_uniform_ids;
+    DivisionIdWithBinding _screen_size_uniform;
+    DivisionId _clear_shader_id;
+    DivisionId _clear_vertex_buffer_id;
+    DivisionId _clear_render_pass_descriptor_id;
+    bool _changed = false;
+
+    void update_layers();
+    static void submit(
+        DivisionContext* context,
+        std::span<const DivisionRenderPassInstance> passes,
+        const glm::vec4* clear_color
+    );
+
+    static void sort_layer(Layer& layer);
+    // Collects the instance runs of the pass inside of the region, merging
+    // the neighbouring blocks
+    static void add_damaged_runs(
+        std::vector<DamagedRun>& runs,
+        const Pass& pass,
+        const Rect& region,
+        size_t region_index
+    );
+    static void append_scissored_pass(
+        std::vector<DivisionRenderPassInstance>& passes,
+        std::vector<DivisionIdWithBinding>& fragment_uniforms,
+        const DivisionRenderPassInstance& pass,
+        DivisionId scissor_uniform_id
+    );
 };
-}
\ No newline at end of file
+}
@@ -9,7 +9,8 @@ namespace division_engine::canvas
 class Renderer // NOLINT
 {
 public:
-    virtual void fill_render_queue(State& state) = 0;
+    // Renderers fill the render queue from the systems of the `State::render_phase`
+    virtual void register_systems(State& state) = 0;
     virtual ~Renderer() = default;
 };
-}
\ No newline at end of file
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <flecs.h>
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+namespace division_engine::canvas
+{
+// Idle renderer entities, kept by their batch. A released renderer gets the idle
+// RenderOrder, which hides it from the drawers and the indices without moving
+// it to another table, so releasing and reusing it doesn't change its
+// archetype. The idle renderers above the limit are destroyed at the frame end
+class RendererPool
+{
+public:
+    static constexpr size_t DEFAULT_MAX_IDLE_PER_BATCH = 256;
+
+    explicit RendererPool(size_t max_idle_per_batch = DEFAULT_MAX_IDLE_PER_BATCH)
+      : _max_idle_per_batch(max_idle_per_batch)
+    {
+    }
+
+    // Returns an idle renderer of the batch, or a null entity if there is none.
+    // The renderer is drawn again once it gets a RenderOrder that isn't idle
+    flecs::entity acquire(flecs::world& world, flecs::entity_t batch);
+
+    void release(flecs::entity renderer, flecs::entity_t batch);
+
+    // Destroys the idle renderers above the limit in a single deferred batch
+    void trim(flecs::world& world);
+
+    size_t idle_count() const { return _idle_count; }
+
+private:
+    std::unordered_map<flecs::entity_t, std::vector<flecs::entity_t>> _idle;
+    size_t _max_idle_per_batch;
+    size_t _idle_count = 0;
+};
+}
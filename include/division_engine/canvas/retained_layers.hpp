@@ -0,0 +1,85 @@
+#pragma once
+
+#include "render_queue.hpp"
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+namespace division_engine::canvas
+{
+// Instance ranges of a drawer grouped by layer. The passes are retained in the
+// render queue, and only the layers whose ranges differ from the committed
+// ones are handed to the queue again
+template<typename TRange>
+class RetainedLayers
+{
+public:
+    void begin()
+    {
+        for (auto& [_, ranges] : _next)
+        {
+            ranges.clear();
+        }
+    }
+
+    void add(uint32_t layer, const TRange& range) { _next[layer].push_back(range); }
+
+    // Retains the passes of the changed layers, or of all layers when forced,
+    // e.g. when the pointers the passes hold were moved
+    template<typename TMakePass>
+    void commit(RenderQueue& queue, const void* source, bool force, TMakePass&& make_pass)
+    {
+        for (auto it = _next.begin(); it != _next.end();)
+        {
+            const auto layer = it->first;
+            const auto& ranges = it->second;
+            const auto committed_it = _committed.find(layer);
+
+            if (ranges.empty())
+            {
+                if (committed_it != _committed.end())
+                {
+                    queue.retain_passes(source, layer, {});
+                    _committed.erase(committed_it);
+                }
+
+                it = _next.erase(it);
+                continue;
+            }
+
+            if (force || committed_it == _committed.end() ||
+                committed_it->second != ranges)
+            {
+                _passes.clear();
+                for (const auto& range : ranges)
+                {
+                    _passes.push_back(make_pass(range));
+                }
+
+                queue.retain_passes(source, layer, _passes);
+                _committed[layer] = ranges;
+            }
+
+            it++;
+        }
+    }
+
+    template<typename TCallback>
+    void for_each_range(TCallback&& callback) const
+    {
+        for (const auto& [_, ranges] : _committed)
+        {
+            for (const auto& range : ranges)
+            {
+                callback(range);
+            }
+        }
+    }
+
+private:
+    std::map<uint32_t, std::vector<TRange>> _committed;
+    std::map<uint32_t, std::vector<TRange>> _next;
+    std::vector<RenderQueue::Pass> _passes;
+};
+}
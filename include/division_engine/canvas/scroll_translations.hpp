@@ -0,0 +1,95 @@
+#pragma once
+
+#include "division_engine/canvas/rect.hpp"
+#include "division_engine/core/context.hpp"
+
+#include <division_engine_core/types/id.h>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace division_engine::canvas
+{
+// Offsets and viewports of the scrolled content, read by the canvas vertex
+// shaders from a single uniform buffer. The renderers of a scroll view refer to
+// its offset by the index, so a scroll writes one entry instead of the instances
+class ScrollTranslations
+{
+public:
+    // The size of the translations array of the canvas vertex shaders
+    static constexpr size_t CAPACITY = 256;
+    // The zero offset of the renderers outside of the scroll views
+    static constexpr uint32_t NO_TRANSLATION = 0;
+    static constexpr size_t UNIFORM_LOCATION = 2;
+    // The renderers are kept for this part of the viewport size on each side of
+    // the visible content, so the drawers recull them only after the content
+    // scrolled that far
+    static constexpr float CULL_MARGIN_RATIO = 1;
+
+    explicit ScrollTranslations(core::Context& context);
+    ScrollTranslations(const ScrollTranslations&) = delete;
+    ScrollTranslations(ScrollTranslations&&) = delete;
+    ScrollTranslations& operator=(const ScrollTranslations&) = delete;
+    ScrollTranslations& operator=(ScrollTranslations&&) = delete;
+    ~ScrollTranslations();
+
+    // Returns an index with the zero offset. Throws when all of them are in use
+    uint32_t acquire();
+    void release(uint32_t index);
+
+    glm::vec2 offset(uint32_t index) const { return _offsets[index]; }
+
+    // An unchanged offset is not written
+    void set_offset(uint32_t index, glm::vec2 offset);
+
+    // Screen area the renderers of the index are cut by
+    const Rect& viewport(uint32_t index) const { return _viewports[index]; }
+
+    // An unchanged viewport is not written
+    void set_viewport(uint32_t index, const Rect& viewport);
+
+    // Content area the renderers of the index are drawn in, the visible one
+    // with the margin. The drawers cull the renderers outside of it
+    const Rect& cull_rect(uint32_t index) const { return _cull_rects[index]; }
+
+    // Area a renderer of the index with the clip is drawn in, in the space of
+    // its bounds. Nothing culls the renderers without a clip and a translation
+    std::optional<Rect> visible_rect(uint32_t index, const Rect* clip) const;
+
+    // Changes with the viewports and the cull rects, so the drawers know when
+    // to recull the translated renderers
+    uint64_t version() const { return _version; }
+
+    // The acquired indices, in no particular order
+    std::span<const uint32_t> active() const { return _active; }
+
+    DivisionId uniform_id() const { return _uniform_id; }
+
+private:
+    // Array elements of a std140 block are padded to 16 bytes
+    struct UniformBlock
+    {
+        std::array<glm::vec4, CAPACITY> offsets;
+        // Left, bottom, right, top on the screen
+        std::array<glm::vec4, CAPACITY> viewports;
+    };
+
+    core::Context _ctx;
+    DivisionId _uniform_id;
+    std::array<glm::vec2, CAPACITY> _offsets {};
+    std::array<Rect, CAPACITY> _viewports {};
+    std::array<Rect, CAPACITY> _cull_rects {};
+    uint64_t _version = 0;
+    std::vector<uint32_t> _free;
+    std::vector<uint32_t> _active;
+
+    void write_viewport(uint32_t index, const glm::vec4& viewport);
+    void update_cull_rect(uint32_t index);
+};
+}
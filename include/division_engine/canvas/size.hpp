@@ -15,25 +15,28 @@ struct Size
     float width;
     float height;
 
-    Size(float width, float height)
+    constexpr Size(float width, float height)
       : width(width)
       , height(height) {};
 
-    Size(const glm::vec2& size_vec)
+    constexpr Size(const glm::vec2& size_vec)
       : Size(size_vec.x, size_vec.y)
     {
     }
 
-    operator glm::vec2() const { return glm::vec2 { width, height }; }
+    constexpr operator glm::vec2() const { return glm::vec2 { width, height }; }
 
-    static Size unconstrainted() { return Size { UNCONSTRAINTED, UNCONSTRAINTED }; }
+    static constexpr Size unconstrainted()
+    {
+        return Size { UNCONSTRAINTED, UNCONSTRAINTED };
+    }
 
-    static Size with_unconstrainted_width(float height)
+    static constexpr Size with_unconstrainted_width(float height)
     {
         return Size { UNCONSTRAINTED, height };
     }
 
-    static Size with_unconstrainted_height(float width)
+    static constexpr Size with_unconstrainted_height(float width)
     {
         return Size { width, UNCONSTRAINTED };
     }
@@ -46,5 +49,7 @@ struct Size
     {
         return width_unconstrainted() & height_unconstrainted();
     }
+
+    bool operator==(const Size&) const = default;
 };
 }
\ No newline at end of file
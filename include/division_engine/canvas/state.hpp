@@ -1,12 +1,34 @@
 #pragma once
 
 #include "division_engine/color.hpp"
+#include "animator.hpp"
+#include "clip_stack.hpp"
+#include "components/render_order.hpp"
+#include "components/render_texture.hpp"
+#include "damage_tracker.hpp"
 #include "division_engine/core/context.hpp"
+#include "division_engine/core/frame_scheduler.hpp"
+#include "division_engine/core/input_event.hpp"
+#include "division_engine/core/input_queue.hpp"
+#include "division_engine/core/image_loader.hpp"
+#include "division_engine/core/task_pool.hpp"
+#include "division_engine/core/texture_manager.hpp"
 #include "glm/ext/vector_float2.hpp"
+#include "hit_index.hpp"
+#include "immediate_draw_list.hpp"
+#include "layer_orders.hpp"
 #include "render_queue.hpp"
+#include "renderer_pool.hpp"
+#include "scroll_translations.hpp"
 
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
 #include <ctime>
+#include <filesystem>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 #include <division_engine_core/types/id.h>
 
 #include <flecs.h>
@@ -18,17 +40,37 @@ namespace division_engine::canvas
 struct State
 {
 public:
+    static constexpr int32_t DEFAULT_THREAD_COUNT = 1;
+
     flecs::world world;
+    flecs::entity render_phase;
     glm::vec4 clear_color;
 
     core::Context context;
     DivisionId screen_size_uniform_id;
+    core::TextureManager texture_manager;
     DivisionId white_texture_id;
+    core::ImageLoader image_loader;
     RenderQueue render_queue;
+    ImmediateDrawList immediate;
+    DamageTracker damage;
+    ClipStack clip_stack;
+    ScrollTranslations scroll_translations;
+    RendererPool renderer_pool;
+    LayerOrders layer_orders;
+    HitIndex hit_index;
+    Animator animator;
 
 private:
+    std::unordered_map<DivisionId, flecs::entity_t> _texture_batches;
+    std::unordered_map<flecs::entity_t, core::ImageHandle> _image_batches;
+    // Batches of the evicted images, reloaded once they have renderers to draw
+    std::vector<flecs::entity_t> _evicted_batches;
+    std::vector<core::InputEvent> _input_events;
     glm::vec2 _prev_screen_size;
     size_t _frame_count;
+    int32_t _thread_count;
+    std::unique_ptr<core::TaskPool> _task_pool;
     bool _screen_size_changed;
 
 public:
@@ -38,18 +80,42 @@ public:
     State& operator=(State&&) = delete;
     ~State() = default;
 
-    explicit State(DivisionContext* ctx_ptr, const glm::vec4& clear_color = color::BLACK)
-      : clear_color(clear_color)
+    // The animator requests the frames of the running tweens from the frame
+    // scheduler, when there is one
+    explicit State(
+        DivisionContext* ctx_ptr,
+        const glm::vec4& clear_color = color::BLACK,
+        int32_t thread_count = DEFAULT_THREAD_COUNT,
+        core::FrameScheduler* frame_scheduler = nullptr
+    )
+      : render_phase(world.entity("CanvasRenderPhase")
+                         .add(flecs::Phase)
+                         .depends_on(flecs::OnStore))
+      , clear_color(clear_color)
       , context(ctx_ptr)
       , screen_size_uniform_id(context.create_uniform<glm::vec2>())
-      , white_texture_id(context.create_texture(
+      , texture_manager(context)
+      , white_texture_id(texture_manager.acquire(
             { 1, 1 },
-            DivisionTextureFormat::DIVISION_TEXTURE_FORMAT_RGBA32Uint
+            DivisionTextureFormat::DIVISION_TEXTURE_FORMAT_RGBA32Uint,
+            core::TextureSubsystem::Canvas
         ))
+      , image_loader(context, texture_manager, white_texture_id)
+      , render_queue(context, screen_size_uniform_id)
+      , scroll_translations(context)
+      , animator(frame_scheduler)
       , _prev_screen_size(glm::vec2 { 0 })
       , _frame_count(0)
+      , _thread_count(DEFAULT_THREAD_COUNT)
+      , _task_pool(std::make_unique<core::TaskPool>(DEFAULT_THREAD_COUNT - 1))
       , _screen_size_changed(true)
     {
+        set_thread_count(thread_count);
+        damage.observe(world, render_phase, scroll_translations);
+        layer_orders.observe(world);
+        hit_index.observe(world, render_phase, scroll_translations);
+        animator.observe(world);
+
         const uint32_t RGBA32_WHITE_PIXEL = 0xFF'FF'FF'FF;
         context.set_texture_data(
             white_texture_id,
@@ -66,10 +132,133 @@ public:
 
         _screen_size_changed = screen_size != _prev_screen_size;
         _prev_screen_size = screen_size;
+        if (_screen_size_changed)
+        {
+            damage.invalidate();
+        }
+
+        texture_manager.next_frame();
+        reload_evicted_images();
+        image_loader.update();
 
         _frame_count++;
     }
 
+    // Delivers the posted events to the handlers of the renderers under the
+    // pointer, in the order they were posted
+    void dispatch_input(core::InputQueue& input_queue)
+    {
+        input_queue.take(_input_events);
+        for (const auto& event : _input_events)
+        {
+            hit_index.dispatch(world, event);
+        }
+    }
+
+    // Returns a batch entity for the renderers drawn with the image. The image
+    // is decoded in the background and the batch is drawn with the white
+    // texture until the image is uploaded. An evicted image is drawn with the
+    // white texture as well, and is loaded again once the batch has a renderer
+    // to draw
+    flecs::entity load_image(const std::filesystem::path& path)
+    {
+        auto batch = world.entity().set(components::RenderTexture { white_texture_id });
+        const auto handle = image_loader.load(
+            path,
+            [this, batch](DivisionId texture_id)
+            {
+                batch.set(components::RenderTexture { texture_id });
+                if (texture_id == white_texture_id)
+                {
+                    _evicted_batches.push_back(batch.id());
+                }
+            }
+        );
+        _image_batches.insert_or_assign(batch.id(), handle);
+
+        return batch;
+    }
+
+    // Returns the batch entity shared by the renderers drawn with the texture
+    flecs::entity texture_batch(DivisionId texture_id)
+    {
+        const auto it = _texture_batches.find(texture_id);
+        if (it != _texture_batches.end())
+        {
+            return flecs::entity { world, it->second };
+        }
+
+        auto batch = world.entity().set(components::RenderTexture { texture_id });
+        _texture_batches.emplace(texture_id, batch.id());
+        return batch;
+    }
+
+    // Worker threads are shared by every multithreaded system of the world:
+    // user systems and the renderers from the render phase alike. The task
+    // pool is sized the same
+    void set_thread_count(int32_t thread_count)
+    {
+        thread_count = std::max(thread_count, 1);
+        if (thread_count == _thread_count)
+        {
+            return;
+        }
+
+        world.set_threads(thread_count);
+        _task_pool.reset();
+        _task_pool =
+            std::make_unique<core::TaskPool>(static_cast<size_t>(thread_count - 1));
+        _thread_count = thread_count;
+    }
+
+    int32_t thread_count() const { return _thread_count; }
+
+    // Runs the flat layout on the thread count of the world, the calling
+    // thread included. The layout runs between the world frames, so its
+    // workers don't compete with the world ones for the cores
+    core::TaskPool& task_pool() { return *_task_pool; }
+
+private:
+    void reload_evicted_images()
+    {
+        std::erase_if(
+            _evicted_batches,
+            [this](flecs::entity_t batch_id)
+            {
+                const flecs::entity batch { world, batch_id };
+                if (!batch.is_alive())
+                {
+                    _image_batches.erase(batch_id);
+                    return true;
+                }
+
+                if (!has_drawn_renderer(batch))
+                {
+                    return false;
+                }
+
+                image_loader.reload(_image_batches.at(batch_id));
+                return true;
+            }
+        );
+    }
+
+    // The pooled renderers keep their batch, but their idle order isn't drawn
+    bool has_drawn_renderer(flecs::entity batch)
+    {
+        auto filter = world.filter_builder<const components::RenderOrder>()
+                          .term(flecs::IsA, batch)
+                          .build();
+
+        bool drawn = false;
+        filter.each([&](const components::RenderOrder& order)
+                    { drawn = drawn || !order.is_idle(); });
+        filter.destruct();
+
+        return drawn;
+    }
+
+public:
     bool screen_size_changed() const { return _screen_size_changed; }
     size_t frame_count() const { return _frame_count; } 
 };
@@ -1,21 +1,32 @@
 #pragma once
 
 #include "components/render_bounds.hpp"
+#include "components/render_clip.hpp"
 #include "components/render_order.hpp"
 #include "components/render_texture.hpp"
+#include "components/render_translation.hpp"
 #include "components/renderable_text.hpp"
 #include "division_engine/canvas/renderer.hpp"
+#include "division_engine/canvas/render_order_index.hpp"
+#include "division_engine/canvas/render_queue.hpp"
+#include "division_engine/canvas/retained_layers.hpp"
 #include "state.hpp"
 
 #include "division_engine/core/context.hpp"
 #include "division_engine/core/font_texture.hpp"
+#include "division_engine/core/vertex_buffer_data.hpp"
 #include "division_engine/core/vertex_data.hpp"
 
 #include <division_engine_core/types/id.h>
+#include <flecs.h>
 #include <glm/vec2.hpp>
 #include <glm/vec4.hpp>
 
+#include <array>
+#include <cstdint>
 #include <filesystem>
+#include <optional>
+#include <span>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -46,6 +57,9 @@ public:
         glm::vec2 position;
         glm::vec2 glyph_in_tex_size;
         glm::vec2 tex_size;
+        glm::vec4 clip_rect;
+        // Index into the scroll translations, exact as a float
+        float translation_index;
 
         static constexpr auto vertex_attributes = std::array {
             DIVISION_DECLARE_VERTEX_ATTRIBUTE(color, 2),
@@ -54,6 +68,8 @@ public:
             DIVISION_DECLARE_VERTEX_ATTRIBUTE(position, 5),
             DIVISION_DECLARE_VERTEX_ATTRIBUTE(glyph_in_tex_size, 6),
             DIVISION_DECLARE_VERTEX_ATTRIBUTE(tex_size, 7),
+            DIVISION_DECLARE_VERTEX_ATTRIBUTE(clip_rect, 8),
+            DIVISION_DECLARE_VERTEX_ATTRIBUTE(translation_index, 9),
         };
     } __attribute__((__packed__));
 
@@ -74,7 +90,7 @@ public:
     TextDrawer(State& state, const std::filesystem::path& font_path);
     ~TextDrawer() override;
 
-    void fill_render_queue(State& state) override;
+    void register_systems(State& state) override;
 
 private:
     using Context = core::Context;
@@ -83,6 +99,8 @@ private:
     using FontTexture = core::FontTexture;
     using RenderOrder = components::RenderOrder;
     using RenderTexture = components::RenderTexture;
+    using RenderClip = components::RenderClip;
+    using RenderTranslation = components::RenderTranslation;
 
     struct WordInfo
     {
@@ -90,24 +108,84 @@ private:
         float width;
     };
 
+    struct InstanceRange
+    {
+        size_t first_instance;
+        size_t count;
+        RenderOrder order;
+        Rect bounds;
+
+        bool operator==(const InstanceRange&) const = default;
+    };
+
     FontTexture _font_texture;
     std::vector<DivisionIdWithBinding> _texture_bindings;
-    flecs::query<const RenderBounds, const RenderableText, const RenderOrder> _query;
-
+    flecs::query<
+        const RenderBounds,
+        const RenderableText,
+        const RenderClip*,
+        const RenderTranslation*>
+        _query;
+
+    std::vector<flecs::system> _systems;
+    RenderOrderIndex _order_index;
+    // Each slot of the order index and each immediate item reserves an
+    // instance per character. The last element is the overall instance count
+    std::vector<size_t> _renderable_instance_offsets;
+    std::vector<Rect> _slot_bounds;
+    RetainedLayers<InstanceRange> _retained_layers;
+    // The split keys the retained ranges were built with
+    std::vector<uint64_t> _split_keys;
+    // The retained texts are refilled this frame
+    bool _retained_dirty = true;
+    // The version of the scroll translations the texts were culled with
+    uint64_t _translations_version = 0;
+    std::optional<core::VertexBufferData<TextCharVertex, TextCharInstance>>
+        _vertex_buffer_data;
+    std::span<TextCharInstance> _instances;
+    size_t _instance_capacity;
+
+    RenderQueue& _render_queue;
+    const ScrollTranslations& _scroll_translations;
     Context _ctx;
 
-    DivisionIdWithBinding _screen_size_uniform;
+    // The screen size, followed by the scroll translations read by the vertex shader
+    std::array<DivisionIdWithBinding, 2> _uniforms;
     DivisionId _shader_id;
     DivisionId _vertex_buffer_id;
     DivisionId _render_pass_descriptor_id;
 
     WordInfo get_next_word(const std::string_view& text, float font_scale) const;
 
+    void reserve_instances(State& state);
+    void fill_instances(
+        flecs::iter& it,
+        const RenderBounds* bounds_ptr,
+        const RenderableText* renderable_ptr,
+        const RenderClip* clip_ptr,
+        const RenderTranslation* translation_ptr
+    );
+    void enqueue_passes(State& state);
+    void build_retained_ranges(std::span<const uint64_t> split_keys);
+    RenderQueue::Pass make_render_pass(const InstanceRange& range);
+
+    void fill_renderable_instances(
+        size_t renderable_index,
+        const Rect& bounds,
+        std::string_view text,
+        const glm::vec4& color,
+        float font_size,
+        const glm::vec4& clip_rect = RenderClip::NO_CLIP_RECT,
+        uint32_t translation_index = ScrollTranslations::NO_TRANSLATION
+    );
+
     size_t add_renderable_to_vertex_buffer(
         std::span<TextCharInstance> instances,
-        const RenderBounds& bounds,
-        const RenderableText& renderable
-    );
+        const Rect& bounds,
+        std::string_view text,
+        const glm::vec4& color,
+        float font_size
+    ) const;
 
     void add_word_to_vertex_buffer(
         const std::string_view& word,
@@ -115,6 +193,6 @@ private:
         const glm::vec4& color,
         float font_scale,
         std::span<TextCharInstance> instances
-    );
+    ) const;
 };
 }
\ No newline at end of file
@@ -1,100 +1,387 @@
 #pragma once
 
 #include "division_engine/canvas/box_constraints.hpp"
+#include "division_engine/canvas/flat_layout.hpp"
+#include "division_engine/canvas/rect.hpp"
 #include "division_engine/canvas/render_manager.hpp"
 #include "division_engine/canvas/size.hpp"
 #include "division_engine/canvas/state.hpp"
+#include "division_engine/canvas/view_tree/layout_cache.hpp"
+#include "division_engine/canvas/view_tree/render_entities.hpp"
 #include "division_engine/canvas/view_tree/view.hpp"
-#include <any>
-#include <functional>
-#include <memory>
+#include "division_engine/core/exception.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace division_engine::canvas::view_tree
 {
-struct AnyView
+namespace detail
 {
-    using renderer_ptr_factory_func_t =
-        std::function<std::shared_ptr<void>(State&, RenderManager&, const void* view)>;
-    using layout_func_t = std::function<
-        Size(void* this_renderer, const BoxConstraints& constraints, const void* view)>;
-    using render_func_t = std::function<void(
-        void* this_renderer,
-        State& state,
-        RenderManager& render_manager,
-        Rect& rect,
-        const void* view
-    )>;
+// Type erased object, placed in the inline buffer when it fits and on the heap
+// otherwise. The owner knows the type and passes it to every operation
+class ErasedBox
+{
+public:
+    static constexpr size_t INLINE_SIZE = 64;
 
-    struct Renderer;
+    template<typename T>
+    static constexpr bool fits_inline =
+        sizeof(T) <= INLINE_SIZE && alignof(T) <= alignof(std::max_align_t) &&
+        std::is_nothrow_move_constructible_v<T>;
 
-    std::shared_ptr<void> view_ptr;
-    renderer_ptr_factory_func_t renderer_ctr_func;
-    layout_func_t layout_func;
-    render_func_t render_func;
+    ErasedBox() = default;
+    ErasedBox(const ErasedBox&) = delete;
+    ErasedBox& operator=(const ErasedBox&) = delete;
 
-    template<View V>
-    AnyView(V v)
-      : view_ptr(std::make_shared<V>(v))
-      , renderer_ctr_func(
-            [](State& state, RenderManager& render_manager, const void* view)
+    void* get() const { return _ptr; }
+
+    template<typename T, typename... Args>
+    void emplace(Args&&... args)
+    {
+        if constexpr (fits_inline<T>)
+        {
+            _ptr = new (_buffer) T(std::forward<Args>(args)...);
+        }
+        else
+        {
+            _ptr = new T(std::forward<Args>(args)...);
+        }
+    }
+
+    template<typename T>
+    void move_from(ErasedBox& other) noexcept
+    {
+        if constexpr (fits_inline<T>)
+        {
+            if (other._ptr != nullptr)
             {
-                return std::make_shared<typename V::Renderer>(typename V::Renderer {
-                    state, render_manager, *static_cast<const V*>(view) });
+                emplace<T>(std::move(*static_cast<T*>(other._ptr)));
+                other.destroy<T>();
             }
+        }
+        else
+        {
+            _ptr = std::exchange(other._ptr, nullptr);
+        }
+    }
+
+    template<typename T>
+    void destroy() noexcept
+    {
+        if (_ptr == nullptr)
+        {
+            return;
+        }
+
+        if constexpr (fits_inline<T>)
+        {
+            static_cast<T*>(_ptr)->~T();
+        }
+        else
+        {
+            delete static_cast<T*>(_ptr);
+        }
+        _ptr = nullptr;
+    }
+
+private:
+    alignas(std::max_align_t) std::byte _buffer[INLINE_SIZE];
+    void* _ptr = nullptr;
+};
+}
+
+// Any view and its renderer, with a single static function table per view type.
+// Views and renderers of up to ErasedBox::INLINE_SIZE bytes are not allocated
+class AnyView
+{
+public:
+    struct Renderer;
+
+    template<typename V>
+        requires(!std::is_same_v<std::remove_cvref_t<V>, AnyView> && View<V>)
+    AnyView(V v)
+      : _vtable(&VTABLE<V>)
+    {
+        _view.emplace<V>(std::move(v));
+    }
+
+    AnyView(const AnyView& other)
+      : _vtable(other._vtable)
+    {
+        _vtable->copy_view(_view, other._view);
+    }
+
+    AnyView(AnyView&& other) noexcept
+      : _vtable(other._vtable)
+    {
+        _vtable->move_view(_view, other._view);
+    }
+
+    AnyView& operator=(const AnyView& other)
+    {
+        if (this != &other)
+        {
+            _vtable->destroy_view(_view);
+            _vtable = other._vtable;
+            _vtable->copy_view(_view, other._view);
+        }
+        return *this;
+    }
+
+    AnyView& operator=(AnyView&& other) noexcept
+    {
+        if (this != &other)
+        {
+            _vtable->destroy_view(_view);
+            _vtable = other._vtable;
+            _vtable->move_view(_view, other._view);
+        }
+        return *this;
+    }
+
+    ~AnyView() { _vtable->destroy_view(_view); }
+
+    // Differs for the views of different types
+    size_t layout_hash() const
+    {
+        return combine_layout_hash(
+            reinterpret_cast<size_t>(_vtable), _vtable->layout_hash(_view.get())
+        );
+    }
+
+private:
+    using ErasedBox = detail::ErasedBox;
+
+    struct VTable
+    {
+        void (*copy_view)(ErasedBox& dst, const ErasedBox& src);
+        void (*move_view)(ErasedBox& dst, ErasedBox& src) noexcept;
+        void (*destroy_view)(ErasedBox& view) noexcept;
+
+        void (*create_renderer)(
+            ErasedBox& dst,
+            State& state,
+            RenderManager& render_manager,
+            const void* view
+        );
+        void (*move_renderer)(ErasedBox& dst, ErasedBox& src) noexcept;
+        void (*destroy_renderer)(ErasedBox& renderer) noexcept;
+        void (*collect_entities)(
+            const void* renderer,
+            std::vector<flecs::entity>& entities
+        );
+
+        size_t (*layout_hash)(const void* view);
+        Size (*layout)(
+            void* renderer,
+            const BoxConstraints& constraints,
+            const void* view
+        );
+        void (*render)(
+            void* renderer,
+            State& state,
+            RenderManager& render_manager,
+            Rect& rect,
+            const void* view
+        );
+        void (*flatten)(
+            void* renderer,
+            State& state,
+            RenderManager& render_manager,
+            FlatLayout& layout,
+            uint32_t parent,
+            const void* view
+        );
+    };
+
+    template<View V>
+    struct ViewFunctions
+    {
+        using renderer_type = typename V::Renderer;
+
+        static void copy_view(ErasedBox& dst, const ErasedBox& src)
+        {
+            dst.emplace<V>(*static_cast<const V*>(src.get()));
+        }
+
+        static void move_view(ErasedBox& dst, ErasedBox& src) noexcept
+        {
+            dst.move_from<V>(src);
+        }
+
+        static void destroy_view(ErasedBox& view) noexcept { view.destroy<V>(); }
+
+        static void create_renderer(
+            ErasedBox& dst,
+            State& state,
+            RenderManager& render_manager,
+            const void* view
         )
-      , layout_func(
-            [](void* this_renderer, const BoxConstraints& constraints, const void* view)
+        {
+            dst.emplace<renderer_type>(
+                state, render_manager, *static_cast<const V*>(view)
+            );
+        }
+
+        static void move_renderer(ErasedBox& dst, ErasedBox& src) noexcept
+        {
+            dst.move_from<renderer_type>(src);
+        }
+
+        static void destroy_renderer(ErasedBox& renderer) noexcept
+        {
+            renderer.destroy<renderer_type>();
+        }
+
+        static void
+        collect_entities(const void* renderer, std::vector<flecs::entity>& entities)
+        {
+            collect_render_entities(
+                *static_cast<const renderer_type*>(renderer), entities
+            );
+        }
+
+        static size_t layout_hash(const void* view)
+        {
+            return view_tree::layout_hash(*static_cast<const V*>(view));
+        }
+
+        static Size
+        layout(void* renderer, const BoxConstraints& constraints, const void* view)
+        {
+            return static_cast<renderer_type*>(renderer)->layout(
+                constraints, *static_cast<const V*>(view)
+            );
+        }
+
+        static void render(
+            void* renderer,
+            State& state,
+            RenderManager& render_manager,
+            Rect& rect,
+            const void* view
+        )
+        {
+            static_cast<renderer_type*>(renderer)->render(
+                state, render_manager, rect, *static_cast<const V*>(view)
+            );
+        }
+
+        static void flatten(
+            void* renderer,
+            State& state,
+            RenderManager& render_manager,
+            FlatLayout& layout,
+            uint32_t parent,
+            const void* view
+        )
+        {
+            if constexpr (requires(renderer_type& r) {
+                              r.flatten(
+                                  state,
+                                  render_manager,
+                                  layout,
+                                  parent,
+                                  *static_cast<const V*>(view)
+                              );
+                          })
             {
-                auto func = std::mem_fn(&V::Renderer::layout);
-                return func(
-                    *static_cast<typename V::Renderer*>(this_renderer),
-                    constraints,
-                    *static_cast<const V*>(view)
+                static_cast<renderer_type*>(renderer)->flatten(
+                    state, render_manager, layout, parent, *static_cast<const V*>(view)
                 );
             }
-        )
-      , render_func(
-            [](void* this_renderer,
-               State& state,
-               RenderManager& render_manager,
-               Rect& rect,
-               const void* view)
+            else
             {
-                auto func = std::mem_fn(&V::Renderer::render);
-                func(
-                    *static_cast<typename V::Renderer*>(this_renderer),
-                    state,
-                    render_manager,
-                    rect,
-                    *static_cast<const V*>(view)
-                );
+                throw core::Exception { "The view does not support the flat layout" };
             }
-        )
-    {
-    }
+        }
+    };
+
+    template<View V>
+    static constexpr VTable VTABLE {
+        .copy_view = &ViewFunctions<V>::copy_view,
+        .move_view = &ViewFunctions<V>::move_view,
+        .destroy_view = &ViewFunctions<V>::destroy_view,
+        .create_renderer = &ViewFunctions<V>::create_renderer,
+        .move_renderer = &ViewFunctions<V>::move_renderer,
+        .destroy_renderer = &ViewFunctions<V>::destroy_renderer,
+        .collect_entities = &ViewFunctions<V>::collect_entities,
+        .layout_hash = &ViewFunctions<V>::layout_hash,
+        .layout = &ViewFunctions<V>::layout,
+        .render = &ViewFunctions<V>::render,
+        .flatten = &ViewFunctions<V>::flatten,
+    };
+
+    const VTable* _vtable;
+    ErasedBox _view;
 };
 
 struct AnyView::Renderer
 {
-    std::shared_ptr<void> renderer_ptr;
-
     Renderer(State& state, RenderManager& render_manager, const AnyView& view)
-      : renderer_ptr(view.renderer_ctr_func(state, render_manager, view.view_ptr.get()))
+      : _vtable(view._vtable)
+    {
+        _vtable->create_renderer(_renderer, state, render_manager, view._view.get());
+    }
+
+    Renderer(Renderer&& other) noexcept
+      : _vtable(other._vtable)
+    {
+        _vtable->move_renderer(_renderer, other._renderer);
+    }
+
+    Renderer& operator=(Renderer&& other) noexcept
     {
+        if (this != &other)
+        {
+            _vtable->destroy_renderer(_renderer);
+            _vtable = other._vtable;
+            _vtable->move_renderer(_renderer, other._renderer);
+        }
+        return *this;
+    }
+
+    Renderer(const Renderer&) = delete;
+    Renderer& operator=(const Renderer&) = delete;
+
+    ~Renderer() { _vtable->destroy_renderer(_renderer); }
+
+    void collect_entities(std::vector<flecs::entity>& entities) const
+    {
+        _vtable->collect_entities(_renderer.get(), entities);
     }
 
     Size layout(const BoxConstraints& constraints, const AnyView& view)
     {
-        return view.layout_func(renderer_ptr.get(), constraints, view.view_ptr.get());
+        return _vtable->layout(_renderer.get(), constraints, view._view.get());
     }
 
     void
     render(State& state, RenderManager& render_manager, Rect& rect, const AnyView& view)
     {
-        view.render_func(
-            renderer_ptr.get(), state, render_manager, rect, view.view_ptr.get()
+        _vtable->render(_renderer.get(), state, render_manager, rect, view._view.get());
+    }
+
+    void flatten(
+        State& state,
+        RenderManager& render_manager,
+        FlatLayout& layout,
+        uint32_t parent,
+        const AnyView& view
+    )
+    {
+        _vtable->flatten(
+            _renderer.get(), state, render_manager, layout, parent, view._view.get()
         );
     }
-};
 
-}
\ No newline at end of file
+private:
+    const VTable* _vtable;
+    ErasedBox _renderer;
+};
+}
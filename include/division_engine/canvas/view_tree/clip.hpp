@@ -0,0 +1,79 @@
+#pragma once
+
+#include "division_engine/canvas/box_constraints.hpp"
+#include "division_engine/canvas/flat_layout.hpp"
+#include "division_engine/canvas/rect.hpp"
+#include "division_engine/canvas/render_manager.hpp"
+#include "division_engine/canvas/size.hpp"
+#include "division_engine/canvas/state.hpp"
+#include "division_engine/canvas/view_tree/layout_cache.hpp"
+#include "division_engine/canvas/view_tree/render_entities.hpp"
+#include "division_engine/canvas/view_tree/view.hpp"
+
+#include <vector>
+
+namespace division_engine::canvas::view_tree
+{
+// Draws the child only inside of the rect given to the view
+template<View TChild>
+struct Clip
+{
+    struct Renderer;
+
+    TChild child;
+
+    constexpr Clip(TChild child)
+      : child(child)
+    {
+    }
+
+    size_t layout_hash() const { return view_tree::layout_hash(child); }
+
+    bool operator==(const Clip&) const = default;
+};
+
+template<View TChild>
+struct Clip<TChild>::Renderer
+{
+    using view_type = Clip<TChild>;
+    using child_renderer_type = typename TChild::Renderer;
+
+    child_renderer_type child_renderer;
+
+    Renderer(State& state, RenderManager& render_manager, const view_type& view)
+      : child_renderer(state, render_manager, view.child)
+    {
+    }
+
+    void collect_entities(std::vector<flecs::entity>& entities) const
+    {
+        collect_render_entities(child_renderer, entities);
+    }
+
+    void flatten(
+        State& state,
+        RenderManager& render_manager,
+        FlatLayout& layout,
+        uint32_t parent,
+        const view_type& view
+    )
+    {
+        const auto node = layout.push(FlatLayout::NodeKind::Clip, parent);
+        child_renderer.flatten(state, render_manager, layout, node, view.child);
+        layout.end(node);
+    }
+
+    Size layout(const BoxConstraints& constraints, const view_type& view)
+    {
+        return child_renderer.layout(constraints, view.child);
+    }
+
+    void
+    render(State& state, RenderManager& render_manager, Rect& rect, const view_type& view)
+    {
+        state.clip_stack.push(rect);
+        child_renderer.render(state, render_manager, rect, view.child);
+        state.clip_stack.pop();
+    }
+};
+}
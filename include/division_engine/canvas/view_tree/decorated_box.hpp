@@ -5,12 +5,15 @@
 #include "division_engine/canvas/components/render_bounds.hpp"
 #include "division_engine/canvas/components/render_texture.hpp"
 #include "division_engine/canvas/components/renderable_rect.hpp"
+#include "division_engine/canvas/flat_layout.hpp"
 #include "division_engine/canvas/rect.hpp"
 #include "division_engine/canvas/rect_drawer.hpp"
 #include "division_engine/canvas/render_manager.hpp"
 #include "division_engine/canvas/renderer.hpp"
+#include "division_engine/canvas/renderer_pool.hpp"
 #include "division_engine/canvas/size.hpp"
 #include "division_engine/canvas/state.hpp"
+#include "division_engine/canvas/view_tree/render_entities.hpp"
 #include "division_engine/color.hpp"
 
 #include <flecs.h>
@@ -18,6 +21,7 @@
 #include <glm/vec4.hpp>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 namespace division_engine::canvas::view_tree
 {
@@ -27,6 +31,8 @@ struct DecoratedBox
 
     glm::vec4 background_color = color::WHITE;
     BorderRadius border_radius = BorderRadius::all(0);
+
+    bool operator==(const DecoratedBox&) const = default;
 };
 
 struct DecoratedBox::Renderer
@@ -34,15 +40,25 @@ struct DecoratedBox::Renderer
     using view_type = DecoratedBox;
 
     flecs::entity entity;
+    // The entity goes back to the pool with the renderer
+    RendererPool* pool = nullptr;
+    flecs::entity_t batch = 0;
+    // The view and the rect written last. The components are written only when
+    // they change, so the values tweened by the animator stay until then
+    view_type rendered_view;
+    Rect rendered_rect;
 
     Renderer(State& state, RenderManager& render_manager, const view_type& view)
+      : pool(&state.renderer_pool)
+      , rendered_view(view)
     {
         using namespace components;
 
-        auto batch_entity =
-            state.world.entity().set(RenderTexture { state.white_texture_id });
+        const auto batch_entity = state.texture_batch(state.white_texture_id).id();
+        batch =
+            render_manager.batch_for<RenderableRect, RenderBounds>(state, batch_entity);
 
-        entity = render_manager.create_renderer(
+        entity = render_manager.acquire_renderer(
             state,
             RectDrawer::renderable_type {
                 RenderableRect {
@@ -50,13 +66,17 @@ struct DecoratedBox::Renderer
                     .border_radius = view.border_radius,
                 },
                 RenderBounds { Rect::from_center(glm::vec2 { 0 }, glm::vec2 { 0 }) } },
-            batch_entity.id()
+            batch_entity
         );
     }
     
     Renderer& operator=(Renderer&& other) noexcept
     {
         entity = std::exchange(other.entity, flecs::entity::null());
+        pool = other.pool;
+        batch = other.batch;
+        rendered_view = std::move(other.rendered_view);
+        rendered_rect = other.rendered_rect;
         return *this;
     }
 
@@ -75,7 +95,12 @@ struct DecoratedBox::Renderer
             return;
         }
 
-        entity.destruct();
+        pool->release(entity, batch);
+    }
+
+    void collect_entities(std::vector<flecs::entity>& entities) const
+    {
+        entities.push_back(entity);
     }
 
     Size layout(const BoxConstraints& constraints, const view_type& view)
@@ -88,12 +113,46 @@ struct DecoratedBox::Renderer
     {
         using namespace components;
 
-        auto& renderable = *entity.get_mut<RenderableRect>();
-        renderable.color = view.background_color;
-        renderable.border_radius = view.border_radius;
+        update_props(view);
+
+        if (rendered_rect != rect)
+        {
+            rendered_rect = rect;
+            entity.set(RenderBounds { rect });
+        }
+
+        state.clip_stack.apply(entity);
+    }
 
-        auto& bounds = *entity.get_mut<RenderBounds>();
-        bounds = rect;
+    void flatten(
+        State& state,
+        RenderManager& render_manager,
+        FlatLayout& layout,
+        uint32_t parent,
+        const view_type& view
+    )
+    {
+        update_props(view);
+        const auto node =
+            layout.push(FlatLayout::NodeKind::Leaf, parent, glm::vec4 { 0 }, entity);
+        layout.end(node);
+    }
+
+private:
+    void update_props(const view_type& view)
+    {
+        using namespace components;
+
+        // A static tree built each frame doesn't trigger the change detection
+        // of the drawers
+        if (rendered_view != view)
+        {
+            rendered_view = view;
+            auto& mut_renderable = *entity.get_mut<RenderableRect>();
+            mut_renderable.color = view.background_color;
+            mut_renderable.border_radius = view.border_radius;
+            entity.modified<RenderableRect>();
+        }
     }
 };
 }
\ No newline at end of file
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "division_engine/canvas/flat_layout.hpp"
+#include "division_engine/canvas/rect.hpp"
+#include "division_engine/canvas/render_manager.hpp"
+#include "division_engine/canvas/state.hpp"
+#include "division_engine/core/task_pool.hpp"
+
+namespace division_engine::canvas::view_tree
+{
+// Renders the view tree through the flat layout instead of the recursive
+// `render`: the renderers are updated while the tree is flattened, then the
+// whole layout is solved and written at once. The layout arrays are kept by
+// the caller to be reused between the frames. The task pool only solves the
+// layout, the entities are written on the calling thread
+template<typename TRenderer, typename TView>
+void render_flat(
+    State& state,
+    RenderManager& render_manager,
+    FlatLayout& layout,
+    TRenderer& renderer,
+    const TView& view,
+    const Rect& rect,
+    core::TaskPool* task_pool = nullptr
+)
+{
+    layout.clear();
+    renderer.flatten(state, render_manager, layout, FlatLayout::NO_PARENT, view);
+    layout.solve(rect, task_pool);
+    layout.apply(state.world);
+}
+}
@@ -0,0 +1,379 @@
+#pragma once
+
+#include "division_engine/canvas/box_constraints.hpp"
+#include "division_engine/canvas/components/render_order.hpp"
+#include "division_engine/canvas/flat_layout.hpp"
+#include "division_engine/canvas/rect.hpp"
+#include "division_engine/canvas/render_manager.hpp"
+#include "division_engine/canvas/size.hpp"
+#include "division_engine/canvas/state.hpp"
+#include "division_engine/canvas/view_tree/list.hpp"
+#include "division_engine/canvas/view_tree/render_entities.hpp"
+#include "division_engine/canvas/view_tree/view.hpp"
+
+#include <flecs.h>
+#include <glm/vec2.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace division_engine::canvas::view_tree
+{
+// List of a runtime sized collection. Children are matched to the renderers of
+// the previous frame by their keys, so the surviving children keep their
+// renderers and entities, and only the moved ones get new render orders.
+// The moved and the created renderers stay below the renderers of the views
+// that follow the list
+template<typename TKey, View TItemView>
+struct KeyedList
+{
+    struct Renderer;
+
+    struct Item
+    {
+        TKey key;
+        TItemView view;
+
+        bool operator==(const Item&) const = default;
+    };
+
+    std::vector<Item> items;
+    Direction direction = Direction::Vertical;
+
+    // The vector comparison doesn't check the items by itself
+    bool operator==(const KeyedList&) const
+        requires std::equality_comparable<TKey> && std::equality_comparable<TItemView>
+    = default;
+};
+
+template<typename TKey, View TItemView>
+struct KeyedList<TKey, TItemView>::Renderer
+{
+    using view_type = KeyedList<TKey, TItemView>;
+    using item_renderer_type = typename TItemView::Renderer;
+
+    std::vector<TKey> keys;
+    std::vector<item_renderer_type> item_renderers;
+    // The lowest renderer above the list, found at the last reconciliation
+    std::optional<flecs::entity> bound_above;
+
+    Renderer(State& state, RenderManager& render_manager, const view_type& view)
+    {
+        reconcile(state, render_manager, view);
+    }
+
+    void collect_entities(std::vector<flecs::entity>& entities) const
+    {
+        for (const auto& item_renderer : item_renderers)
+        {
+            collect_render_entities(item_renderer, entities);
+        }
+    }
+
+    void flatten(
+        State& state,
+        RenderManager& render_manager,
+        FlatLayout& layout,
+        uint32_t parent,
+        const view_type& view
+    )
+    {
+        if (!std::ranges::equal(
+                keys, view.items, {}, {}, [](const Item& item) { return item.key; }
+            ))
+        {
+            reconcile(state, render_manager, view);
+        }
+
+        const auto node = layout.push(
+            view.direction == Direction::Vertical ? FlatLayout::NodeKind::VerticalList
+                                                  : FlatLayout::NodeKind::HorizontalList,
+            parent
+        );
+        for (size_t i = 0; i < item_renderers.size(); i++)
+        {
+            item_renderers[i].flatten(
+                state, render_manager, layout, node, view.items[i].view
+            );
+        }
+        layout.end(node);
+    }
+
+    Size layout(const BoxConstraints& constraints, const view_type& view)
+    {
+        return Size::unconstrainted();
+    }
+
+    void
+    render(State& state, RenderManager& render_manager, Rect& rect, const view_type& view)
+    {
+        if (!std::ranges::equal(
+                keys, view.items, {}, {}, [](const Item& item) { return item.key; }
+            ))
+        {
+            reconcile(state, render_manager, view);
+        }
+
+        const auto vertical = view.direction == Direction::Vertical;
+        const auto main = [vertical](glm::vec2& v) -> float&
+        { return vertical ? v.y : v.x; };
+        const auto cross = [vertical](glm::vec2& v) -> float&
+        { return vertical ? v.x : v.y; };
+
+        auto rect_size = rect.size();
+
+        // Fixed size children are measured first, the others share the rest
+        std::vector<glm::vec2> child_sizes(view.items.size());
+        glm::vec2 available_size = rect_size;
+        size_t filled_count = 0;
+
+        for (size_t i = 0; i < view.items.size(); i++)
+        {
+            const BoxConstraints constraints {
+                .min_size = glm::vec2 { 0 },
+                .max_size = available_size,
+            };
+            child_sizes[i] =
+                item_renderers[i].layout(constraints, view.items[i].view);
+
+            if (std::isinf(main(child_sizes[i])))
+            {
+                filled_count++;
+            }
+            else
+            {
+                main(available_size) -= main(child_sizes[i]);
+            }
+        }
+
+        const auto filled_extent =
+            filled_count > 0 ? main(available_size) / static_cast<float>(filled_count)
+                             : 0;
+
+        float offset = 0;
+        for (size_t i = 0; i < view.items.size(); i++)
+        {
+            auto item_size = child_sizes[i];
+            if (std::isinf(main(item_size)))
+            {
+                main(item_size) = filled_extent;
+            }
+            if (std::isinf(cross(item_size)))
+            {
+                cross(item_size) = cross(rect_size);
+            }
+
+            const auto top_left = vertical
+                                      ? glm::vec2 { rect.left(), rect.top() - offset }
+                                      : glm::vec2 { rect.left() + offset, rect.top() };
+            auto item_rect = Rect::from_top_left(top_left, item_size);
+
+            item_renderers[i].render(
+                state, render_manager, item_rect, view.items[i].view
+            );
+            offset += main(item_size);
+        }
+    }
+
+private:
+    static constexpr auto NO_SOURCE = std::numeric_limits<size_t>::max();
+
+    // Matches the new items to the renderers by key. The renderers of the
+    // items on the longest increasing run of old positions stay in place, the
+    // others are placed between their new neighbours
+    void reconcile(State& state, RenderManager& render_manager, const view_type& view)
+    {
+        // Found before the created renderers are put on top of the layer
+        bound_above = find_bound_above(state);
+
+        std::unordered_map<TKey, size_t> old_indices;
+        old_indices.reserve(keys.size());
+        for (size_t i = 0; i < keys.size(); i++)
+        {
+            old_indices.emplace(keys[i], i);
+        }
+
+        const auto item_count = view.items.size();
+        std::vector<size_t> sources(item_count, NO_SOURCE);
+        for (size_t i = 0; i < item_count; i++)
+        {
+            const auto it = old_indices.find(view.items[i].key);
+            if (it != old_indices.end())
+            {
+                sources[i] = it->second;
+                // A repeated key gets a new renderer
+                old_indices.erase(it);
+            }
+        }
+
+        const auto stable = longest_increasing_sources(sources);
+
+        // The renderers of the removed items are destroyed with the old vector
+        auto old_renderers = std::move(item_renderers);
+        item_renderers.clear();
+        item_renderers.reserve(item_count);
+        keys.clear();
+        keys.reserve(item_count);
+
+        for (size_t i = 0; i < item_count; i++)
+        {
+            const auto& item = view.items[i];
+            keys.push_back(item.key);
+
+            if (sources[i] != NO_SOURCE)
+            {
+                item_renderers.push_back(std::move(old_renderers[sources[i]]));
+            }
+            else
+            {
+                item_renderers.push_back(
+                    item_renderer_type { state, render_manager, item.view }
+                );
+            }
+        }
+
+        place_unstable_items(state, render_manager, sources, stable);
+    }
+
+    std::optional<flecs::entity> find_bound_above(State& state) const
+    {
+        std::vector<flecs::entity> entities;
+        collect_entities(entities);
+        return render_bound_above(state, entities, bound_above);
+    }
+
+    // The created renderers are on top of the layer in the item order. Without
+    // a view above the list they keep their orders unless an item before them
+    // is placed, otherwise every unstable item is placed below the bound
+    void place_unstable_items(
+        State& state,
+        RenderManager& render_manager,
+        const std::vector<size_t>& sources,
+        const std::vector<bool>& stable
+    )
+    {
+        const auto item_count = item_renderers.size();
+
+        // The lowest entity of the next stable item with entities
+        std::vector<std::optional<flecs::entity>> next_stable(item_count);
+        std::vector<flecs::entity> entities;
+        auto next = bound_above;
+        for (size_t i = item_count; i-- > 0;)
+        {
+            next_stable[i] = next;
+            if (stable[i])
+            {
+                entities.clear();
+                collect_render_entities(item_renderers[i], entities);
+                if (!entities.empty())
+                {
+                    next = *std::ranges::min_element(entities, {}, render_order_of);
+                }
+            }
+        }
+
+        std::optional<flecs::entity> previous;
+        bool moved_to_top = false;
+        for (size_t i = 0; i < item_count; i++)
+        {
+            entities.clear();
+            collect_render_entities(item_renderers[i], entities);
+            std::ranges::sort(entities, {}, render_order_of);
+
+            const auto created = sources[i] == NO_SOURCE;
+            const auto keeps_order =
+                stable[i] || (created && !next_stable[i].has_value() && !moved_to_top);
+
+            if (!keeps_order)
+            {
+                for (auto entity : entities)
+                {
+                    if (!next_stable[i].has_value())
+                    {
+                        render_manager.move_to_top(state, entity, layer_of(entity));
+                        moved_to_top = true;
+                    }
+                    else if (previous.has_value())
+                    {
+                        render_manager.move_between(
+                            state, entity, *previous, *next_stable[i]
+                        );
+                    }
+                    else
+                    {
+                        render_manager.move_below(state, entity, *next_stable[i]);
+                    }
+                    previous = entity;
+                }
+            }
+
+            if (!entities.empty())
+            {
+                previous = entities.back();
+            }
+        }
+    }
+
+    static uint64_t render_order_of(flecs::entity entity)
+    {
+        return entity.get<components::RenderOrder>()->sort_key();
+    }
+
+    static uint32_t layer_of(flecs::entity entity)
+    {
+        return entity.get<components::RenderOrder>()->layer;
+    }
+
+    // Marks the items whose sources form the longest increasing subsequence
+    static std::vector<bool>
+    longest_increasing_sources(const std::vector<size_t>& sources)
+    {
+        std::vector<bool> stable(sources.size(), false);
+
+        // Item index of the smallest tail of the increasing runs of each length
+        std::vector<size_t> tails;
+        std::vector<size_t> predecessors(sources.size(), NO_SOURCE);
+
+        for (size_t i = 0; i < sources.size(); i++)
+        {
+            if (sources[i] == NO_SOURCE)
+            {
+                continue;
+            }
+
+            const auto tail_it = std::ranges::lower_bound(
+                tails, sources[i], {}, [&](size_t item) { return sources[item]; }
+            );
+            if (tail_it != tails.begin())
+            {
+                predecessors[i] = *(tail_it - 1);
+            }
+
+            if (tail_it == tails.end())
+            {
+                tails.push_back(i);
+            }
+            else
+            {
+                *tail_it = i;
+            }
+        }
+
+        for (auto i = tails.empty() ? NO_SOURCE : tails.back(); i != NO_SOURCE;
+             i = predecessors[i])
+        {
+            stable[i] = true;
+        }
+
+        return stable;
+    }
+};
+}
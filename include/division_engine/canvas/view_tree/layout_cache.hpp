@@ -0,0 +1,94 @@
+#pragma once
+
+#include "division_engine/canvas/box_constraints.hpp"
+#include "division_engine/canvas/size.hpp"
+
+#include <glm/vec2.hpp>
+
+#include <concepts>
+#include <cstddef>
+#include <functional>
+#include <optional>
+
+namespace division_engine::canvas::view_tree
+{
+// The views whose layout depends on their props opt in with a
+// `size_t layout_hash() const` member. The views without it lay out the same
+// for any props and children, e.g. the leaves, `SizedBox`, `Stack` and lists,
+// so they are relayout boundaries for the changes below them
+template<typename V>
+concept HasLayoutHash = requires(const V& view) {
+    {
+        view.layout_hash()
+    } -> std::convertible_to<size_t>;
+};
+
+// Hash of the view props its layout depends on
+template<typename V>
+size_t layout_hash(const V& view)
+{
+    if constexpr (HasLayoutHash<V>)
+    {
+        return view.layout_hash();
+    }
+    else
+    {
+        return 0;
+    }
+}
+
+inline size_t combine_layout_hash(size_t seed, size_t value)
+{
+    return seed ^ (value + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+}
+
+inline size_t combine_layout_hash(size_t seed, float value)
+{
+    return combine_layout_hash(seed, std::hash<float> {}(value));
+}
+
+inline bool is_tight(const BoxConstraints& constraints)
+{
+    return constraints.min_size == constraints.max_size;
+}
+
+// Last layout of a renderer. It is reused while the constraints and the layout
+// hash of the view stay the same
+class LayoutCache
+{
+public:
+    template<typename TLayout>
+    Size layout(
+        const BoxConstraints& constraints,
+        size_t props_hash,
+        TLayout&& layout_func
+    )
+    {
+        // The tight constraints leave a single size, whatever is below
+        if (is_tight(constraints))
+        {
+            return constraints.max_size;
+        }
+
+        if (_size.has_value() && _props_hash == props_hash &&
+            _constraints.min_size == constraints.min_size &&
+            _constraints.max_size == constraints.max_size)
+        {
+            return *_size;
+        }
+
+        _size = layout_func();
+        _constraints = constraints;
+        _props_hash = props_hash;
+
+        return *_size;
+    }
+
+    void invalidate() { _size.reset(); }
+
+private:
+    std::optional<Size> _size;
+    BoxConstraints _constraints {};
+    size_t _props_hash = 0;
+};
+}
@@ -1,16 +1,19 @@
 #pragma once
 
 #include "division_engine/canvas/box_constraints.hpp"
+#include "division_engine/canvas/flat_layout.hpp"
 #include "division_engine/canvas/rect.hpp"
 #include "division_engine/canvas/render_manager.hpp"
 #include "division_engine/canvas/size.hpp"
 #include "division_engine/canvas/state.hpp"
+#include "division_engine/canvas/view_tree/render_entities.hpp"
 #include "division_engine/canvas/view_tree/view.hpp"
 #include "division_engine/utility/algorithm.hpp"
 
 #include <glm/vec2.hpp>
 
 #include <array>
+#include <concepts>
 #include <cstddef>
 #include <iterator>
 #include <tuple>
@@ -18,6 +21,7 @@
 #include <typeinfo>
 #include <utility>
 #include <variant>
+#include <vector>
 
 namespace division_engine::canvas::view_tree
 {
@@ -37,17 +41,22 @@ struct __BaseListView
 
     std::tuple<TChildView...> children;
 
-    __BaseListView(TChildView... children)
+    constexpr __BaseListView(TChildView... children)
       : children(std::make_tuple(children...))
     {
     }
+
+    // The tuple comparison doesn't check the children by itself
+    bool operator==(const __BaseListView&) const
+        requires(std::equality_comparable<TChildView> && ...)
+    = default;
 };
 }
 
 template<typename... T>
 struct HorizontalList : __BaseListView<Direction::Horinzontal, T...>
 {
-    HorizontalList(T... children)
+    constexpr HorizontalList(T... children)
       : __BaseListView<Direction::Horinzontal, T...>(children...)
     {
     }
@@ -56,7 +65,7 @@ struct HorizontalList : __BaseListView<Direction::Horinzontal, T...>
 template<typename... T>
 struct VerticalList : __BaseListView<Direction::Vertical, T...>
 {
-    VerticalList(T... children)
+    constexpr VerticalList(T... children)
       : __BaseListView<Direction::Vertical, T...>(children...)
     {
     }
@@ -85,6 +94,37 @@ struct __BaseListView<elements_direction, TChildView...>::Renderer
     {
     }
 
+    void collect_entities(std::vector<flecs::entity>& entities) const
+    {
+        std::apply(
+            [&](const auto&... child)
+            { (collect_render_entities(child, entities), ...); },
+            children
+        );
+    }
+
+    void flatten(
+        State& state,
+        RenderManager& render_manager,
+        FlatLayout& layout,
+        uint32_t parent,
+        const view_type& view
+    )
+    {
+        constexpr auto kind = elements_direction == Direction::Horinzontal
+                                  ? FlatLayout::NodeKind::HorizontalList
+                                  : FlatLayout::NodeKind::VerticalList;
+
+        const auto node = layout.push(kind, parent);
+        utility::algorithm::tuples_zip_foreach(
+            [&](auto& child_renderer, const auto& child_view)
+            { child_renderer.flatten(state, render_manager, layout, node, child_view); },
+            children,
+            view.children
+        );
+        layout.end(node);
+    }
+
     Size layout(const BoxConstraints& constraints, const view_type& view)
     {
         return Size::unconstrainted();
@@ -93,12 +133,18 @@ struct __BaseListView<elements_direction, TChildView...>::Renderer
     void
     render(State& state, RenderManager& render_manager, Rect& rect, const view_type& view)
     {
+        constexpr size_t child_count = std::tuple_size_v<decltype(children)>;
+
         const auto rect_size = rect.size();
 
         glm::vec2 available_size = rect_size;
         glm::vec2 all_fixed_size = glm::vec2 { 0 };
         int fixed_size_count = 0;
 
+        // Children are measured once, and the sizes are reused for the placement
+        std::array<glm::vec2, child_count> child_sizes;
+        size_t child_index = 0;
+
         utility::algorithm::tuples_zip_foreach(
             [&](auto& child_renderer, auto& child_view)
             {
@@ -108,6 +154,7 @@ struct __BaseListView<elements_direction, TChildView...>::Renderer
                 };
 
                 const Size child_size = child_renderer.layout(constraints, child_view);
+                child_sizes[child_index++] = child_size;
 
                 if (!is_unconstrainted<main_direction()>(child_size))
                 {
@@ -128,7 +175,6 @@ struct __BaseListView<elements_direction, TChildView...>::Renderer
             view.children
         );
 
-        constexpr size_t child_count = std::tuple_size_v<decltype(children)>;
         const auto filled_size_count = child_count - fixed_size_count;
 
         const glm::vec2 filled_space = (rect_size - all_fixed_size);
@@ -140,18 +186,13 @@ struct __BaseListView<elements_direction, TChildView...>::Renderer
             get_vec_component_by_direction<main_direction()>(size_per_filled);
         size_per_filled_comp = filled_space_comp / filled_size_count;
 
-        available_size = rect_size;
-
         glm::vec2 offset { 0 };
+        child_index = 0;
 
         utility::algorithm::tuples_zip_foreach(
             [&](View auto& child_view, auto& child_renderer)
             {
-                BoxConstraints constraints {
-                    .min_size = glm::vec2 { 0 },
-                    .max_size = available_size,
-                };
-                const Size child_size = child_renderer.layout(constraints, child_view);
+                const Size child_size = child_sizes[child_index++];
 
                 auto top_left =
                     glm::vec2 { rect.left() + offset.x, rect.top() - offset.y };
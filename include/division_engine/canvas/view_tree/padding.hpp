@@ -2,15 +2,22 @@
 
 #include "division_engine/canvas/box_constraints.hpp"
 #include "division_engine/canvas/edge_insets.hpp"
+#include "division_engine/canvas/flat_layout.hpp"
 #include "division_engine/canvas/rect.hpp"
 #include "division_engine/canvas/render_manager.hpp"
 #include "division_engine/canvas/size.hpp"
 #include "division_engine/canvas/state.hpp"
+#include "division_engine/canvas/view_tree/layout_cache.hpp"
+#include "division_engine/canvas/view_tree/render_entities.hpp"
 #include "division_engine/canvas/view_tree/view.hpp"
 
 #include <glm/common.hpp>
 #include <glm/vec2.hpp>
 
+#include <cstddef>
+#include <functional>
+#include <vector>
+
 namespace division_engine::canvas::view_tree
 {
 template<View TChild>
@@ -21,14 +28,25 @@ struct Padding
     TChild child;
     EdgeInsets padding = EdgeInsets::all(0);
 
-    Padding(EdgeInsets padding, TChild child)
+    constexpr Padding(EdgeInsets padding, TChild child)
       : child(child)
       , padding(padding)
     {
     }
 
-    Padding(TChild child)
+    constexpr Padding(TChild child)
       : child(child) {};
+
+    size_t layout_hash() const
+    {
+        auto hash = view_tree::layout_hash(child);
+        hash = combine_layout_hash(hash, padding.top);
+        hash = combine_layout_hash(hash, padding.bottom);
+        hash = combine_layout_hash(hash, padding.left);
+        return combine_layout_hash(hash, padding.right);
+    }
+
+    bool operator==(const Padding&) const = default;
 };
 
 template<View TChild>
@@ -38,35 +56,57 @@ struct Padding<TChild>::Renderer
     using child_renderer_type = typename TChild::Renderer;
 
     child_renderer_type child_renderer;
+    LayoutCache layout_cache;
 
     Renderer(State& state, RenderManager& render_manager, const view_type& view)
       : child_renderer(child_renderer_type { state, render_manager, view.child })
     {
     }
 
-    Size layout(const BoxConstraints& constraints, const view_type& view)
+    void collect_entities(std::vector<flecs::entity>& entities) const
     {
-        glm::vec2 padded_size { view.padding.left + view.padding.right,
-                                view.padding.top + view.padding.bottom };
-
-        BoxConstraints child_constraints {
-            .min_size = glm::min(glm::vec2 { 0 }, constraints.min_size - padded_size),
-            .max_size = constraints.max_size - padded_size,
-        };
+        collect_render_entities(child_renderer, entities);
+    }
 
-        Size child_size = child_renderer.layout(child_constraints, view.child);
+    void flatten(
+        State& state,
+        RenderManager& render_manager,
+        FlatLayout& layout,
+        uint32_t parent,
+        const view_type& view
+    )
+    {
+        const auto node = layout.push(
+            FlatLayout::NodeKind::Padding,
+            parent,
+            glm::vec4 {
+                view.padding.top,
+                view.padding.bottom,
+                view.padding.left,
+                view.padding.right,
+            }
+        );
+        child_renderer.flatten(state, render_manager, layout, node, view.child);
+        layout.end(node);
+    }
 
-        Size result_size = Size::unconstrainted();
-        if (!child_size.width_unconstrainted())
+    // Only the own props are hashed. A child with the layout props caches its
+    // layout itself or passes the call to a cached one, so it is asked every
+    // time instead of hashing its whole subtree at every level
+    Size layout(const BoxConstraints& constraints, const view_type& view)
+    {
+        if constexpr (HasLayoutHash<TChild>)
         {
-            result_size.width = child_size.width + padded_size.x;
+            return layout_padded(constraints, view);
         }
-        if (!child_size.height_unconstrainted())
+        else
         {
-            result_size.height = child_size.height + padded_size.y;
+            return layout_cache.layout(
+                constraints,
+                padding_hash(view.padding),
+                [&] { return layout_padded(constraints, view); }
+            );
         }
-
-        return result_size;
     }
 
     void
@@ -85,5 +125,39 @@ struct Padding<TChild>::Renderer
 
         child_renderer.render(state, render_manager, rect, view.child);
     }
+
+private:
+    static size_t padding_hash(const EdgeInsets& padding)
+    {
+        auto hash = std::hash<float> {}(padding.top);
+        hash = combine_layout_hash(hash, padding.bottom);
+        hash = combine_layout_hash(hash, padding.left);
+        return combine_layout_hash(hash, padding.right);
+    }
+
+    Size layout_padded(const BoxConstraints& constraints, const view_type& view)
+    {
+        glm::vec2 padded_size { view.padding.left + view.padding.right,
+                                view.padding.top + view.padding.bottom };
+
+        BoxConstraints child_constraints {
+            .min_size = glm::min(glm::vec2 { 0 }, constraints.min_size - padded_size),
+            .max_size = constraints.max_size - padded_size,
+        };
+
+        Size child_size = child_renderer.layout(child_constraints, view.child);
+
+        Size result_size = Size::unconstrainted();
+        if (!child_size.width_unconstrainted())
+        {
+            result_size.width = child_size.width + padded_size.x;
+        }
+        if (!child_size.height_unconstrainted())
+        {
+            result_size.height = child_size.height + padded_size.y;
+        }
+
+        return result_size;
+    }
 };
 }
\ No newline at end of file
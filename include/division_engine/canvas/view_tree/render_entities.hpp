@@ -0,0 +1,96 @@
+#pragma once
+
+#include "division_engine/canvas/components/render_order.hpp"
+#include "division_engine/canvas/render_manager.hpp"
+#include "division_engine/canvas/state.hpp"
+
+#include <flecs.h>
+
+#include <algorithm>
+#include <optional>
+#include <vector>
+
+namespace division_engine::canvas::view_tree
+{
+// Appends the renderer entities of a view renderer and of its children.
+// Renderers opt in with a `collect_entities(std::vector<flecs::entity>&) const`
+// member, the ones without it have no entities
+template<typename TRenderer>
+void collect_render_entities(
+    const TRenderer& renderer,
+    std::vector<flecs::entity>& entities
+)
+{
+    if constexpr (requires { renderer.collect_entities(entities); })
+    {
+        renderer.collect_entities(entities);
+    }
+}
+
+// The entities of a view are contiguous in their layer, so the renderer right
+// above the topmost one belongs to the view that follows. Without entities the
+// previous bound is kept while it is drawn
+inline std::optional<flecs::entity> render_bound_above(
+    State& state,
+    const std::vector<flecs::entity>& entities,
+    const std::optional<flecs::entity>& previous_bound
+)
+{
+    using components::RenderOrder;
+
+    if (entities.empty())
+    {
+        if (!previous_bound.has_value() || !previous_bound->is_alive())
+        {
+            return std::nullopt;
+        }
+
+        const auto* order = previous_bound->get<RenderOrder>();
+        return order != nullptr && !order->is_idle() ? previous_bound : std::nullopt;
+    }
+
+    const auto top = *std::ranges::max_element(
+        entities, {}, [](flecs::entity e) { return e.get<RenderOrder>()->sort_key(); }
+    );
+    const auto order = *top.get<RenderOrder>();
+    const auto& layer = state.layer_orders.layer(order.layer);
+    const auto above = state.layer_orders.above(order.layer, order.order);
+    if (above == layer.end())
+    {
+        return std::nullopt;
+    }
+
+    return flecs::entity { state.world, above->second };
+}
+
+// Moves the entities drawn above the bound right below it, in their order.
+// The entities already below the bound keep their orders
+inline void place_below_bound(
+    State& state,
+    RenderManager& render_manager,
+    const std::vector<flecs::entity>& entities,
+    flecs::entity bound
+)
+{
+    using components::RenderOrder;
+
+    const auto bound_key = bound.get<RenderOrder>()->sort_key();
+    std::optional<flecs::entity> previous;
+    for (auto entity : entities)
+    {
+        if (entity.get<RenderOrder>()->sort_key() > bound_key)
+        {
+            if (previous.has_value() &&
+                previous->get<RenderOrder>()->sort_key() < bound_key)
+            {
+                render_manager.move_between(state, entity, *previous, bound);
+            }
+            else
+            {
+                render_manager.move_below(state, entity, bound);
+            }
+        }
+        previous = entity;
+    }
+}
+}
@@ -0,0 +1,205 @@
+#pragma once
+
+#include "division_engine/canvas/box_constraints.hpp"
+#include "division_engine/canvas/rect.hpp"
+#include "division_engine/canvas/render_manager.hpp"
+#include "division_engine/canvas/scroll_translations.hpp"
+#include "division_engine/canvas/size.hpp"
+#include "division_engine/canvas/state.hpp"
+#include "division_engine/canvas/view_tree/list.hpp"
+#include "division_engine/canvas/view_tree/render_entities.hpp"
+#include "division_engine/canvas/view_tree/view.hpp"
+
+#include <glm/vec2.hpp>
+
+#include <algorithm>
+#include <concepts>
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace division_engine::canvas::view_tree
+{
+// Draws the child scrolled by the offset inside of the rect given to the view.
+// The child is laid out at the unscrolled position, and the offset is added in
+// the vertex shaders from a translation uniform, so scrolling writes a single
+// uniform entry and none of the child renderers. A child equal to the last
+// rendered one is not rendered again
+template<View TChild>
+struct Scroll
+{
+    struct Renderer;
+
+    TChild child;
+    // Extent of the child along the direction. The child fills the viewport
+    // when it is smaller
+    float content_extent = 0;
+    // Distance from the content start to the viewport start. It is clamped to
+    // the scrollable range
+    float offset = 0;
+    Direction direction = Direction::Vertical;
+
+    constexpr Scroll(
+        float content_extent,
+        float offset,
+        TChild child,
+        Direction direction = Direction::Vertical
+    )
+      : child(child)
+      , content_extent(content_extent)
+      , offset(offset)
+      , direction(direction)
+    {
+    }
+
+    bool operator==(const Scroll&) const = default;
+};
+
+template<View TChild>
+struct Scroll<TChild>::Renderer
+{
+    using view_type = Scroll<TChild>;
+    using child_renderer_type = typename TChild::Renderer;
+
+    // The views without the comparison are rendered every frame
+    using rendered_child_type = std::conditional_t<
+        std::equality_comparable<TChild>,
+        std::optional<TChild>,
+        std::monostate>;
+
+    child_renderer_type child_renderer;
+    ScrollTranslations* translations;
+    uint32_t translation;
+    // The child and the content rect of the last render
+    rendered_child_type rendered_child;
+    Rect rendered_rect;
+
+    Renderer(State& state, RenderManager& render_manager, const view_type& view)
+      : child_renderer(state, render_manager, view.child)
+      , translations(&state.scroll_translations)
+      , translation(state.scroll_translations.acquire())
+    {
+    }
+
+    Renderer& operator=(Renderer&& other) noexcept
+    {
+        release();
+
+        child_renderer = std::move(other.child_renderer);
+        translations = other.translations;
+        translation =
+            std::exchange(other.translation, ScrollTranslations::NO_TRANSLATION);
+        rendered_child = std::move(other.rendered_child);
+        rendered_rect = other.rendered_rect;
+        return *this;
+    }
+
+    Renderer(Renderer&& other) noexcept
+      : child_renderer(std::move(other.child_renderer))
+      , translations(other.translations)
+      , translation(
+            std::exchange(other.translation, ScrollTranslations::NO_TRANSLATION)
+        )
+      , rendered_child(std::move(other.rendered_child))
+      , rendered_rect(other.rendered_rect)
+    {
+    }
+
+    Renderer(const Renderer& other) = delete;
+    Renderer& operator=(const Renderer& other) = delete;
+
+    ~Renderer() { release(); }
+
+    void collect_entities(std::vector<flecs::entity>& entities) const
+    {
+        collect_render_entities(child_renderer, entities);
+    }
+
+    Size layout(const BoxConstraints& constraints, const view_type& view)
+    {
+        return Size::unconstrainted();
+    }
+
+    void
+    render(State& state, RenderManager& render_manager, Rect& rect, const view_type& view)
+    {
+        const auto vertical = view.direction == Direction::Vertical;
+        const auto viewport_size = rect.size();
+        const auto viewport_extent = vertical ? viewport_size.y : viewport_size.x;
+        const auto content_extent = std::max(view.content_extent, viewport_extent);
+        const auto offset =
+            std::clamp(view.offset, 0.f, content_extent - viewport_extent);
+
+        // The content moves up or to the left. The outer scrolls are included,
+        // since the index replaces their offsets for the child renderers
+        const auto scroll_offset =
+            vertical ? glm::vec2 { 0, offset } : glm::vec2 { -offset, 0 };
+        const auto translation_offset =
+            state.clip_stack.translation_offset() + scroll_offset;
+
+        state.clip_stack.push(rect);
+        const auto viewport = *state.clip_stack.screen_clip();
+
+        // The child renderers keep their bounds, so the viewport is damaged here
+        const auto previous_viewport = translations->viewport(translation);
+        if (translations->offset(translation) != translation_offset ||
+            previous_viewport != viewport)
+        {
+            translations->set_offset(translation, translation_offset);
+            translations->set_viewport(translation, viewport);
+            state.damage.add(previous_viewport);
+            state.damage.add(viewport);
+        }
+
+        auto content_rect =
+            vertical ? Rect::from_top_left(
+                           glm::vec2 { rect.left(), rect.top() },
+                           glm::vec2 { viewport_size.x, content_extent }
+                       )
+                     : Rect::from_top_left(
+                           glm::vec2 { rect.left(), rect.top() },
+                           glm::vec2 { content_extent, viewport_size.y }
+                       );
+
+        // The clips of the child are in the content space, so an equal child
+        // in the same content rect has nothing to write
+        if (!is_rendered(view.child, content_rect))
+        {
+            state.clip_stack.push_translation(translation, translation_offset, viewport);
+            child_renderer.render(state, render_manager, content_rect, view.child);
+            state.clip_stack.pop_translation();
+        }
+
+        state.clip_stack.pop();
+    }
+
+private:
+    bool is_rendered(const TChild& child, const Rect& content_rect)
+    {
+        if constexpr (std::equality_comparable<TChild>)
+        {
+            if (rendered_child.has_value() && rendered_rect == content_rect &&
+                *rendered_child == child)
+            {
+                return true;
+            }
+
+            rendered_child = child;
+            rendered_rect = content_rect;
+        }
+
+        return false;
+    }
+
+    void release()
+    {
+        if (translation != ScrollTranslations::NO_TRANSLATION)
+        {
+            translations->release(translation);
+        }
+    }
+};
+}
@@ -1,15 +1,21 @@
 #pragma once
 
 #include "division_engine/canvas/box_constraints.hpp"
+#include "division_engine/canvas/flat_layout.hpp"
 #include "division_engine/canvas/rect.hpp"
 #include "division_engine/canvas/render_manager.hpp"
 #include "division_engine/canvas/size.hpp"
 #include "division_engine/canvas/state.hpp"
+#include "division_engine/canvas/view_tree/layout_cache.hpp"
+#include "division_engine/canvas/view_tree/render_entities.hpp"
 #include "division_engine/canvas/view_tree/view.hpp"
 #include "glm/ext/vector_float2.hpp"
 
 #include <glm/common.hpp>
 
+#include <functional>
+#include <vector>
+
 namespace division_engine::canvas::view_tree
 {
 template<View TChild>
@@ -20,12 +26,20 @@ struct SizedBox
     TChild child;
     Size size = Size::unconstrainted();
 
-    SizedBox(TChild child)
+    constexpr SizedBox(TChild child)
       : child(child)
     {
     }
 
-    SizedBox(Size size, TChild child) : child(child), size(size) {}
+    constexpr SizedBox(Size size, TChild child) : child(child), size(size) {}
+
+    // The child is not laid out, so it doesn't affect the hash
+    size_t layout_hash() const
+    {
+        return combine_layout_hash(std::hash<float> {}(size.width), size.height);
+    }
+
+    bool operator==(const SizedBox&) const = default;
 };
 
 template<View TChild>
@@ -41,6 +55,28 @@ struct SizedBox<TChild>::Renderer
     {
     }
 
+    void collect_entities(std::vector<flecs::entity>& entities) const
+    {
+        collect_render_entities(child_renderer, entities);
+    }
+
+    void flatten(
+        State& state,
+        RenderManager& render_manager,
+        FlatLayout& layout,
+        uint32_t parent,
+        const view_type& view
+    )
+    {
+        const auto node = layout.push(
+            FlatLayout::NodeKind::SizedBox,
+            parent,
+            glm::vec4 { view.size.width, view.size.height, 0, 0 }
+        );
+        child_renderer.flatten(state, render_manager, layout, node, view.child);
+        layout.end(node);
+    }
+
     Size layout(const BoxConstraints& constraints, const view_type& view)
     {
         return glm::clamp(
@@ -1,14 +1,18 @@
 #pragma once
 
 #include "division_engine/canvas/box_constraints.hpp"
+#include "division_engine/canvas/flat_layout.hpp"
 #include "division_engine/canvas/rect.hpp"
 #include "division_engine/canvas/render_manager.hpp"
 #include "division_engine/canvas/size.hpp"
+#include "division_engine/canvas/view_tree/render_entities.hpp"
 #include "division_engine/canvas/view_tree/view.hpp"
 #include "division_engine/utility/algorithm.hpp"
 
+#include <concepts>
 #include <tuple>
 #include <type_traits>
+#include <vector>
 
 namespace division_engine::canvas::view_tree
 {
@@ -20,7 +24,12 @@ struct Stack
 
     std::tuple<TChildView...> children;
 
-    Stack(TChildView... children) : children(children...) {}
+    constexpr Stack(TChildView... children) : children(children...) {}
+
+    // The tuple comparison doesn't check the children by itself
+    bool operator==(const Stack&) const
+        requires(std::equality_comparable<TChildView> && ...)
+    = default;
 };
 
 template<View... TChildView>
@@ -47,6 +56,33 @@ struct Stack<TChildView...>::Renderer
     {
     }
 
+    void collect_entities(std::vector<flecs::entity>& entities) const
+    {
+        std::apply(
+            [&](const auto&... child)
+            { (collect_render_entities(child, entities), ...); },
+            children
+        );
+    }
+
+    void flatten(
+        State& state,
+        RenderManager& render_manager,
+        FlatLayout& layout,
+        uint32_t parent,
+        const view_type& view
+    )
+    {
+        const auto node = layout.push(FlatLayout::NodeKind::Stack, parent);
+        utility::algorithm::tuples_zip_foreach(
+            [&](auto& child_renderer, const auto& child_view)
+            { child_renderer.flatten(state, render_manager, layout, node, child_view); },
+            children,
+            view.children
+        );
+        layout.end(node);
+    }
+
     Size layout(const BoxConstraints& constraints, const view_type& view)
     {
         return Size::unconstrainted();
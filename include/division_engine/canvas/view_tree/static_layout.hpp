@@ -0,0 +1,393 @@
+#pragma once
+
+#include "division_engine/canvas/rect.hpp"
+#include "division_engine/canvas/size.hpp"
+#include "division_engine/canvas/view_tree/clip.hpp"
+#include "division_engine/canvas/view_tree/decorated_box.hpp"
+#include "division_engine/canvas/view_tree/list.hpp"
+#include "division_engine/canvas/view_tree/padding.hpp"
+#include "division_engine/canvas/view_tree/sized_box.hpp"
+#include "division_engine/canvas/view_tree/stack.hpp"
+#include "division_engine/core/exception.hpp"
+
+#include <glm/vec2.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <tuple>
+
+namespace division_engine::canvas::view_tree
+{
+// Rect relative to the top left corner of the root, with the y axis going up
+// like the screen rects
+struct StaticRect
+{
+    float left = 0;
+    float top = 0;
+    float width = 0;
+    float height = 0;
+
+    constexpr float right() const { return left + width; }
+    constexpr float bottom() const { return top - height; }
+
+    constexpr StaticRect intersected(const StaticRect& other) const
+    {
+        const auto min_left = std::max(left, other.left);
+        const auto max_top = std::min(top, other.top);
+        return StaticRect {
+            .left = min_left,
+            .top = max_top,
+            .width = std::max(std::min(right(), other.right()) - min_left, 0.f),
+            .height = std::max(max_top - std::max(bottom(), other.bottom()), 0.f),
+        };
+    }
+
+    Rect to_rect(glm::vec2 top_left) const
+    {
+        return Rect::from_top_left(
+            glm::vec2 { top_left.x + left, top_left.y + top }, glm::vec2 { width, height }
+        );
+    }
+
+    bool operator==(const StaticRect&) const = default;
+};
+
+struct StaticLeaf
+{
+    StaticRect rect;
+    // Intersection of the clips above the leaf
+    StaticRect clip;
+    bool clipped = false;
+};
+
+// Number of the leaves, one per renderer entity. The leaves are decorated
+// boxes: a text owns its string, so it can't be a part of a constant view
+template<typename V>
+constexpr size_t static_leaf_count = 1;
+
+template<typename C>
+constexpr size_t static_leaf_count<SizedBox<C>> = static_leaf_count<C>;
+
+template<typename C>
+constexpr size_t static_leaf_count<Padding<C>> = static_leaf_count<C>;
+
+template<typename C>
+constexpr size_t static_leaf_count<Clip<C>> = static_leaf_count<C>;
+
+template<typename... C>
+constexpr size_t static_leaf_count<Stack<C...>> = (0 + ... + static_leaf_count<C>);
+
+template<typename... C>
+constexpr size_t static_leaf_count<HorizontalList<C...>> =
+    (0 + ... + static_leaf_count<C>);
+
+template<typename... C>
+constexpr size_t static_leaf_count<VerticalList<C...>> =
+    (0 + ... + static_leaf_count<C>);
+
+namespace detail
+{
+struct StaticSize
+{
+    float width;
+    float height;
+
+    constexpr bool width_unconstrainted() const
+    {
+        return width == Size::UNCONSTRAINTED;
+    }
+
+    constexpr bool height_unconstrainted() const
+    {
+        return height == Size::UNCONSTRAINTED;
+    }
+};
+
+constexpr StaticSize STATIC_UNCONSTRAINTED { Size::UNCONSTRAINTED, Size::UNCONSTRAINTED };
+
+struct StaticClip
+{
+    StaticRect rect;
+    bool clipped = false;
+};
+
+// Mirrors the `layout` of the renderers for the given max size
+constexpr StaticSize static_size(const DecoratedBox&, StaticSize);
+template<typename C>
+constexpr StaticSize static_size(const SizedBox<C>& view, StaticSize max_size);
+template<typename C>
+constexpr StaticSize static_size(const Padding<C>& view, StaticSize max_size);
+template<typename C>
+constexpr StaticSize static_size(const Clip<C>& view, StaticSize max_size);
+template<typename... C>
+constexpr StaticSize static_size(const Stack<C...>&, StaticSize);
+template<typename... C>
+constexpr StaticSize static_size(const HorizontalList<C...>&, StaticSize);
+template<typename... C>
+constexpr StaticSize static_size(const VerticalList<C...>&, StaticSize);
+
+// Mirrors the `render` of the renderers, the leaves are written in the order
+// of their entities
+constexpr void static_place(const DecoratedBox&, StaticRect, StaticClip, StaticLeaf*&);
+template<typename C>
+constexpr void static_place(const SizedBox<C>&, StaticRect, StaticClip, StaticLeaf*&);
+template<typename C>
+constexpr void static_place(const Padding<C>&, StaticRect, StaticClip, StaticLeaf*&);
+template<typename C>
+constexpr void static_place(const Clip<C>&, StaticRect, StaticClip, StaticLeaf*&);
+template<typename... C>
+constexpr void static_place(const Stack<C...>&, StaticRect, StaticClip, StaticLeaf*&);
+template<typename... C>
+constexpr void
+static_place(const HorizontalList<C...>&, StaticRect, StaticClip, StaticLeaf*&);
+template<typename... C>
+constexpr void
+static_place(const VerticalList<C...>&, StaticRect, StaticClip, StaticLeaf*&);
+
+constexpr StaticSize static_size(const DecoratedBox&, StaticSize)
+{
+    return STATIC_UNCONSTRAINTED;
+}
+
+template<typename C>
+constexpr StaticSize static_size(const SizedBox<C>& view, StaticSize max_size)
+{
+    return StaticSize {
+        std::min(std::max(view.size.width, 0.f), max_size.width),
+        std::min(std::max(view.size.height, 0.f), max_size.height),
+    };
+}
+
+template<typename C>
+constexpr StaticSize static_size(const Padding<C>& view, StaticSize max_size)
+{
+    const auto& padding = view.padding;
+    const auto padded_width = padding.left + padding.right;
+    const auto padded_height = padding.top + padding.bottom;
+
+    const auto child_size = static_size(
+        view.child,
+        StaticSize { max_size.width - padded_width, max_size.height - padded_height }
+    );
+
+    auto size = STATIC_UNCONSTRAINTED;
+    if (!child_size.width_unconstrainted())
+    {
+        size.width = child_size.width + padded_width;
+    }
+    if (!child_size.height_unconstrainted())
+    {
+        size.height = child_size.height + padded_height;
+    }
+    return size;
+}
+
+template<typename C>
+constexpr StaticSize static_size(const Clip<C>& view, StaticSize max_size)
+{
+    return static_size(view.child, max_size);
+}
+
+template<typename... C>
+constexpr StaticSize static_size(const Stack<C...>&, StaticSize)
+{
+    return STATIC_UNCONSTRAINTED;
+}
+
+template<typename... C>
+constexpr StaticSize static_size(const HorizontalList<C...>&, StaticSize)
+{
+    return STATIC_UNCONSTRAINTED;
+}
+
+template<typename... C>
+constexpr StaticSize static_size(const VerticalList<C...>&, StaticSize)
+{
+    return STATIC_UNCONSTRAINTED;
+}
+
+constexpr void
+static_place(const DecoratedBox&, StaticRect rect, StaticClip clip, StaticLeaf*& leaves)
+{
+    *leaves++ = StaticLeaf { rect, clip.rect, clip.clipped };
+}
+
+template<typename C>
+constexpr void static_place(
+    const SizedBox<C>& view,
+    StaticRect rect,
+    StaticClip clip,
+    StaticLeaf*& leaves
+)
+{
+    static_place(view.child, rect, clip, leaves);
+}
+
+template<typename C>
+constexpr void static_place(
+    const Padding<C>& view,
+    StaticRect rect,
+    StaticClip clip,
+    StaticLeaf*& leaves
+)
+{
+    const auto& padding = view.padding;
+    const StaticRect child_rect {
+        .left = rect.left + padding.left,
+        .top = rect.top - padding.top,
+        .width = rect.width - (padding.left + padding.right),
+        .height = rect.height - (padding.top + padding.bottom),
+    };
+    static_place(view.child, child_rect, clip, leaves);
+}
+
+template<typename C>
+constexpr void static_place(
+    const Clip<C>& view,
+    StaticRect rect,
+    StaticClip clip,
+    StaticLeaf*& leaves
+)
+{
+    const StaticClip child_clip {
+        .rect = clip.clipped ? clip.rect.intersected(rect) : rect,
+        .clipped = true,
+    };
+    static_place(view.child, rect, child_clip, leaves);
+}
+
+template<typename... C>
+constexpr void static_place(
+    const Stack<C...>& view,
+    StaticRect rect,
+    StaticClip clip,
+    StaticLeaf*& leaves
+)
+{
+    std::apply(
+        [&](const auto&... child) { (static_place(child, rect, clip, leaves), ...); },
+        view.children
+    );
+}
+
+template<bool vertical, typename... C>
+constexpr void static_place_list(
+    const std::tuple<C...>& children,
+    StaticRect rect,
+    StaticClip clip,
+    StaticLeaf*& leaves
+)
+{
+    const auto main = [](const StaticSize& size) -> float
+    { return vertical ? size.height : size.width; };
+
+    // Fixed size children are measured first, the others share the rest
+    std::array<StaticSize, sizeof...(C)> child_sizes {};
+    auto available_size = StaticSize { rect.width, rect.height };
+    float fixed_extent = 0;
+    size_t filled_count = 0;
+    size_t child_index = 0;
+
+    const auto measure = [&](const auto& child)
+    {
+        const auto child_size = static_size(child, available_size);
+        child_sizes[child_index++] = child_size;
+
+        if (main(child_size) == Size::UNCONSTRAINTED)
+        {
+            filled_count++;
+            return;
+        }
+
+        (vertical ? available_size.height : available_size.width) -= main(child_size);
+        fixed_extent += main(child_size);
+    };
+    std::apply([&](const auto&... child) { (measure(child), ...); }, children);
+
+    auto filled_size = StaticSize { rect.width, rect.height };
+    if (filled_count > 0)
+    {
+        (vertical ? filled_size.height : filled_size.width) =
+            (main(filled_size) - fixed_extent) / static_cast<float>(filled_count);
+    }
+
+    float offset = 0;
+    child_index = 0;
+
+    const auto place = [&](const auto& child)
+    {
+        auto child_size = child_sizes[child_index++];
+        if (main(child_size) == Size::UNCONSTRAINTED)
+        {
+            child_size = filled_size;
+        }
+
+        const StaticRect child_rect {
+            .left = vertical ? rect.left : rect.left + offset,
+            .top = vertical ? rect.top - offset : rect.top,
+            .width = child_size.width,
+            .height = child_size.height,
+        };
+        static_place(child, child_rect, clip, leaves);
+        offset += main(child_size);
+    };
+    std::apply([&](const auto&... child) { (place(child), ...); }, children);
+}
+
+template<typename... C>
+constexpr void static_place(
+    const HorizontalList<C...>& view,
+    StaticRect rect,
+    StaticClip clip,
+    StaticLeaf*& leaves
+)
+{
+    static_place_list<false>(view.children, rect, clip, leaves);
+}
+
+template<typename... C>
+constexpr void static_place(
+    const VerticalList<C...>& view,
+    StaticRect rect,
+    StaticClip clip,
+    StaticLeaf*& leaves
+)
+{
+    static_place_list<true>(view.children, rect, clip, leaves);
+}
+}
+
+// Size of a constant view. Its root must have a fixed size, e.g. a `SizedBox`
+template<typename V>
+constexpr Size static_layout_size(const V& view)
+{
+    const auto size = detail::static_size(view, detail::STATIC_UNCONSTRAINTED);
+    if (size.width_unconstrainted() || size.height_unconstrainted())
+    {
+        throw core::Exception { "The root of a static layout must have a fixed size" };
+    }
+
+    return Size { size.width, size.height };
+}
+
+// Lays out a constant view at compile time. The leaf rects are relative to the
+// top left corner of the root and go in the order of the renderer entities
+template<typename V>
+constexpr std::array<StaticLeaf, static_leaf_count<V>> static_layout(const V& view)
+{
+    const auto size = static_layout_size(view);
+
+    std::array<StaticLeaf, static_leaf_count<V>> leaves {};
+    auto* leaves_end = leaves.data();
+    detail::static_place(
+        view,
+        StaticRect { .width = size.width, .height = size.height },
+        detail::StaticClip {},
+        leaves_end
+    );
+
+    return leaves;
+}
+}
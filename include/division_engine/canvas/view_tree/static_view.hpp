@@ -0,0 +1,117 @@
+#pragma once
+
+#include "division_engine/canvas/box_constraints.hpp"
+#include "division_engine/canvas/clip_stack.hpp"
+#include "division_engine/canvas/components/render_bounds.hpp"
+#include "division_engine/canvas/rect.hpp"
+#include "division_engine/canvas/render_manager.hpp"
+#include "division_engine/canvas/size.hpp"
+#include "division_engine/canvas/state.hpp"
+#include "division_engine/canvas/view_tree/render_entities.hpp"
+#include "division_engine/canvas/view_tree/static_layout.hpp"
+#include "division_engine/core/exception.hpp"
+
+#include <flecs.h>
+#include <glm/common.hpp>
+#include <glm/vec2.hpp>
+
+#include <cstdint>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace division_engine::canvas::view_tree
+{
+// Constant view tree laid out at compile time, e.g. a static panel:
+//
+//     static constexpr auto PANEL = SizedBox { Size { 200, 100 }, ... };
+//     StaticView<PANEL> {}
+//
+// Rendering it only moves the precomputed rects to the top left corner of its
+// rect, and nothing is written while that corner and the clip stay the same
+template<const auto& VIEW>
+struct StaticView
+{
+    struct Renderer;
+
+    using child_view_type = std::remove_cvref_t<decltype(VIEW)>;
+
+    static constexpr auto SIZE = static_layout_size(VIEW);
+    static constexpr auto LEAVES = static_layout(VIEW);
+};
+
+template<const auto& VIEW>
+struct StaticView<VIEW>::Renderer
+{
+    using view_type = StaticView<VIEW>;
+    using child_renderer_type = typename child_view_type::Renderer;
+
+    child_renderer_type child_renderer;
+    // Entities of the leaves, in the order of `LEAVES`
+    std::vector<flecs::entity> entities;
+
+    Renderer(State& state, RenderManager& render_manager, const view_type& view)
+      : child_renderer(state, render_manager, VIEW)
+    {
+        collect_render_entities(child_renderer, entities);
+        if (entities.size() != view_type::LEAVES.size())
+        {
+            throw core::Exception { "Static view leaves must have an entity each" };
+        }
+    }
+
+    void collect_entities(std::vector<flecs::entity>& entities) const
+    {
+        collect_render_entities(child_renderer, entities);
+    }
+
+    Size layout(const BoxConstraints& constraints, const view_type& view)
+    {
+        return glm::clamp(
+            glm::vec2 { view_type::SIZE }, constraints.min_size, constraints.max_size
+        );
+    }
+
+    void
+    render(State& state, RenderManager& render_manager, Rect& rect, const view_type& view)
+    {
+        using components::RenderBounds;
+
+        const glm::vec2 top_left { rect.left(), rect.top() };
+        const auto outer_clip = state.clip_stack.current();
+        const auto translation = state.clip_stack.translation();
+        // The clips are in the content space, so scrolling doesn't change them
+        if (_top_left == top_left && _outer_clip == outer_clip &&
+            _translation == translation)
+        {
+            return;
+        }
+
+        _top_left = top_left;
+        _outer_clip = outer_clip;
+        _translation = translation;
+
+        state.world.defer_begin();
+        for (size_t i = 0; i < entities.size(); i++)
+        {
+            const auto& leaf = view_type::LEAVES[i];
+            entities[i].set(RenderBounds { leaf.rect.to_rect(top_left) });
+
+            auto clip = outer_clip;
+            if (leaf.clipped)
+            {
+                const auto leaf_clip = leaf.clip.to_rect(top_left);
+                clip = clip.has_value() ? clip->intersected(leaf_clip) : leaf_clip;
+            }
+            ClipStack::set_clip(entities[i], clip);
+            ClipStack::set_translation(entities[i], translation);
+        }
+        state.world.defer_end();
+    }
+
+private:
+    std::optional<glm::vec2> _top_left;
+    std::optional<Rect> _outer_clip;
+    uint32_t _translation = ScrollTranslations::NO_TRANSLATION;
+};
+}
@@ -3,11 +3,14 @@
 #include "division_engine/canvas/box_constraints.hpp"
 #include "division_engine/canvas/components/render_bounds.hpp"
 #include "division_engine/canvas/components/renderable_text.hpp"
+#include "division_engine/canvas/flat_layout.hpp"
 #include "division_engine/canvas/rect.hpp"
 #include "division_engine/canvas/render_manager.hpp"
 #include "division_engine/canvas/renderer.hpp"
+#include "division_engine/canvas/renderer_pool.hpp"
 #include "division_engine/canvas/size.hpp"
 #include "division_engine/canvas/state.hpp"
+#include "division_engine/canvas/view_tree/render_entities.hpp"
 #include "division_engine/color.hpp"
 
 #include <flecs.h>
@@ -15,6 +18,7 @@
 
 #include <string>
 #include <utility>
+#include <vector>
 
 namespace division_engine::canvas::view_tree
 {
@@ -25,6 +29,8 @@ struct Text
     std::string text {};
     glm::vec4 color = color::WHITE;
     float font_size = components::RenderableText::DEFAULT_FONT_SIZE;
+
+    bool operator==(const Text&) const = default;
 };
 
 struct Text::Renderer
@@ -32,11 +38,22 @@ struct Text::Renderer
     using view_type = Text;
 
     flecs::entity entity;
+    // The entity goes back to the pool with the renderer
+    RendererPool* pool = nullptr;
+    flecs::entity_t batch = 0;
+    // The view and the rect written last. The components are written only when
+    // they change, so the values tweened by the animator stay until then
+    view_type rendered_view;
+    Rect rendered_rect;
 
     Renderer(State& state, RenderManager& render_manager, const view_type& view)
+      : pool(&state.renderer_pool)
+      , rendered_view(view)
     {
         using namespace components;
-        entity = render_manager.create_renderer(
+
+        batch = render_manager.batch_for<RenderableText, RenderBounds>(state);
+        entity = render_manager.acquire_renderer(
             state,
             std::tuple {
                 RenderableText {
@@ -52,6 +69,10 @@ struct Text::Renderer
     Renderer& operator=(Renderer&& other) noexcept
     {
         entity = std::exchange(other.entity, flecs::entity::null());
+        pool = other.pool;
+        batch = other.batch;
+        rendered_view = std::move(other.rendered_view);
+        rendered_rect = other.rendered_rect;
         return *this;
     }
 
@@ -68,7 +89,12 @@ struct Text::Renderer
         if (!entity.is_alive())
             return;
 
-        entity.destruct();
+        pool->release(entity, batch);
+    }
+
+    void collect_entities(std::vector<flecs::entity>& entities) const
+    {
+        entities.push_back(entity);
     }
 
     Size layout(const BoxConstraints& constraints, const view_type& view)
@@ -81,13 +107,47 @@ struct Text::Renderer
     {
         using namespace components;
 
-        auto& text = *entity.get_mut<RenderableText>();
-        text.text = view.text;
-        text.color = view.color;
-        text.font_size = view.font_size;
+        update_props(view);
+
+        if (rendered_rect != rect)
+        {
+            rendered_rect = rect;
+            entity.set(RenderBounds { rect });
+        }
+
+        state.clip_stack.apply(entity);
+    }
+
+    void flatten(
+        State& state,
+        RenderManager& render_manager,
+        FlatLayout& layout,
+        uint32_t parent,
+        const view_type& view
+    )
+    {
+        update_props(view);
+        const auto node =
+            layout.push(FlatLayout::NodeKind::Leaf, parent, glm::vec4 { 0 }, entity);
+        layout.end(node);
+    }
+
+private:
+    void update_props(const view_type& view)
+    {
+        using namespace components;
 
-        auto& bounds = *entity.get_mut<RenderBounds>();
-        bounds.value = rect;
+        // A static tree built each frame neither copies the strings nor
+        // triggers the change detection of the drawers
+        if (rendered_view != view)
+        {
+            rendered_view = view;
+            auto& mut_text = *entity.get_mut<RenderableText>();
+            mut_text.text = view.text;
+            mut_text.color = view.color;
+            mut_text.font_size = view.font_size;
+            entity.modified<RenderableText>();
+        }
     }
 };
 }
\ No newline at end of file
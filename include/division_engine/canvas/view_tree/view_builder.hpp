@@ -1,14 +1,17 @@
 #pragma once
 
 #include "division_engine/canvas/box_constraints.hpp"
+#include "division_engine/canvas/flat_layout.hpp"
 #include "division_engine/canvas/rect.hpp"
 #include "division_engine/canvas/render_manager.hpp"
 #include "division_engine/canvas/size.hpp"
 #include "division_engine/canvas/state.hpp"
+#include "division_engine/canvas/view_tree/render_entities.hpp"
 #include "division_engine/canvas/view_tree/view.hpp"
 
 #include <functional>
 #include <type_traits>
+#include <vector>
 
 namespace division_engine::canvas::view_tree
 {
@@ -47,6 +50,23 @@ struct ViewBuilder<T>::Renderer
     {
     }
 
+    void collect_entities(std::vector<flecs::entity>& entities) const
+    {
+        collect_render_entities(child_renderer, entities);
+    }
+
+    void flatten(
+        State& state,
+        RenderManager& render_manager,
+        FlatLayout& layout,
+        uint32_t parent,
+        const view_type& view
+    )
+    {
+        // The built view takes the place of the builder
+        child_renderer.flatten(state, render_manager, layout, parent, child);
+    }
+
     Size layout(const BoxConstraints& constraints, const view_type& view)
     {
         return child_renderer.layout(constraints, child);
@@ -0,0 +1,269 @@
+#pragma once
+
+#include "division_engine/canvas/box_constraints.hpp"
+#include "division_engine/canvas/flat_layout.hpp"
+#include "division_engine/canvas/rect.hpp"
+#include "division_engine/canvas/render_manager.hpp"
+#include "division_engine/canvas/size.hpp"
+#include "division_engine/canvas/state.hpp"
+#include "division_engine/canvas/view_tree/list.hpp"
+#include "division_engine/canvas/view_tree/render_entities.hpp"
+#include "division_engine/canvas/view_tree/view.hpp"
+
+#include <glm/vec2.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <numeric>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace division_engine::canvas::view_tree
+{
+// List of `item_count` items built on demand. Only the items intersecting the
+// viewport and the overscan around it have renderers, so a frame costs as much
+// as the visible items, whatever the item count is. The created rows are placed
+// below the renderers of the views that follow the list
+template<View TItemView>
+struct VirtualList
+{
+    struct Renderer;
+
+    using item_builder_t = std::function<TItemView(size_t index)>;
+    // Size of the item along the list direction
+    using item_extent_t = std::function<float(size_t index)>;
+
+    static constexpr float DEFAULT_OVERSCAN = 64;
+
+    size_t item_count = 0;
+    item_extent_t item_extent;
+    item_builder_t build_item;
+    Direction direction = Direction::Vertical;
+    // Distance from the list start to the viewport start
+    float scroll_offset = 0;
+    float overscan = DEFAULT_OVERSCAN;
+};
+
+template<View TItemView>
+struct VirtualList<TItemView>::Renderer
+{
+    using view_type = VirtualList<TItemView>;
+    using item_renderer_type = typename TItemView::Renderer;
+
+    // Renderers of the items [first_item, first_item + items.size())
+    std::deque<item_renderer_type> items;
+    size_t first_item = 0;
+    // Item start offsets, followed by the whole list extent. The extents are
+    // estimated again only when the item count changes
+    std::vector<float> item_offsets;
+    // Extent of the viewport along the list at the last layout
+    float viewport_extent = 0;
+    // The lowest renderer above the list, found when the rows were created
+    std::optional<flecs::entity> bound_above;
+
+    Renderer(State& state, RenderManager& render_manager, const view_type& view) {}
+
+    void collect_entities(std::vector<flecs::entity>& entities) const
+    {
+        for (const auto& item : items)
+        {
+            collect_render_entities(item, entities);
+        }
+    }
+
+    Size layout(const BoxConstraints& constraints, const view_type& view)
+    {
+        return Size::unconstrainted();
+    }
+
+    // The rect of the list is known only after the layout is solved, so the
+    // rows are chosen by the viewport extent of the previous frame
+    void flatten(
+        State& state,
+        RenderManager& render_manager,
+        FlatLayout& layout,
+        uint32_t parent,
+        const view_type& view
+    )
+    {
+        const auto vertical = view.direction == Direction::Vertical;
+        const auto node = layout.push(FlatLayout::NodeKind::VirtualList, parent);
+        if (const auto* previous_rect = layout.previous_rect(node))
+        {
+            const auto size = previous_rect->size();
+            viewport_extent = vertical ? size.y : size.x;
+        }
+
+        update_window(state, render_manager, view);
+        layout.set_params(
+            node,
+            glm::vec4 {
+                vertical ? 1 : 0,
+                item_offsets[first_item] - view.scroll_offset,
+                0,
+                0,
+            }
+        );
+
+        const auto unconstrainted = std::numeric_limits<float>::infinity();
+        for (size_t i = 0; i < items.size(); i++)
+        {
+            const auto index = first_item + i;
+            const auto extent = item_offsets[index + 1] - item_offsets[index];
+            const auto item_node = layout.push(
+                FlatLayout::NodeKind::SizedBox,
+                node,
+                vertical ? glm::vec4 { unconstrainted, extent, 0, 0 }
+                         : glm::vec4 { extent, unconstrainted, 0, 0 }
+            );
+            items[i].flatten(
+                state, render_manager, layout, item_node, view.build_item(index)
+            );
+            layout.end(item_node);
+        }
+        layout.end(node);
+    }
+
+    void
+    render(State& state, RenderManager& render_manager, Rect& rect, const view_type& view)
+    {
+        const auto vertical = view.direction == Direction::Vertical;
+        const auto rect_size = rect.size();
+        viewport_extent = vertical ? rect_size.y : rect_size.x;
+
+        update_window(state, render_manager, view);
+
+        state.clip_stack.push(rect);
+        for (size_t i = 0; i < items.size(); i++)
+        {
+            const auto index = first_item + i;
+            const auto item_start = item_offsets[index] - view.scroll_offset;
+            const auto item_extent = item_offsets[index + 1] - item_offsets[index];
+
+            auto item_rect =
+                vertical
+                    ? Rect::from_top_left(
+                          glm::vec2 { rect.left(), rect.top() - item_start },
+                          glm::vec2 { rect_size.x, item_extent }
+                      )
+                    : Rect::from_top_left(
+                          glm::vec2 { rect.left() + item_start, rect.top() },
+                          glm::vec2 { item_extent, rect_size.y }
+                      );
+
+            items[i].render(state, render_manager, item_rect, view.build_item(index));
+        }
+        state.clip_stack.pop();
+    }
+
+private:
+    // Moves the window to the items intersecting the viewport and the overscan
+    void update_window(State& state, RenderManager& render_manager, const view_type& view)
+    {
+        if (item_offsets.size() != view.item_count + 1)
+        {
+            update_item_offsets(view);
+        }
+
+        const auto viewport_start = view.scroll_offset - view.overscan;
+        const auto viewport_end = view.scroll_offset + viewport_extent + view.overscan;
+
+        const auto offsets_end = item_offsets.end() - 1;
+        const auto first_it =
+            std::upper_bound(item_offsets.begin(), offsets_end, viewport_start);
+        const auto last_it =
+            std::lower_bound(item_offsets.begin(), offsets_end, viewport_end);
+        const auto first = static_cast<size_t>(
+            std::max(first_it - item_offsets.begin() - 1, std::ptrdiff_t { 0 })
+        );
+        const auto last = std::max(
+            static_cast<size_t>(last_it - item_offsets.begin()), first
+        );
+
+        move_window(state, render_manager, view, first, last);
+    }
+
+    void update_item_offsets(const view_type& view)
+    {
+        item_offsets.resize(view.item_count + 1);
+        item_offsets[0] = 0;
+        for (size_t i = 0; i < view.item_count; i++)
+        {
+            item_offsets[i + 1] = item_offsets[i] + view.item_extent(i);
+        }
+    }
+
+    // Moves the renderer window to the items [first, last). The renderers of the
+    // items leaving the window are reused for the entering ones, and the rest
+    // of them are destroyed with their entities
+    void move_window(
+        State& state,
+        RenderManager& render_manager,
+        const view_type& view,
+        size_t first,
+        size_t last
+    )
+    {
+        // Found before the created rows are put on top of the layer
+        std::vector<flecs::entity> entities;
+        collect_entities(entities);
+        bound_above = render_bound_above(state, entities, bound_above);
+
+        std::vector<item_renderer_type> recycled;
+        bool created = false;
+
+        while (!items.empty() && first_item < first)
+        {
+            recycled.push_back(std::move(items.front()));
+            items.pop_front();
+            first_item++;
+        }
+        while (!items.empty() && first_item + items.size() > last)
+        {
+            recycled.push_back(std::move(items.back()));
+            items.pop_back();
+        }
+
+        if (items.empty())
+        {
+            first_item = first;
+        }
+
+        const auto take_renderer = [&](size_t index)
+        {
+            if (recycled.empty())
+            {
+                created = true;
+                return item_renderer_type {
+                    state, render_manager, view.build_item(index)
+                };
+            }
+
+            auto renderer = std::move(recycled.back());
+            recycled.pop_back();
+            return renderer;
+        };
+
+        while (first_item > first)
+        {
+            first_item--;
+            items.push_front(take_renderer(first_item));
+        }
+        while (first_item + items.size() < last)
+        {
+            items.push_back(take_renderer(first_item + items.size()));
+        }
+
+        if (created && bound_above.has_value())
+        {
+            entities.clear();
+            collect_entities(entities);
+            place_below_bound(state, render_manager, entities, *bound_above);
+        }
+    }
+};
+}
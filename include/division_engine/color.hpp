@@ -5,12 +5,12 @@
 
 namespace division_engine::color
 {
-    const glm::vec4 WHITE { 1 };
-    const glm::vec4 BLACK { 0, 0, 0, 1 };
-    const glm::vec4 RED { 1, 0, 0, 1 };
-    const glm::vec4 GREEN { 0, 1, 0, 1 };
-    const glm::vec4 BLUE { 0, 0, 1, 1 };
-    const glm::vec4 PURPLE { 1, 0, 1, 1 };
-    const glm::vec4 YELLOW { 1, 1, 0, 1 };
-    const glm::vec4 AQUA { 0, 1, 1, 0 };
+    constexpr glm::vec4 WHITE { 1 };
+    constexpr glm::vec4 BLACK { 0, 0, 0, 1 };
+    constexpr glm::vec4 RED { 1, 0, 0, 1 };
+    constexpr glm::vec4 GREEN { 0, 1, 0, 1 };
+    constexpr glm::vec4 BLUE { 0, 0, 1, 1 };
+    constexpr glm::vec4 PURPLE { 1, 0, 1, 1 };
+    constexpr glm::vec4 YELLOW { 1, 1, 0, 1 };
+    constexpr glm::vec4 AQUA { 0, 1, 1, 0 };
 }
@@ -1,10 +1,13 @@
 #pragma once
 
+#include "frame_scheduler.hpp"
+#include "input_queue.hpp"
 #include "lifecycle_manager.hpp"
 
 #include <division_engine_core/types/division_lifecycle.h>
 #include <glm/glm.hpp>
 
+#include <memory>
 #include <string>
 #include <type_traits>
 
@@ -22,39 +25,60 @@ struct CoreRunner
     CoreRunner(std::string window_title, glm::uvec2 window_size);
     ~CoreRunner();
 
+    // Shared by the copies of the runner, so the manager can keep a reference
+    FrameScheduler& frame_scheduler() { return *_frame_scheduler; }
+
+    // Shared the same way. Posting an event requests a frame
+    InputQueue& input_queue() { return *_input_queue; }
+
     template<LifecycleManagerBuilder T>
     void run(T&& lifecycle_manager_builder)
     {
-        using manager_ptr_type = 
+        using manager_ptr_type =
             typename std::invoke_result_t<decltype(&T::build), T, DivisionContext*>;
 
-        set_context_user_data(_ctx, &lifecycle_manager_builder);
+        struct RunData
+        {
+            T* builder;
+            manager_ptr_type manager;
+            FrameScheduler* frame_scheduler;
+        };
+
+        RunData run_data {
+            .builder = &lifecycle_manager_builder,
+            .manager = nullptr,
+            .frame_scheduler = _frame_scheduler.get(),
+        };
+
+        set_context_user_data(_ctx, &run_data);
         DivisionLifecycle lifecycle {
             .init_callback =
                 [](DivisionContext* ctx)
             {
-                T& builder = *static_cast<T*>(get_context_user_data(ctx));
-                auto* manager = builder.build(ctx);
-
-                set_context_user_data(ctx, manager);
+                auto& data = *static_cast<RunData*>(get_context_user_data(ctx));
+                data.manager = data.builder->build(ctx);
             },
             .draw_callback =
                 [](DivisionContext* ctx)
             {
-                auto& manager = *static_cast<manager_ptr_type>(get_context_user_data(ctx));
-                manager.draw();
+                auto& data = *static_cast<RunData*>(get_context_user_data(ctx));
+                if (begin_frame(ctx, *data.frame_scheduler))
+                {
+                    data.manager->draw();
+                }
             },
             .free_callback =
                 [](DivisionContext* ctx)
             {
-                auto* manager = static_cast<manager_ptr_type>(get_context_user_data(ctx));
-                delete manager;
+                auto& data = *static_cast<RunData*>(get_context_user_data(ctx));
+                delete data.manager;
+                data.manager = nullptr;
             },
             .error_callback =
                 [](DivisionContext* ctx, int error_code, const char* error_message)
             {
-                auto& manager = *static_cast<manager_ptr_type>(get_context_user_data(ctx));
-                manager.error(error_code, error_message);
+                auto& data = *static_cast<RunData*>(get_context_user_data(ctx));
+                data.manager->error(error_code, error_message);
             },
         };
 
@@ -65,9 +89,13 @@ private:
     DivisionContext* _ctx;
     std::string _window_title;
     glm::uvec2 _window_size;
+    std::shared_ptr<FrameScheduler> _frame_scheduler;
+    std::shared_ptr<InputQueue> _input_queue;
 
     void execute(const DivisionLifecycle* lifecycle);
 
+    static bool begin_frame(DivisionContext* context_ptr, FrameScheduler& scheduler);
+
     static void* get_context_user_data(DivisionContext* context_ptr);
     static void set_context_user_data(DivisionContext* context_ptr, void* user_data_ptr);
 };
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "division_engine/core/context.hpp"
+#include "division_engine/core/texture_manager.hpp"
 #include "glm/ext/vector_int2.hpp"
 
 #include <cstddef>
@@ -26,8 +27,10 @@ public:
     FontTexture(FontTexture&&) = delete;
     FontTexture& operator=(FontTexture&&) = delete;
 
+    // The texture is acquired from the texture manager as a font texture
     FontTexture(
         Context& context,
+        TextureManager& texture_manager,
         const std::filesystem::path& font_path,
         size_t font_size,
         glm::ivec2 resolution = DEFAULT_RESOLUTION
@@ -66,6 +69,7 @@ private:
     std::vector<FreeBlock> _free_rows_space;
 
     Context _ctx;
+    TextureManager& _texture_manager;
 
     glm::ivec2 _resolution;
     size_t _font_size;
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <glm/vec2.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace division_engine::core
+{
+enum class RenderMode : uint8_t
+{
+    // Every iteration of the run loop draws a frame
+    Continuous,
+    // A frame is drawn only when it was requested or the window was resized
+    OnDemand,
+};
+
+// Decides whether the run loop draws the next frame. In the on-demand mode the
+// loop blocks until a frame is requested, waking up after the idle timeout to
+// let the core process the window events.
+// The core runs the loop and polls the window events itself, without a call
+// to block on them, so an idle window still wakes up once per idle timeout,
+// 20 times a second by default. Each of these wakeups is counted as a skipped
+// frame and costs a poll of the events, but nothing is drawn or submitted
+class FrameScheduler
+{
+public:
+    static constexpr auto DEFAULT_IDLE_TIMEOUT = std::chrono::milliseconds { 50 };
+
+    FrameScheduler() = default;
+    FrameScheduler(const FrameScheduler&) = delete;
+    FrameScheduler& operator=(const FrameScheduler&) = delete;
+    FrameScheduler(FrameScheduler&&) = delete;
+    FrameScheduler& operator=(FrameScheduler&&) = delete;
+    ~FrameScheduler() = default;
+
+    void set_mode(RenderMode mode);
+    RenderMode mode() const { return _mode.load(std::memory_order_relaxed); }
+
+    void set_idle_timeout(std::chrono::milliseconds timeout);
+
+    // Requests a frame and wakes the loop up. Can be called from any thread,
+    // e.g. by the input handlers or a loader that finished its work
+    void invalidate();
+
+    // Requests the frame after the current one. Animations call it on every
+    // frame while they run
+    void request_animation_frame();
+
+    // Called by the runner before every frame with the current frame buffer
+    // size. Returns false if the frame is skipped
+    bool begin_frame(glm::vec2 frame_buffer_size);
+
+    // The loop iterations that didn't draw a frame, including the idle wakeups
+    uint64_t skipped_frame_count() const
+    {
+        return _skipped_frame_count.load(std::memory_order_relaxed);
+    }
+
+    uint64_t drawn_frame_count() const
+    {
+        return _drawn_frame_count.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::mutex _mutex;
+    std::condition_variable _frame_requested_condition;
+    std::chrono::milliseconds _idle_timeout = DEFAULT_IDLE_TIMEOUT;
+    glm::vec2 _frame_buffer_size { 0 };
+    bool _frame_requested = true;
+
+    std::atomic<RenderMode> _mode = RenderMode::Continuous;
+    std::atomic<uint64_t> _skipped_frame_count = 0;
+    std::atomic<uint64_t> _drawn_frame_count = 0;
+};
+}
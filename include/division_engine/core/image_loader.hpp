@@ -0,0 +1,177 @@
+#pragma once
+
+#include "division_engine/core/context.hpp"
+#include "division_engine/core/texture_manager.hpp"
+
+#include <division_engine_core/types/id.h>
+#include <glm/vec2.hpp>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace division_engine::core
+{
+struct ImageHandle
+{
+    uint32_t index;
+};
+
+enum class ImageStatus
+{
+    Loading,
+    Ready,
+    Failed,
+    Evicted,
+};
+
+// Decodes JPEG and PNG images on the worker threads. The decoded pixels are
+// uploaded from `update` on the render thread, no more than the upload budget
+// per frame. Until then the image is drawn with the placeholder texture.
+// The image textures are evictable, an evicted image gets the placeholder back
+// until it is reloaded
+class ImageLoader
+{
+public:
+    // Called with the uploaded texture, or with the placeholder after eviction
+    using TextureCallback = std::function<void(DivisionId texture_id)>;
+
+    static constexpr size_t DEFAULT_WORKER_COUNT = 2;
+    static constexpr size_t DEFAULT_UPLOAD_BUDGET_BYTES = 4 * 1024 * 1024;
+
+    ImageLoader() = delete;
+    ImageLoader(const ImageLoader&) = delete;
+    ImageLoader& operator=(const ImageLoader&) = delete;
+    ImageLoader(ImageLoader&&) = delete;
+    ImageLoader& operator=(ImageLoader&&) = delete;
+
+    ImageLoader(
+        Context& context,
+        TextureManager& texture_manager,
+        DivisionId placeholder_texture_id,
+        size_t worker_count = DEFAULT_WORKER_COUNT,
+        size_t upload_budget_bytes = DEFAULT_UPLOAD_BUDGET_BYTES
+    );
+    ~ImageLoader();
+
+    // Returns immediately. The callback is invoked on the render thread
+    // when the texture of the image changes
+    ImageHandle
+    load(const std::filesystem::path& path, TextureCallback on_texture_changed = {});
+
+    // Uploads the decoded images while the frame budget allows it.
+    // At least one image is uploaded per call, even if it exceeds the budget
+    void update();
+
+    // Decodes and uploads an evicted image again. The other images are left
+    // as they are
+    void reload(ImageHandle handle);
+
+    // Deletes the texture of the image. The handle must not be used after it
+    void release(ImageHandle handle);
+
+    ImageStatus status(ImageHandle handle) const { return _images[handle.index].status; }
+
+    // Returns the placeholder texture until the image is uploaded
+    DivisionId texture_id(ImageHandle handle) const
+    {
+        const auto& image = _images[handle.index];
+        return image.status == ImageStatus::Ready ? image.texture_id
+                                                  : _placeholder_texture_id;
+    }
+
+    glm::ivec2 size(ImageHandle handle) const { return _images[handle.index].size; }
+
+    // Why the image failed to load, empty for the other statuses
+    const std::string& error(ImageHandle handle) const
+    {
+        return _images[handle.index].error;
+    }
+
+    void set_upload_budget(size_t upload_budget_bytes)
+    {
+        _upload_budget_bytes = upload_budget_bytes;
+    }
+
+private:
+    struct Image
+    {
+        ImageStatus status;
+        DivisionId texture_id;
+        glm::ivec2 size;
+        TextureCallback on_texture_changed;
+        std::string error;
+        // Kept for the reload after the eviction
+        std::filesystem::path path;
+    };
+
+    struct Job
+    {
+        ImageHandle handle;
+        std::filesystem::path path;
+    };
+
+    // Frees the pixels with the allocator of the decoder
+    struct PixelsDeleter
+    {
+        void operator()(uint8_t* pixels) const;
+    };
+
+    struct DecodedImage
+    {
+        ImageHandle handle;
+        glm::ivec2 size;
+        // Owned as the decoder returned them, so they aren't copied before
+        // the upload
+        std::unique_ptr<uint8_t, PixelsDeleter> pixels;
+        // Empty when the image is decoded
+        std::string error;
+    };
+
+    // Reuses the file buffers between the loads, so streaming images don't
+    // allocate a buffer per file. The decoder allocates the pixels itself
+    class BufferPool
+    {
+    public:
+        std::vector<uint8_t> acquire(size_t size);
+        void release(std::vector<uint8_t>&& buffer);
+
+    private:
+        static constexpr size_t MAX_FREE_BUFFERS = 16;
+
+        std::mutex _mutex;
+        std::vector<std::vector<uint8_t>> _free_buffers;
+    };
+
+    Context _ctx;
+    TextureManager& _texture_manager;
+    DivisionId _placeholder_texture_id;
+    size_t _upload_budget_bytes;
+
+    std::vector<Image> _images;
+    std::vector<uint32_t> _free_indices;
+    BufferPool _buffer_pool;
+
+    std::mutex _jobs_mutex;
+    std::condition_variable _jobs_condition;
+    std::deque<Job> _jobs;
+    bool _stopping;
+
+    std::mutex _decoded_mutex;
+    std::deque<DecodedImage> _decoded;
+
+    std::vector<std::thread> _workers;
+
+    void run_worker();
+    void evict(DivisionId texture_id);
+    DecodedImage decode(const Job& job);
+};
+}
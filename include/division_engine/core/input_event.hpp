@@ -0,0 +1,32 @@
+#pragma once
+
+#include <glm/vec2.hpp>
+
+#include <cstdint>
+
+namespace division_engine::core
+{
+enum class InputEventType : uint8_t
+{
+    PointerMove,
+    PointerDown,
+    PointerUp,
+    Scroll,
+};
+
+enum class PointerButton : uint8_t
+{
+    Left,
+    Right,
+    Middle,
+};
+
+struct InputEvent
+{
+    InputEventType type;
+    // In the screen coordinates, the same as the render bounds
+    glm::vec2 position { 0 };
+    PointerButton button = PointerButton::Left;
+    glm::vec2 scroll_delta { 0 };
+};
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "frame_scheduler.hpp"
+#include "input_event.hpp"
+
+#include <mutex>
+#include <vector>
+
+namespace division_engine::core
+{
+// Input events waiting for the next frame. The window layer, or a test with
+// synthetic events, posts them from any thread, and the lifecycle manager
+// takes them at the start of its frame
+class InputQueue
+{
+public:
+    // Every posted event wakes up the scheduler, if there is one
+    explicit InputQueue(FrameScheduler* frame_scheduler = nullptr)
+      : _frame_scheduler(frame_scheduler)
+    {
+    }
+
+    InputQueue(const InputQueue&) = delete;
+    InputQueue& operator=(const InputQueue&) = delete;
+    InputQueue(InputQueue&&) = delete;
+    InputQueue& operator=(InputQueue&&) = delete;
+    ~InputQueue() = default;
+
+    void post(const InputEvent& event);
+
+    // Replaces the content of the vector with the posted events in the order
+    // they were posted
+    void take(std::vector<InputEvent>& events);
+
+private:
+    FrameScheduler* _frame_scheduler;
+    std::mutex _mutex;
+    std::vector<InputEvent> _events;
+};
+}
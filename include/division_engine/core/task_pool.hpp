@@ -0,0 +1,70 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace division_engine::core
+{
+// Runs the batches of independent tasks on the worker threads. Each thread
+// takes the tasks from the back of its own queue and steals from the front of
+// the other queues when its own is empty, so the uneven tasks balance out
+class TaskPool
+{
+public:
+    using TaskFunction = std::function<void(size_t task_index)>;
+
+    TaskPool() = delete;
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+    TaskPool(TaskPool&&) = delete;
+    TaskPool& operator=(TaskPool&&) = delete;
+
+    // The calling thread works too, so a pool without workers runs inline.
+    // Next to a flecs world the pool takes one worker less than the world
+    // threads, so the two don't oversubscribe the cores
+    explicit TaskPool(size_t worker_count = default_worker_count());
+    ~TaskPool();
+
+    // Calls the function for every index below the task count and returns
+    // when all of them are done. The function must not throw. Only one batch
+    // runs at a time
+    void parallel_for(size_t task_count, const TaskFunction& task);
+
+    size_t thread_count() const { return _workers.size() + 1; }
+
+    static size_t default_worker_count();
+
+private:
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<size_t> tasks;
+    };
+
+    // The last queue is the one of the calling thread
+    std::vector<std::unique_ptr<Queue>> _queues;
+    std::vector<std::thread> _workers;
+
+    std::mutex _mutex;
+    std::condition_variable _work_condition;
+    std::condition_variable _done_condition;
+    size_t _generation;
+    bool _stopping;
+
+    // Written before the tasks are queued, so it is visible to whoever
+    // dequeues one
+    const TaskFunction* _task;
+    std::atomic<size_t> _remaining;
+
+    void run_worker(size_t queue_index);
+    void run_tasks(size_t queue_index);
+    bool pop_task(size_t queue_index, size_t& task_index);
+};
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "division_engine/core/context.hpp"
+#include "division_engine/core/texture_manager.hpp"
+
+#include <division_engine_core/types/id.h>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace division_engine::core
+{
+// Image packed into one of the atlas pages. The uv rect holds the origin
+// in `xy` and the size in `zw`, in the normalized texture coordinates
+struct AtlasRegion
+{
+    DivisionId texture_id;
+    glm::vec4 uv_rect;
+    glm::ivec2 size;
+};
+
+// Packs small RGBA images into shared texture pages with a shelf packer,
+// so the rects sampling them can be drawn with a single instanced pass per page.
+// With the eviction callback the pages are evictable: an evicted page is
+// dropped with its images, which the owner adds again when they are needed
+class TextureAtlas
+{
+public:
+    using PageEvictionCallback = TextureManager::EvictionCallback;
+
+    constexpr static const glm::ivec2 DEFAULT_PAGE_SIZE { 1024, 1024 };
+    constexpr static const size_t BYTES_PER_PIXEL = 4;
+
+    TextureAtlas() = delete;
+    TextureAtlas(const TextureAtlas&) = delete;
+    TextureAtlas& operator=(const TextureAtlas&) = delete;
+    TextureAtlas(TextureAtlas&&) = delete;
+    TextureAtlas& operator=(TextureAtlas&&) = delete;
+
+    TextureAtlas(
+        Context& context,
+        TextureManager& texture_manager,
+        glm::ivec2 page_size = DEFAULT_PAGE_SIZE,
+        PageEvictionCallback on_page_evicted = {}
+    );
+    ~TextureAtlas();
+
+    // Copies the RGBA pixels into a page. The pixels are uploaded with the
+    // next `upload_pages` call
+    AtlasRegion add_image(glm::ivec2 size, std::span<const uint8_t> pixels);
+
+    void upload_pages();
+
+    size_t page_count() const { return _pages.size(); }
+    glm::ivec2 page_size() const { return _page_size; }
+
+private:
+    struct Shelf
+    {
+        int32_t y;
+        int32_t height;
+        int32_t next_x;
+    };
+
+    struct Page
+    {
+        DivisionId texture_id;
+        std::vector<uint8_t> pixels;
+        std::vector<Shelf> shelves;
+        int32_t next_shelf_y;
+        bool changed;
+    };
+
+    Context _ctx;
+    TextureManager& _texture_manager;
+    glm::ivec2 _page_size;
+    std::vector<Page> _pages;
+    PageEvictionCallback _on_page_evicted;
+
+    bool try_place(Page& page, glm::ivec2 size, glm::ivec2& position);
+    Page& add_page();
+    void evict_page(DivisionId texture_id);
+};
+}
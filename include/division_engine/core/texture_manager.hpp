@@ -0,0 +1,133 @@
+#pragma once
+
+#include "division_engine/core/context.hpp"
+
+#include <division_engine_core/types/id.h>
+#include <division_engine_core/types/texture.h>
+#include <glm/vec2.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace division_engine::core
+{
+enum class TextureSubsystem : uint8_t
+{
+    Canvas,
+    Font,
+    Atlas,
+    Image,
+    User,
+    Count,
+};
+
+// Owns the textures of the engine subsystems. Released textures are kept in
+// pools by size and format for reuse. When the budget is exceeded, the pooled
+// textures are freed first, then the least recently used evictable textures.
+// Textures used in the current or the previous frame are never evicted: the
+// previous frame is on screen until the current one is drawn, and the uploads
+// at the frame start come before the drawers touch anything
+class TextureManager
+{
+public:
+    // Called when an evictable texture is deleted, so the owner stops using it
+    using EvictionCallback = std::function<void(DivisionId texture_id)>;
+
+    static constexpr size_t UNLIMITED_BUDGET = std::numeric_limits<size_t>::max();
+
+    TextureManager() = delete;
+    TextureManager(const TextureManager&) = delete;
+    TextureManager& operator=(const TextureManager&) = delete;
+    TextureManager(TextureManager&&) = delete;
+    TextureManager& operator=(TextureManager&&) = delete;
+
+    explicit TextureManager(Context& context, size_t budget_bytes = UNLIMITED_BUDGET);
+    ~TextureManager();
+
+    // The texture is evictable if the eviction callback is set
+    DivisionId acquire(
+        glm::ivec2 size,
+        DivisionTextureFormat format,
+        TextureSubsystem subsystem,
+        EvictionCallback on_evicted = {}
+    );
+
+    // Returns the texture to the pool of its size and format
+    void release(DivisionId texture_id);
+
+    // Marks the texture as used in the current frame
+    void touch(DivisionId texture_id)
+    {
+        const auto it = _textures.find(texture_id);
+        if (it != _textures.end())
+        {
+            it->second.last_used_frame = _frame;
+        }
+    }
+
+    void next_frame() { _frame++; }
+
+    void set_budget(size_t budget_bytes);
+    size_t budget() const { return _budget_bytes; }
+
+    // Bytes of the live and the pooled textures
+    size_t current_bytes() const { return _live_bytes + _pooled_bytes; }
+    size_t peak_bytes() const { return _peak_bytes; }
+    size_t pooled_bytes() const { return _pooled_bytes; }
+    size_t subsystem_bytes(TextureSubsystem subsystem) const
+    {
+        return _subsystem_bytes[static_cast<size_t>(subsystem)];
+    }
+
+    static size_t texture_bytes(glm::ivec2 size, DivisionTextureFormat format);
+
+private:
+    struct Texture
+    {
+        glm::ivec2 size;
+        DivisionTextureFormat format;
+        TextureSubsystem subsystem;
+        uint64_t last_used_frame;
+        EvictionCallback on_evicted;
+    };
+
+    struct BucketKey
+    {
+        glm::ivec2 size;
+        DivisionTextureFormat format;
+
+        bool operator==(const BucketKey& other) const = default;
+    };
+
+    struct BucketKeyHash
+    {
+        size_t operator()(const BucketKey& key) const
+        {
+            const auto size_hash = std::hash<int64_t> {}(
+                (static_cast<int64_t>(key.size.x) << 32) | key.size.y
+            );
+            return size_hash ^ (static_cast<size_t>(key.format) << 1);
+        }
+    };
+
+    Context _ctx;
+    std::unordered_map<DivisionId, Texture> _textures;
+    std::unordered_map<BucketKey, std::vector<DivisionId>, BucketKeyHash> _pools;
+    std::array<size_t, static_cast<size_t>(TextureSubsystem::Count)> _subsystem_bytes;
+
+    size_t _budget_bytes;
+    size_t _live_bytes;
+    size_t _pooled_bytes;
+    size_t _peak_bytes;
+    uint64_t _frame;
+
+    void enforce_budget(size_t incoming_bytes);
+    void free_pools();
+    bool evict_least_recently_used();
+};
+}
@@ -52,7 +52,7 @@ auto sorted_insert(
         insert_container.begin(), insert_container.end(), element, comparer
     );
 
-    if (lower_bound == insert_container.end() || comparer(*lower_bound, element))
+    if (lower_bound == insert_container.end() || comparer(element, *lower_bound))
     {
         lower_bound = insert_container.insert(lower_bound, element);
     }
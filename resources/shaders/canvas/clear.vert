@@ -0,0 +1,21 @@
+#version 450 core
+
+layout (location = 0) in vec2 vertPos;
+
+layout (location = 1) in vec4 inRect;
+layout (location = 2) in vec4 inColor;
+
+layout (location = 0) out vec4 outColor;
+
+layout (std140, binding = 1) uniform Uniforms {
+    vec2 screenSize;
+};
+
+void main() {
+    vec2 vertWorldPos = mix(inRect.xy, inRect.zw, vertPos);
+    vec2 normPos = vertWorldPos / screenSize;
+
+    outColor = inColor;
+
+    gl_Position = vec4(mix(vec2(-1,-1), vec2(1,1), normPos), 0, 1);
+}
@@ -3,12 +3,25 @@
 layout (location = 0) in vec4 Color;
 layout (location = 1) in vec2 TexelCoord;
 layout (location = 2) in centroid vec2 UV;
+layout (location = 3) in vec2 VertPos;
 
 layout (location = 0) out vec4 FragColor;
 
 layout (binding = 0) uniform sampler2D Tex;
 
+// Left, bottom, right, top
+layout (std140, binding = 3) uniform Scissor {
+    vec4 scissorRect;
+};
+
 void main() {
+    bool outsideScissor =
+        any(lessThan(VertPos, scissorRect.xy)) || any(greaterThan(VertPos, scissorRect.zw));
+    if (outsideScissor)
+    {
+        discard;
+    }
+
     ivec2 iTexCoord = ivec2(TexelCoord);
 
     float col = 0;
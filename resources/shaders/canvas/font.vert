@@ -8,22 +8,45 @@ layout (location = 3) in vec2 inTexelCoord;
 layout (location = 4) in vec2 inSize;
 layout (location = 5) in vec2 inPosition;
 layout (location = 6) in vec2 glyphInTexSize;
+layout (location = 8) in vec4 inClipRect;
+layout (location = 9) in float inTranslationIndex;
 
 layout (location = 0) out vec4 outColor;
 layout (location = 1) out vec2 outTexelCoord;
 layout (location = 2) out centroid vec2 outUV;
+layout (location = 3) out vec2 outVertPos;
 
 layout (std140, binding = 1) uniform Uniforms {
     vec2 screenSize;
 };
 
+// Offsets and screen areas of the scroll views, the first ones are zero and
+// unbounded
+layout (std140, binding = 2) uniform ScrollTranslations {
+    vec4 translations[256];
+    vec4 viewports[256];
+};
+
 void main() {
-    vec2 vertWorldPos = vertPos * inSize + inPosition; 
+    // Clip rect is (left, bottom, right, top) in the content of the scroll
+    // view, so it moves with the offset and is cut by the viewport of the
+    // scroll on the screen. The glyph quad is cut by it, so the UV is taken
+    // from the clipped position
+    int translationIndex = int(inTranslationIndex);
+    vec2 translation = translations[translationIndex].xy;
+    vec4 viewport = viewports[translationIndex];
+    vec2 clipMin = max(inClipRect.xy + translation, viewport.xy);
+    vec2 clipMax = min(inClipRect.zw + translation, viewport.zw);
+    vec2 position = inPosition + translation;
+    vec2 vertWorldPos = clamp(vertPos * inSize + position, clipMin, clipMax);
+    vec2 localPos = (vertWorldPos - position) / max(inSize, vec2(0.0001));
+    vec2 uv = vec2(localPos.x, 1.0 - localPos.y);
     vec2 normPos = vertWorldPos / screenSize;
     
     outColor = inColor;
-    outTexelCoord = inTexelCoord + glyphInTexSize * inUV;
-    outUV = inUV;
+    outTexelCoord = inTexelCoord + glyphInTexSize * uv;
+    outUV = uv;
+    outVertPos = vertWorldPos;
 
     gl_Position = vec4(mix(vec2(-1,-1), vec2(1,1), normPos), 0, 1);
 }
\ No newline at end of file
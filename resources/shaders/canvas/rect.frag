@@ -11,6 +11,11 @@ layout (location = 0) out vec4 ResultColor;
 
 layout (binding = 0) uniform sampler2D Tex;
 
+// Left, bottom, right, top
+layout (std140, binding = 3) uniform Scissor {
+    vec4 scissorRect;
+};
+
 float select(bool selector, float a, float b) 
 {
     return float(selector) * a + float(!selector) * b;
@@ -35,6 +40,13 @@ float sdRoundedBox(in vec2 p, in vec2 b, in vec4 r)
 
 void main()
 {
+    bool outsideScissor =
+        any(lessThan(VertPos, scissorRect.xy)) || any(greaterThan(VertPos, scissorRect.zw));
+    if (outsideScissor)
+    {
+        discard;
+    }
+
     vec4 texColor = texture(Tex, UV);
     vec2 extents = Size * 0.5;
     vec2 centerToVert = VertPos - (Position + extents);
@@ -7,6 +7,9 @@ layout (location = 2) in vec2 inSize;
 layout (location = 3) in vec2 inPosition;
 layout (location = 4) in vec4 inColor;
 layout (location = 5) in vec4 in_TRBRTLBL_BorderRadius;
+layout (location = 6) in vec4 inUVRect;
+layout (location = 7) in vec4 inClipRect;
+layout (location = 8) in float inTranslationIndex;
 
 layout (location = 0) out vec4 outColor;
 layout (location = 1) out vec4 out_TRBRTLBL_BorderRadius;
@@ -19,14 +22,32 @@ layout (std140, binding = 1) uniform Uniforms {
     vec2 screenSize;
 };
 
+// Offsets and screen areas of the scroll views, the first ones are zero and
+// unbounded
+layout (std140, binding = 2) uniform ScrollTranslations {
+    vec4 translations[256];
+    vec4 viewports[256];
+};
+
 void main() {
-    vec2 vertWorldPos = vertPos * inSize + inPosition; 
+    // Clip rect is (left, bottom, right, top) in the content of the scroll
+    // view, so it moves with the offset and is cut by the viewport of the
+    // scroll on the screen. The quad is cut by it, so the UV is taken from
+    // the clipped position
+    int translationIndex = int(inTranslationIndex);
+    vec2 translation = translations[translationIndex].xy;
+    vec4 viewport = viewports[translationIndex];
+    vec2 clipMin = max(inClipRect.xy + translation, viewport.xy);
+    vec2 clipMax = min(inClipRect.zw + translation, viewport.zw);
+    vec2 position = inPosition + translation;
+    vec2 vertWorldPos = clamp(vertPos * inSize + position, clipMin, clipMax);
+    vec2 localPos = (vertWorldPos - position) / max(inSize, vec2(0.0001));
     vec2 normPos = vertWorldPos / screenSize;
 
     outColor = inColor;
     out_TRBRTLBL_BorderRadius = in_TRBRTLBL_BorderRadius;
-    outUV = inUV;
-    outPosition = inPosition;
+    outUV = inUVRect.xy + localPos * inUVRect.zw;
+    outPosition = position;
     outSize = inSize;
     outVertPos = vertWorldPos;
 
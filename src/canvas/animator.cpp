@@ -0,0 +1,400 @@
+#include "canvas/animator.hpp"
+
+#include "canvas/components/animated.hpp"
+#include "core/exception.hpp"
+
+#include <algorithm>
+#include <ranges>
+
+namespace division_engine::canvas
+{
+using namespace components;
+
+namespace
+{
+// Shorter tweens jump to the target at the next frame
+constexpr float MIN_DURATION = 1e-6f;
+
+struct EasingCubic
+{
+    float t;
+    float t2;
+    float t3;
+};
+
+// Coefficients of the progress powers by the easing
+constexpr std::array<EasingCubic, 4> EASING_CUBICS {
+    EasingCubic { 1, 0, 0 },  // Linear
+    EasingCubic { 0, 1, 0 },  // EaseIn, quadratic
+    EasingCubic { 2, -1, 0 }, // EaseOut, quadratic
+    EasingCubic { 0, 3, -2 }, // EaseInOut, smoothstep
+};
+
+uint32_t entity_index(flecs::entity_t entity)
+{
+    return static_cast<uint32_t>(entity);
+}
+
+size_t property_index(AnimatedProperty property)
+{
+    return static_cast<size_t>(property);
+}
+
+glm::vec2 xy(const glm::vec4& value)
+{
+    return glm::vec2 { value.x, value.y };
+}
+}
+
+Animator::~Animator()
+{
+    for (auto& system : _systems)
+    {
+        system.destruct();
+    }
+}
+
+void Animator::observe(flecs::world& world)
+{
+    _systems.push_back(world.system()
+                           .kind(flecs::PreStore)
+                           .iter(
+                               [this](flecs::iter& it)
+                               {
+                                   auto stage = it.world();
+                                   advance(stage, it.delta_time());
+                               }
+                           ));
+
+    // The renderers without a tween of a property keep its value. The written
+    // tables are marked by the system, so the damage tracker and the hit index
+    // find them by the change detection instead of a command per renderer
+    _systems.push_back(world.system<RenderBounds, RenderableRect*, RenderableText*>()
+                           .with<Animated>()
+                           .kind(flecs::PreStore)
+                           .multi_threaded()
+                           .iter(
+                               [this](
+                                   flecs::iter& it,
+                                   RenderBounds* bounds,
+                                   RenderableRect* rects,
+                                   RenderableText* texts
+                               ) { write(it, bounds, rects, texts); }
+                           ));
+}
+
+void Animator::animate(
+    flecs::entity entity,
+    AnimatedProperty property,
+    const glm::vec4& target,
+    float duration,
+    Easing easing
+)
+{
+    const auto from = current_value(entity, property);
+
+    auto& tween = animated_entity(entity.id()).tweens[property_index(property)];
+    if (tween == NO_TWEEN)
+    {
+        tween = static_cast<uint32_t>(_entities.size());
+        _entities.push_back(entity.id());
+        _properties.push_back(property);
+        _from.emplace_back();
+        _delta.emplace_back();
+        _values.emplace_back();
+        _elapsed.emplace_back();
+        _inverse_durations.emplace_back();
+        _ease1.emplace_back();
+        _ease2.emplace_back();
+        _ease3.emplace_back();
+    }
+
+    const auto& cubic = EASING_CUBICS[static_cast<size_t>(easing)];
+    _from[tween] = from;
+    _delta[tween] = target - from;
+    _values[tween] = from;
+    _elapsed[tween] = 0;
+    _inverse_durations[tween] = 1 / std::max(duration, MIN_DURATION);
+    _ease1[tween] = cubic.t;
+    _ease2[tween] = cubic.t2;
+    _ease3[tween] = cubic.t3;
+
+    entity.add<Animated>();
+
+    if (_frame_scheduler != nullptr)
+    {
+        _frame_scheduler->invalidate();
+    }
+}
+
+void Animator::stop(flecs::entity entity, AnimatedProperty property)
+{
+    const auto* animated = find_animated_entity(entity.id());
+    if (animated == nullptr)
+    {
+        return;
+    }
+
+    const auto tween = animated->tweens[property_index(property)];
+    if (tween == NO_TWEEN)
+    {
+        return;
+    }
+
+    // The tween finishes at the last written value, so the indices collected
+    // for the removal stay valid
+    _from[tween] = _values[tween];
+    _delta[tween] = glm::vec4 { 0 };
+    _elapsed[tween] = 0;
+    _inverse_durations[tween] = 1 / MIN_DURATION;
+}
+
+void Animator::advance(flecs::world& world, float delta_time)
+{
+    remove_finished(world);
+
+    const auto count = _entities.size();
+    auto* elapsed = _elapsed.data();
+    const auto* inverse_durations = _inverse_durations.data();
+    const auto* ease1 = _ease1.data();
+    const auto* ease2 = _ease2.data();
+    const auto* ease3 = _ease3.data();
+    const auto* from = _from.data();
+    const auto* delta = _delta.data();
+    auto* values = _values.data();
+
+    // Branchless, so the compiler vectorizes the sweep
+    for (size_t i = 0; i < count; i++)
+    {
+        elapsed[i] += delta_time;
+        const auto t = std::min(elapsed[i] * inverse_durations[i], 1.f);
+        const auto progress = t * (ease1[i] + t * (ease2[i] + t * ease3[i]));
+        values[i] = from[i] + delta[i] * progress;
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (elapsed[i] * inverse_durations[i] >= 1)
+        {
+            _finished.push_back(i);
+        }
+    }
+
+    // The finished tweens are removed at the next frame, so it is requested too
+    if (_frame_scheduler != nullptr && count > 0)
+    {
+        _frame_scheduler->request_animation_frame();
+    }
+}
+
+void Animator::write(
+    flecs::iter& it,
+    RenderBounds* bounds,
+    RenderableRect* rects,
+    RenderableText* texts
+) const
+{
+    const auto position_index = property_index(AnimatedProperty::Position);
+    const auto size_index = property_index(AnimatedProperty::Size);
+    const auto color_index = property_index(AnimatedProperty::Color);
+    const auto border_radius_index = property_index(AnimatedProperty::BorderRadius);
+
+    for (const auto i : it)
+    {
+        const auto entity = it.entity(i);
+        const auto* animated = find_animated_entity(entity.id());
+        if (animated == nullptr)
+        {
+            continue;
+        }
+
+        const auto& tweens = animated->tweens;
+        auto& rect = bounds[i].value;
+
+        const auto position = tweens[position_index];
+        const auto size = tweens[size_index];
+        if (position != NO_TWEEN)
+        {
+            rect.center = xy(_values[position]);
+        }
+        if (size != NO_TWEEN)
+        {
+            rect.extents = xy(_values[size]) * 0.5f; // NOLINT
+        }
+
+        const auto color = tweens[color_index];
+        if (color != NO_TWEEN && rects != nullptr)
+        {
+            rects[i].color = _values[color];
+        }
+        else if (color != NO_TWEEN && texts != nullptr)
+        {
+            texts[i].color = _values[color];
+        }
+
+        const auto border_radius = tweens[border_radius_index];
+        if (border_radius != NO_TWEEN && rects != nullptr)
+        {
+            rects[i].border_radius = BorderRadius { _values[border_radius] };
+        }
+    }
+}
+
+void Animator::remove_finished(flecs::world& world)
+{
+    // From the back, so the tweens moved into the removed places are already
+    // checked ones
+    for (const auto tween : std::views::reverse(_finished))
+    {
+        // Replaced tweens start again
+        if (_elapsed[tween] * _inverse_durations[tween] < 1)
+        {
+            continue;
+        }
+
+        const auto entity = _entities[tween];
+        remove_tween(tween);
+
+        const auto index = entity_index(entity);
+        if (index >= _animated.size() || _animated[index].entity != entity)
+        {
+            continue;
+        }
+
+        auto& animated = _animated[index];
+        if (std::ranges::all_of(animated.tweens, [](auto t) { return t == NO_TWEEN; }))
+        {
+            animated.entity = 0;
+
+            const flecs::entity renderer { world, entity };
+            if (renderer.is_alive())
+            {
+                renderer.remove<Animated>();
+            }
+        }
+    }
+
+    _finished.clear();
+}
+
+void Animator::remove_tween(uint32_t tween)
+{
+    const auto clear_slot = [this](uint32_t tween, uint32_t new_tween)
+    {
+        const auto index = entity_index(_entities[tween]);
+        if (index >= _animated.size() || _animated[index].entity != _entities[tween])
+        {
+            return;
+        }
+
+        auto& slot = _animated[index].tweens[property_index(_properties[tween])];
+        if (slot == tween)
+        {
+            slot = new_tween;
+        }
+    };
+
+    clear_slot(tween, NO_TWEEN);
+
+    const auto last = static_cast<uint32_t>(_entities.size() - 1);
+    if (tween != last)
+    {
+        clear_slot(last, tween);
+
+        _entities[tween] = _entities[last];
+        _properties[tween] = _properties[last];
+        _from[tween] = _from[last];
+        _delta[tween] = _delta[last];
+        _values[tween] = _values[last];
+        _elapsed[tween] = _elapsed[last];
+        _inverse_durations[tween] = _inverse_durations[last];
+        _ease1[tween] = _ease1[last];
+        _ease2[tween] = _ease2[last];
+        _ease3[tween] = _ease3[last];
+    }
+
+    _entities.pop_back();
+    _properties.pop_back();
+    _from.pop_back();
+    _delta.pop_back();
+    _values.pop_back();
+    _elapsed.pop_back();
+    _inverse_durations.pop_back();
+    _ease1.pop_back();
+    _ease2.pop_back();
+    _ease3.pop_back();
+}
+
+Animator::AnimatedEntity& Animator::animated_entity(flecs::entity_t entity)
+{
+    const auto index = entity_index(entity);
+    if (index >= _animated.size())
+    {
+        _animated.resize(index + 1, AnimatedEntity { .entity = 0 });
+    }
+
+    // The tweens of a destroyed entity with the same index are left to finish
+    auto& animated = _animated[index];
+    if (animated.entity != entity)
+    {
+        animated.entity = entity;
+        animated.tweens.fill(NO_TWEEN);
+    }
+
+    return animated;
+}
+
+const Animator::AnimatedEntity* Animator::find_animated_entity(flecs::entity_t entity
+) const
+{
+    const auto index = entity_index(entity);
+    if (index >= _animated.size() || _animated[index].entity != entity)
+    {
+        return nullptr;
+    }
+
+    return &_animated[index];
+}
+
+glm::vec4 Animator::current_value(flecs::entity entity, AnimatedProperty property)
+{
+    const auto* bounds = entity.get<RenderBounds>();
+    const auto* rect = entity.get<RenderableRect>();
+    const auto* text = entity.get<RenderableText>();
+
+    switch (property)
+    {
+    case AnimatedProperty::Position:
+        if (bounds != nullptr)
+        {
+            return glm::vec4 { bounds->value.center.x, bounds->value.center.y, 0, 0 };
+        }
+        break;
+    case AnimatedProperty::Size:
+        if (bounds != nullptr)
+        {
+            const auto size = bounds->value.size();
+            return glm::vec4 { size.x, size.y, 0, 0 };
+        }
+        break;
+    case AnimatedProperty::Color:
+        if (rect != nullptr)
+        {
+            return rect->color;
+        }
+        if (text != nullptr)
+        {
+            return text->color;
+        }
+        break;
+    case AnimatedProperty::BorderRadius:
+        if (rect != nullptr)
+        {
+            return rect->border_radius.top_left_right_bottom;
+        }
+        break;
+    }
+
+    throw core::Exception { "The renderer has no component with the animated property" };
+}
+}
@@ -0,0 +1,280 @@
+#include "canvas/damage_tracker.hpp"
+
+#include "canvas/components/render_bounds.hpp"
+#include "canvas/components/render_clip.hpp"
+#include "canvas/components/render_order.hpp"
+#include "canvas/components/render_texture.hpp"
+#include "canvas/components/render_translation.hpp"
+#include "canvas/components/renderable_rect.hpp"
+#include "canvas/components/renderable_text.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace division_engine::canvas
+{
+using namespace components;
+
+namespace
+{
+uint32_t entity_index(flecs::entity_t entity)
+{
+    return static_cast<uint32_t>(entity);
+}
+}
+
+DamageTracker::~DamageTracker()
+{
+    for (auto& system : _systems)
+    {
+        system.destruct();
+    }
+
+    for (auto& observer : _observers)
+    {
+        observer.destruct();
+    }
+}
+
+void DamageTracker::observe(
+    flecs::world& world,
+    flecs::entity render_phase,
+    const ScrollTranslations& translations
+)
+{
+    _translations = &translations;
+
+    // Only the tables written since the last frame are visited. The clips are
+    // inside of the damaged rects, they only mark the tables as written
+    _systems.push_back(
+        world
+            .system<
+                const RenderOrder,
+                const RenderBounds,
+                const RenderClip*,
+                const RenderTranslation*>()
+            .term<const RenderableRect>()
+            .optional()
+            .in()
+            .term<const RenderableText>()
+            .optional()
+            .in()
+            .kind(render_phase)
+            .iter(
+                [this](
+                    flecs::iter& it,
+                    const RenderOrder* orders,
+                    const RenderBounds* bounds,
+                    const RenderClip*,
+                    const RenderTranslation* translations
+                )
+                {
+                    if (!it.changed())
+                    {
+                        return;
+                    }
+
+                    for (const auto i : it)
+                    {
+                        if (orders[i].is_idle())
+                        {
+                            continue;
+                        }
+
+                        track(
+                            it.entity(i),
+                            damaged_rect(
+                                bounds[i].value,
+                                translations != nullptr ? &translations[i] : nullptr
+                            )
+                        );
+                    }
+                }
+            )
+    );
+
+    _observers.push_back(world.observer<const RenderOrder, const RenderBounds>()
+                             .event(flecs::OnSet)
+                             .each(
+                                 [this](
+                                     flecs::entity entity,
+                                     const RenderOrder& order,
+                                     const RenderBounds& bounds
+                                 )
+                                 {
+                                     if (order.is_idle())
+                                     {
+                                         untrack(entity);
+                                         return;
+                                     }
+
+                                     track(
+                                         entity,
+                                         damaged_rect(
+                                             bounds.value,
+                                             entity.get<RenderTranslation>()
+                                         )
+                                     );
+                                 }
+                             ));
+
+    // Removing the order hides a renderer as well, like the idle order does
+    _observers.push_back(world.observer<const RenderOrder, const RenderBounds>()
+                             .event(flecs::OnRemove)
+                             .each(
+                                 [this](
+                                     flecs::entity entity,
+                                     const RenderOrder&,
+                                     const RenderBounds&
+                                 ) { untrack(entity); }
+                             ));
+
+    // Batch textures are shared by any number of renderers
+    _observers.push_back(world.observer<const RenderTexture>()
+                             .event(flecs::OnSet)
+                             .each([this](flecs::entity, const RenderTexture&)
+                                   { invalidate(); }));
+}
+
+void DamageTracker::add(const Rect& rect)
+{
+    if (_full)
+    {
+        return;
+    }
+
+    for (auto& region : _regions)
+    {
+        if (region.intersects(rect))
+        {
+            region = region.united(rect);
+            return;
+        }
+    }
+
+    if (_regions.size() < MAX_REGIONS)
+    {
+        _regions.push_back(rect);
+        return;
+    }
+
+    // The rect is merged into the region that grows the least
+    auto best_region = _regions.begin();
+    auto best_growth = std::numeric_limits<float>::max();
+    for (auto it = _regions.begin(); it != _regions.end(); it++)
+    {
+        const auto growth = it->united(rect).area() - it->area();
+        if (growth < best_growth)
+        {
+            best_growth = growth;
+            best_region = it;
+        }
+    }
+
+    *best_region = best_region->united(rect);
+}
+
+void DamageTracker::add_immediate(const ImmediateDrawList& immediate)
+{
+    for (const auto& bounds : _immediate_bounds)
+    {
+        add(bounds);
+    }
+
+    _immediate_bounds.clear();
+    for (const auto& item : immediate.rects())
+    {
+        _immediate_bounds.push_back(item.bounds);
+    }
+    for (const auto& item : immediate.texts())
+    {
+        _immediate_bounds.push_back(item.bounds);
+    }
+
+    for (const auto& bounds : _immediate_bounds)
+    {
+        add(bounds);
+    }
+}
+
+void DamageTracker::resolve(glm::vec2 screen_size)
+{
+    if (_full)
+    {
+        return;
+    }
+
+    // Grown regions may overlap, and an overlap would be drawn twice
+    auto merged = true;
+    while (merged)
+    {
+        merged = false;
+        for (size_t i = 0; i < _regions.size() && !merged; i++)
+        {
+            for (size_t k = i + 1; k < _regions.size(); k++)
+            {
+                if (_regions[i].intersects(_regions[k]))
+                {
+                    _regions[i] = _regions[i].united(_regions[k]);
+                    _regions.erase(_regions.begin() + static_cast<ptrdiff_t>(k));
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+
+    float damaged_area = 0;
+    for (const auto& region : _regions)
+    {
+        damaged_area += region.area();
+    }
+
+    _full = damaged_area > screen_size.x * screen_size.y * FULL_REDRAW_AREA_RATIO;
+}
+
+void DamageTracker::clear()
+{
+    _regions.clear();
+    _full = false;
+}
+
+const Rect& DamageTracker::damaged_rect(
+    const Rect& bounds,
+    const RenderTranslation* translation
+) const
+{
+    return translation != nullptr ? _translations->viewport(translation->index)
+                                  : bounds;
+}
+
+void DamageTracker::track(flecs::entity_t entity, const Rect& bounds)
+{
+    const auto index = entity_index(entity);
+    if (index >= _tracked.size())
+    {
+        _tracked.resize(index + 1, TrackedBounds { .entity = 0 });
+    }
+
+    auto& tracked = _tracked[index];
+    if (tracked.entity == entity)
+    {
+        add(tracked.bounds);
+    }
+
+    add(bounds);
+    tracked = TrackedBounds { .entity = entity, .bounds = bounds };
+}
+
+void DamageTracker::untrack(flecs::entity_t entity)
+{
+    const auto index = entity_index(entity);
+    if (index >= _tracked.size() || _tracked[index].entity != entity)
+    {
+        return;
+    }
+
+    add(_tracked[index].bounds);
+    _tracked[index].entity = 0;
+}
+}
@@ -0,0 +1,363 @@
+#include "canvas/flat_layout.hpp"
+
+#include "canvas/clip_stack.hpp"
+#include "canvas/components/render_bounds.hpp"
+
+#include <glm/common.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+
+namespace division_engine::canvas
+{
+namespace
+{
+constexpr float UNCONSTRAINTED = std::numeric_limits<float>::infinity();
+
+float& main_axis(glm::vec2& v, bool vertical) { return vertical ? v.y : v.x; }
+
+float& cross_axis(glm::vec2& v, bool vertical) { return vertical ? v.x : v.y; }
+}
+
+void FlatLayout::clear()
+{
+    _kinds.clear();
+    _parents.clear();
+    _subtree_ends.clear();
+    _child_counts.clear();
+    _params.clear();
+    _entities.clear();
+}
+
+uint32_t FlatLayout::push(
+    NodeKind kind,
+    uint32_t parent,
+    const glm::vec4& params,
+    flecs::entity_t entity
+)
+{
+    const auto node = static_cast<uint32_t>(_kinds.size());
+
+    _kinds.push_back(kind);
+    _parents.push_back(parent);
+    _subtree_ends.push_back(node + 1);
+    _child_counts.push_back(0);
+    _params.push_back(params);
+    _entities.push_back(entity);
+
+    if (parent != NO_PARENT)
+    {
+        _child_counts[parent]++;
+    }
+
+    return node;
+}
+
+void FlatLayout::end(uint32_t node)
+{
+    _subtree_ends[node] = static_cast<uint32_t>(_kinds.size());
+}
+
+void FlatLayout::solve(const Rect& root_rect, core::TaskPool* task_pool)
+{
+    const auto node_count = static_cast<uint32_t>(_kinds.size());
+    if (node_count == 0)
+    {
+        return;
+    }
+
+    _sizes.resize(node_count);
+    _rects.resize(node_count);
+    _clips.resize(node_count);
+    _clipped.resize(node_count);
+    _rects[0] = root_rect;
+
+    const auto thread_count = task_pool != nullptr ? task_pool->thread_count() : 1;
+    if (thread_count == 1 || node_count < 2 * MIN_TASK_NODES)
+    {
+        // Children follow their parents, so they are measured first and get
+        // their rects after the parents
+        for (auto node = node_count; node-- > 0;)
+        {
+            measure(node);
+        }
+        for (uint32_t node = 0; node < node_count; node++)
+        {
+            place(node);
+        }
+        return;
+    }
+
+    split_tasks(std::max(
+        MIN_TASK_NODES,
+        static_cast<uint32_t>(node_count / (thread_count * TASKS_PER_THREAD))
+    ));
+
+    task_pool->parallel_for(
+        _task_roots.size(),
+        [this](size_t task)
+        {
+            const auto root = _task_roots[task];
+            for (auto node = _subtree_ends[root]; node-- > root;)
+            {
+                measure(node);
+            }
+        }
+    );
+
+    for (auto it = _spine.rbegin(); it != _spine.rend(); ++it)
+    {
+        measure(*it);
+    }
+    for (const auto node : _spine)
+    {
+        place(node);
+    }
+
+    task_pool->parallel_for(
+        _task_roots.size(),
+        [this](size_t task)
+        {
+            const auto root = _task_roots[task];
+            for (auto node = root; node < _subtree_ends[root]; node++)
+            {
+                place(node);
+            }
+        }
+    );
+}
+
+void FlatLayout::split_tasks(uint32_t grain)
+{
+    _task_roots.clear();
+    _spine.clear();
+
+    const auto node_count = static_cast<uint32_t>(_kinds.size());
+    for (uint32_t node = 0; node < node_count;)
+    {
+        const auto subtree_end = _subtree_ends[node];
+        const auto subtree_size = subtree_end - node;
+
+        if (node != 0 && subtree_size < MIN_TASK_NODES)
+        {
+            for (; node < subtree_end; node++)
+            {
+                _spine.push_back(node);
+            }
+        }
+        else if (node != 0 && subtree_size <= grain)
+        {
+            _task_roots.push_back(node);
+            node = subtree_end;
+        }
+        else
+        {
+            // Too large for a single task, its children are split instead
+            _spine.push_back(node);
+            node++;
+        }
+    }
+}
+
+void FlatLayout::measure(uint32_t node)
+{
+    const auto& params = _params[node];
+    switch (_kinds[node])
+    {
+        case NodeKind::SizedBox:
+            _sizes[node] = glm::max(glm::vec2 { params.x, params.y }, glm::vec2 { 0 });
+            break;
+        case NodeKind::Padding:
+        case NodeKind::Clip:
+        {
+            if (_child_counts[node] == 0)
+            {
+                _sizes[node] = glm::vec2 { UNCONSTRAINTED };
+                break;
+            }
+
+            const glm::vec2 padded { params.z + params.w, params.x + params.y };
+            const auto padding =
+                _kinds[node] == NodeKind::Padding ? padded : glm::vec2 { 0 };
+            // Unconstrainted sizes stay infinite
+            _sizes[node] = _sizes[node + 1] + padding;
+            break;
+        }
+        default:
+            // Leaves, stacks and lists fill the rect they are given
+            _sizes[node] = glm::vec2 { UNCONSTRAINTED };
+            break;
+    }
+}
+
+void FlatLayout::place(uint32_t node)
+{
+    const auto parent = _parents[node];
+    _clipped[node] = parent != NO_PARENT && _clipped[parent];
+    if (_clipped[node])
+    {
+        _clips[node] = _clips[parent];
+    }
+
+    const auto& rect = _rects[node];
+    switch (_kinds[node])
+    {
+        case NodeKind::Leaf:
+            break;
+        case NodeKind::Clip:
+            _clips[node] = _clipped[node] ? _clips[node].intersected(rect) : rect;
+            _clipped[node] = 1;
+            [[fallthrough]];
+        case NodeKind::SizedBox:
+        case NodeKind::Stack:
+        {
+            for (auto child = node + 1; child < _subtree_ends[node];
+                 child = _subtree_ends[child])
+            {
+                _rects[child] = rect;
+            }
+            break;
+        }
+        case NodeKind::Padding:
+        {
+            if (_child_counts[node] == 0)
+            {
+                break;
+            }
+
+            const auto& insets = _params[node];
+            const auto size = rect.size();
+            _rects[node + 1] = Rect::from_bottom_left(
+                glm::vec2 { rect.left() + insets.z, rect.bottom() + insets.y },
+                glm::vec2 {
+                    size.x - (insets.z + insets.w),
+                    size.y - (insets.y + insets.x),
+                }
+            );
+            break;
+        }
+        case NodeKind::HorizontalList:
+            place_list(node, false);
+            break;
+        case NodeKind::VerticalList:
+            place_list(node, true);
+            break;
+        case NodeKind::VirtualList:
+            _clips[node] = _clipped[node] ? _clips[node].intersected(rect) : rect;
+            _clipped[node] = 1;
+            place_virtual_list(node);
+            break;
+    }
+}
+
+void FlatLayout::place_list(uint32_t node, bool vertical)
+{
+    const auto& rect = _rects[node];
+    auto rect_size = rect.size();
+
+    // Fixed size children take their size, clamped by the space left, and the
+    // others share the rest
+    auto available_size = rect_size;
+    size_t filled_count = 0;
+    for (auto child = node + 1; child < _subtree_ends[node]; child = _subtree_ends[child])
+    {
+        auto& child_size = _sizes[child];
+        child_size = glm::min(child_size, glm::max(available_size, glm::vec2 { 0 }));
+        if (std::isinf(main_axis(child_size, vertical)))
+        {
+            filled_count++;
+            continue;
+        }
+
+        main_axis(available_size, vertical) -= main_axis(child_size, vertical);
+    }
+
+    const auto filled_extent =
+        filled_count > 0
+            ? main_axis(available_size, vertical) / static_cast<float>(filled_count)
+            : 0;
+
+    float offset = 0;
+    for (auto child = node + 1; child < _subtree_ends[node]; child = _subtree_ends[child])
+    {
+        auto child_size = _sizes[child];
+        if (std::isinf(main_axis(child_size, vertical)))
+        {
+            main_axis(child_size, vertical) = filled_extent;
+        }
+        if (std::isinf(cross_axis(child_size, vertical)))
+        {
+            cross_axis(child_size, vertical) = cross_axis(rect_size, vertical);
+        }
+
+        const auto top_left = vertical ? glm::vec2 { rect.left(), rect.top() - offset }
+                                       : glm::vec2 { rect.left() + offset, rect.top() };
+        _rects[child] = Rect::from_top_left(top_left, child_size);
+        offset += main_axis(child_size, vertical);
+    }
+}
+
+void FlatLayout::place_virtual_list(uint32_t node)
+{
+    const auto& rect = _rects[node];
+    auto rect_size = rect.size();
+    const auto vertical = _params[node].x != 0;
+
+    // The children have their extents along the list and fill it across
+    auto offset = _params[node].y;
+    for (auto child = node + 1; child < _subtree_ends[node]; child = _subtree_ends[child])
+    {
+        auto child_size = _sizes[child];
+        if (std::isinf(main_axis(child_size, vertical)))
+        {
+            main_axis(child_size, vertical) = 0;
+        }
+        if (std::isinf(cross_axis(child_size, vertical)))
+        {
+            cross_axis(child_size, vertical) = cross_axis(rect_size, vertical);
+        }
+
+        const auto top_left = vertical ? glm::vec2 { rect.left(), rect.top() - offset }
+                                       : glm::vec2 { rect.left() + offset, rect.top() };
+        _rects[child] = Rect::from_top_left(top_left, child_size);
+        offset += main_axis(child_size, vertical);
+    }
+}
+
+void FlatLayout::apply(flecs::world& world)
+{
+    using components::RenderBounds;
+
+    _applied_entities.resize(_kinds.size(), 0);
+    _applied_rects.resize(_kinds.size());
+
+    world.defer_begin();
+    for (uint32_t node = 0; node < _kinds.size(); node++)
+    {
+        if (_kinds[node] != NodeKind::Leaf || _entities[node] == 0)
+        {
+            continue;
+        }
+
+        const flecs::entity entity { world, _entities[node] };
+        if (_applied_entities[node] != _entities[node] ||
+            _applied_rects[node] != _rects[node])
+        {
+            _applied_entities[node] = _entities[node];
+            _applied_rects[node] = _rects[node];
+
+            const auto* bounds = entity.get<RenderBounds>();
+            if (bounds == nullptr || bounds->value != _rects[node])
+            {
+                entity.set(RenderBounds { _rects[node] });
+            }
+        }
+
+        ClipStack::set_clip(
+            entity, _clipped[node] ? std::optional { _clips[node] } : std::nullopt
+        );
+    }
+    world.defer_end();
+}
+}
@@ -0,0 +1,527 @@
+#include "canvas/hit_index.hpp"
+
+#include "canvas/components/pointer_handler.hpp"
+#include "canvas/components/render_bounds.hpp"
+#include "canvas/components/render_clip.hpp"
+#include "canvas/components/render_order.hpp"
+#include "canvas/components/render_translation.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace division_engine::canvas
+{
+using namespace components;
+
+namespace
+{
+// Cells far enough to overflow the key are merged into the border ones
+constexpr float MAX_CELL_COORD = 1 << 30;
+
+uint32_t entity_index(flecs::entity_t entity)
+{
+    return static_cast<uint32_t>(entity);
+}
+
+bool is_finite(const Rect& rect)
+{
+    return std::isfinite(rect.left()) && std::isfinite(rect.right()) &&
+           std::isfinite(rect.bottom()) && std::isfinite(rect.top());
+}
+
+void erase_index(std::vector<uint32_t>& indices, uint32_t index)
+{
+    const auto it = std::ranges::find(indices, index);
+    if (it != indices.end())
+    {
+        *it = indices.back();
+        indices.pop_back();
+    }
+}
+}
+
+HitIndex::~HitIndex()
+{
+    for (auto& system : _systems)
+    {
+        system.destruct();
+    }
+
+    for (auto& observer : _observers)
+    {
+        observer.destruct();
+    }
+}
+
+void HitIndex::observe(
+    flecs::world& world,
+    flecs::entity render_phase,
+    const ScrollTranslations& translations
+)
+{
+    _translations = &translations;
+
+    // The bounds written in place don't emit OnSet, so the renderers of the
+    // tables written since the last frame are reindexed
+    _systems.push_back(
+        world.system<const RenderOrder, const RenderBounds>()
+            .kind(render_phase)
+            .iter(
+                [this](
+                    flecs::iter& it,
+                    const RenderOrder* orders,
+                    const RenderBounds* bounds
+                )
+                {
+                    if (!it.changed())
+                    {
+                        return;
+                    }
+
+                    for (const auto i : it)
+                    {
+                        if (!orders[i].is_idle())
+                        {
+                            move(it.entity(i), bounds[i].value, orders[i].sort_key());
+                        }
+                    }
+                }
+            )
+    );
+
+    _systems.push_back(world.system()
+                           .kind(render_phase)
+                           .iter([this](flecs::iter&) { adapt_cell_size(); }));
+
+    // Setting the order moves a renderer between the others, so it is
+    // reindexed like a change of the bounds
+    _observers.push_back(world.observer<const RenderOrder, const RenderBounds>()
+                             .event(flecs::OnSet)
+                             .each(
+                                 [this](
+                                     flecs::entity entity,
+                                     const RenderOrder& order,
+                                     const RenderBounds& bounds
+                                 )
+                                 {
+                                     if (order.is_idle())
+                                     {
+                                         remove(entity);
+                                         return;
+                                     }
+
+                                     insert(entity, bounds.value, order.sort_key());
+
+                                     const auto* clip = entity.get<RenderClip>();
+                                     set_clip(
+                                         entity,
+                                         clip != nullptr ? std::optional { clip->value }
+                                                         : std::nullopt
+                                     );
+
+                                     const auto* translation =
+                                         entity.get<RenderTranslation>();
+                                     set_translation(
+                                         entity,
+                                         translation != nullptr
+                                             ? translation->index
+                                             : ScrollTranslations::NO_TRANSLATION
+                                     );
+                                 }
+                             ));
+
+    // Removing the order hides a renderer as well, like the idle order does
+    _observers.push_back(world.observer<const RenderOrder, const RenderBounds>()
+                             .event(flecs::OnRemove)
+                             .each(
+                                 [this](
+                                     flecs::entity entity,
+                                     const RenderOrder&,
+                                     const RenderBounds&
+                                 ) { remove(entity); }
+                             ));
+
+    _observers.push_back(world.observer<const RenderClip>()
+                             .event(flecs::OnSet)
+                             .each([this](flecs::entity entity, const RenderClip& clip)
+                                   { set_clip(entity, clip.value); }));
+
+    _observers.push_back(world.observer<const RenderClip>()
+                             .event(flecs::OnRemove)
+                             .each([this](flecs::entity entity, const RenderClip&)
+                                   { set_clip(entity, std::nullopt); }));
+
+    _observers.push_back(
+        world.observer<const RenderTranslation>()
+            .event(flecs::OnSet)
+            .each([this](flecs::entity entity, const RenderTranslation& translation)
+                  { set_translation(entity, translation.index); })
+    );
+
+    _observers.push_back(
+        world.observer<const RenderTranslation>()
+            .event(flecs::OnRemove)
+            .each(
+                [this](flecs::entity entity, const RenderTranslation&)
+                { set_translation(entity, ScrollTranslations::NO_TRANSLATION); }
+            )
+    );
+}
+
+std::optional<flecs::entity_t> HitIndex::topmost(glm::vec2 point) const
+{
+    std::optional<flecs::entity_t> hit;
+    uint64_t hit_order = 0;
+
+    const auto scroll_offset = [this](uint32_t translation)
+    {
+        return translation != ScrollTranslations::NO_TRANSLATION
+                   ? _translations->offset(translation)
+                   : glm::vec2 { 0 };
+    };
+
+    const auto visit = [&](uint32_t index, uint32_t translation)
+    {
+        const auto& entry = _entries[index];
+        if (entry.translation != translation ||
+            (hit.has_value() && entry.order <= hit_order))
+        {
+            return;
+        }
+
+        // The scrolled renderers are cut by the viewport on the screen
+        if (translation != ScrollTranslations::NO_TRANSLATION &&
+            !_translations->viewport(translation).contains(point))
+        {
+            return;
+        }
+
+        if (hits(entry, point - scroll_offset(translation)))
+        {
+            hit = entry.entity;
+            hit_order = entry.order;
+        }
+    };
+
+    const auto visit_cell =
+        [&](const Cells& cells, float cell_size, uint32_t translation)
+    {
+        const auto content_point = point - scroll_offset(translation);
+
+        const auto cell_it = cells.find(cell_key(
+            static_cast<int32_t>(cell_coord(content_point.x, cell_size)),
+            static_cast<int32_t>(cell_coord(content_point.y, cell_size))
+        ));
+        if (cell_it == cells.end())
+        {
+            return;
+        }
+
+        for (const auto index : cell_it->second)
+        {
+            visit(index, translation);
+        }
+    };
+
+    const auto coarse_cell_size = _cell_size * COARSE_CELL_RATIO;
+    const auto visit_cells = [&](uint32_t translation)
+    {
+        visit_cell(_cells, _cell_size, translation);
+        visit_cell(_coarse_cells, coarse_cell_size, translation);
+    };
+
+    visit_cells(ScrollTranslations::NO_TRANSLATION);
+    if (_translations != nullptr)
+    {
+        std::ranges::for_each(_translations->active(), visit_cells);
+    }
+
+    for (const auto index : _unbounded)
+    {
+        visit(index, _entries[index].translation);
+    }
+
+    return hit;
+}
+
+bool HitIndex::dispatch(flecs::world& world, const core::InputEvent& event) const
+{
+    const auto hit = topmost(event.position);
+    if (!hit.has_value())
+    {
+        return false;
+    }
+
+    const flecs::entity entity { world, *hit };
+    const auto* handler = entity.get<PointerHandler>();
+    if (handler == nullptr || !handler->on_event)
+    {
+        return false;
+    }
+
+    handler->on_event(entity, event);
+    return true;
+}
+
+void HitIndex::insert(flecs::entity_t entity, const Rect& bounds, uint64_t order)
+{
+    const auto index = entity_index(entity);
+    if (index >= _entries.size())
+    {
+        _entries.resize(index + 1, Entry { .entity = 0 });
+    }
+
+    auto& entry = _entries[index];
+    if (entry.entity != 0)
+    {
+        unlink(index);
+        remove_stats(entry.bounds);
+    }
+    else
+    {
+        _size++;
+    }
+
+    if (entry.entity != entity)
+    {
+        entry.clipped = false;
+        entry.translation = ScrollTranslations::NO_TRANSLATION;
+    }
+
+    entry.entity = entity;
+    entry.bounds = bounds;
+    entry.order = order;
+    add_stats(bounds);
+    link(index);
+}
+
+void HitIndex::move(flecs::entity_t entity, const Rect& bounds, uint64_t order)
+{
+    const auto index = entity_index(entity);
+    if (index >= _entries.size() || _entries[index].entity != entity)
+    {
+        return;
+    }
+
+    const auto& entry = _entries[index];
+    if (entry.bounds != bounds || entry.order != order)
+    {
+        insert(entity, bounds, order);
+    }
+}
+
+void HitIndex::remove(flecs::entity_t entity)
+{
+    const auto index = entity_index(entity);
+    if (index >= _entries.size() || _entries[index].entity != entity)
+    {
+        return;
+    }
+
+    unlink(index);
+    remove_stats(_entries[index].bounds);
+    _entries[index].entity = 0;
+    _size--;
+}
+
+void HitIndex::adapt_cell_size()
+{
+    const auto preferred = preferred_cell_size();
+    if (preferred > _cell_size * REBUILD_RATIO || preferred * REBUILD_RATIO < _cell_size)
+    {
+        rebuild(preferred);
+    }
+}
+
+void HitIndex::set_clip(flecs::entity_t entity, const std::optional<Rect>& clip)
+{
+    const auto index = entity_index(entity);
+    if (index >= _entries.size() || _entries[index].entity != entity)
+    {
+        return;
+    }
+
+    auto& entry = _entries[index];
+    entry.clipped = clip.has_value();
+    if (clip.has_value())
+    {
+        entry.clip = *clip;
+    }
+}
+
+void HitIndex::set_translation(flecs::entity_t entity, uint32_t translation)
+{
+    const auto index = entity_index(entity);
+    if (index >= _entries.size() || _entries[index].entity != entity)
+    {
+        return;
+    }
+
+    // The cells are taken from the unscrolled bounds, so they are kept
+    _entries[index].translation = translation;
+}
+
+void HitIndex::link(uint32_t index)
+{
+    auto& entry = _entries[index];
+
+    auto cells = cell_range(entry.bounds, _cell_size);
+    entry.level = Level::Fine;
+    if (!cells.has_value())
+    {
+        cells = cell_range(entry.bounds, _cell_size * COARSE_CELL_RATIO);
+        entry.level = Level::Coarse;
+    }
+
+    if (!cells.has_value())
+    {
+        entry.level = Level::Unbounded;
+        _unbounded.push_back(index);
+        return;
+    }
+
+    entry.cells = *cells;
+    auto& level_cells = entry.level == Level::Fine ? _cells : _coarse_cells;
+    for (auto y = entry.cells.min.y; y <= entry.cells.max.y; y++)
+    {
+        for (auto x = entry.cells.min.x; x <= entry.cells.max.x; x++)
+        {
+            level_cells[cell_key(x, y)].push_back(index);
+        }
+    }
+}
+
+void HitIndex::unlink(uint32_t index)
+{
+    const auto& entry = _entries[index];
+    if (entry.level == Level::Unbounded)
+    {
+        erase_index(_unbounded, index);
+        return;
+    }
+
+    auto& level_cells = entry.level == Level::Fine ? _cells : _coarse_cells;
+    for (auto y = entry.cells.min.y; y <= entry.cells.max.y; y++)
+    {
+        for (auto x = entry.cells.min.x; x <= entry.cells.max.x; x++)
+        {
+            const auto it = level_cells.find(cell_key(x, y));
+            if (it == level_cells.end())
+            {
+                continue;
+            }
+
+            erase_index(it->second, index);
+            if (it->second.empty())
+            {
+                level_cells.erase(it);
+            }
+        }
+    }
+}
+
+void HitIndex::rebuild(float cell_size)
+{
+    _cell_size = cell_size;
+    _cells.clear();
+    _coarse_cells.clear();
+    _unbounded.clear();
+    _covered.reset();
+
+    for (uint32_t index = 0; index < _entries.size(); index++)
+    {
+        const auto& entry = _entries[index];
+        if (entry.entity == 0)
+        {
+            continue;
+        }
+
+        if (is_finite(entry.bounds))
+        {
+            _covered = _covered.has_value() ? _covered->united(entry.bounds)
+                                            : entry.bounds;
+        }
+        link(index);
+    }
+}
+
+void HitIndex::add_stats(const Rect& bounds)
+{
+    if (!is_finite(bounds))
+    {
+        return;
+    }
+
+    _sized_count++;
+    _size_sum += bounds.size();
+    _covered = _covered.has_value() ? _covered->united(bounds) : bounds;
+}
+
+void HitIndex::remove_stats(const Rect& bounds)
+{
+    if (!is_finite(bounds))
+    {
+        return;
+    }
+
+    _sized_count--;
+    _size_sum -= bounds.size();
+}
+
+float HitIndex::preferred_cell_size() const
+{
+    if (_sized_count == 0 || !_covered.has_value())
+    {
+        return _cell_size;
+    }
+
+    const auto count = static_cast<float>(_sized_count);
+    const auto mean_size = _size_sum / count;
+    const auto count_cell_size = std::sqrt(_covered->area() * RENDERERS_PER_CELL / count);
+
+    return std::clamp(
+        std::max({ count_cell_size, mean_size.x, mean_size.y }),
+        MIN_CELL_SIZE,
+        MAX_CELL_SIZE
+    );
+}
+
+std::optional<HitIndex::CellRange>
+HitIndex::cell_range(const Rect& bounds, float cell_size)
+{
+    const auto min_x = cell_coord(bounds.left(), cell_size);
+    const auto min_y = cell_coord(bounds.bottom(), cell_size);
+    const auto max_x = cell_coord(bounds.right(), cell_size);
+    const auto max_y = cell_coord(bounds.top(), cell_size);
+
+    // Also true for the NaN bounds
+    const auto cell_count = (max_x - min_x + 1) * (max_y - min_y + 1);
+    if (!(cell_count <= static_cast<float>(MAX_CELLS_PER_RENDERER)))
+    {
+        return std::nullopt;
+    }
+
+    return CellRange {
+        .min = glm::ivec2 { static_cast<int32_t>(min_x), static_cast<int32_t>(min_y) },
+        .max = glm::ivec2 { static_cast<int32_t>(max_x), static_cast<int32_t>(max_y) },
+    };
+}
+
+float HitIndex::cell_coord(float value, float cell_size)
+{
+    const auto coord = std::floor(value / cell_size);
+    return std::clamp(coord, -MAX_CELL_COORD, MAX_CELL_COORD);
+}
+
+bool HitIndex::hits(const Entry& entry, glm::vec2 content_point)
+{
+    return entry.bounds.contains(content_point) &&
+           (!entry.clipped || entry.clip.contains(content_point));
+}
+
+uint64_t HitIndex::cell_key(int32_t x, int32_t y)
+{
+    return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) |
+           static_cast<uint64_t>(static_cast<uint32_t>(y));
+}
+}
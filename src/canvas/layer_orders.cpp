@@ -0,0 +1,115 @@
+#include "canvas/layer_orders.hpp"
+
+#include <iterator>
+#include <limits>
+
+namespace division_engine::canvas
+{
+using components::RenderOrder;
+
+namespace
+{
+const LayerOrders::Layer EMPTY_LAYER {};
+}
+
+LayerOrders::~LayerOrders()
+{
+    for (auto& observer : _observers)
+    {
+        observer.destruct();
+    }
+}
+
+void LayerOrders::observe(flecs::world& world)
+{
+    // Only the renderers own an order, the batches they inherit from don't
+    _observers.push_back(world.observer<const RenderOrder>()
+                             .term_at(1)
+                             .self()
+                             .event(flecs::OnSet)
+                             .yield_existing()
+                             .each([this](flecs::entity entity, const RenderOrder& order)
+                                   { upsert(entity, order); }));
+
+    _observers.push_back(world.observer<const RenderOrder>()
+                             .term_at(1)
+                             .self()
+                             .event(flecs::OnRemove)
+                             .each([this](flecs::entity entity, const RenderOrder&)
+                                   { remove(entity); }));
+}
+
+void LayerOrders::upsert(flecs::entity_t entity, const RenderOrder& order)
+{
+    remove(entity);
+    if (order.is_idle())
+    {
+        return;
+    }
+
+    const auto index = entity_index(entity);
+    if (index >= _slots.size())
+    {
+        _slots.resize(index + 1, Slot { .entity = 0, .order = {} });
+    }
+
+    _slots[index] = Slot { .entity = entity, .order = order };
+    _layers[order.layer].emplace(order.order, entity);
+}
+
+void LayerOrders::remove(flecs::entity_t entity)
+{
+    const auto index = entity_index(entity);
+    if (index >= _slots.size() || _slots[index].entity != entity)
+    {
+        return;
+    }
+
+    auto& slot = _slots[index];
+    _layers[slot.order.layer].erase(Entry { slot.order.order, entity });
+    slot.entity = 0;
+}
+
+const LayerOrders::Layer& LayerOrders::layer(uint32_t layer) const
+{
+    const auto it = _layers.find(layer);
+    return it != _layers.end() ? it->second : EMPTY_LAYER;
+}
+
+LayerOrders::Layer::const_iterator
+LayerOrders::below(uint32_t layer, uint32_t order, flecs::entity_t except) const
+{
+    const auto& renderers = this->layer(layer);
+
+    auto it = renderers.lower_bound(Entry { order, 0 });
+    while (it != renderers.begin())
+    {
+        it = std::prev(it);
+        if (it->second != except)
+        {
+            return it;
+        }
+    }
+
+    return renderers.end();
+}
+
+LayerOrders::Layer::const_iterator
+LayerOrders::above(uint32_t layer, uint32_t order) const
+{
+    const auto& renderers = this->layer(layer);
+    return renderers.upper_bound(
+        Entry { order, std::numeric_limits<flecs::entity_t>::max() }
+    );
+}
+
+size_t LayerOrders::size() const
+{
+    size_t size = 0;
+    for (const auto& [_, renderers] : _layers)
+    {
+        size += renderers.size();
+    }
+    return size;
+}
+}
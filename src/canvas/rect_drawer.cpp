@@ -15,6 +15,7 @@
 #include <algorithm>
 #include <filesystem>
 #include <iterator>
+#include <utility>
 
 #include <ranges>
 #include <vector>
@@ -23,15 +24,52 @@ namespace division_engine::canvas
 {
 using namespace components;
 
+namespace
+{
+template<typename TBuilder>
+decltype(auto) with_rect_terms(TBuilder&& builder)
+{
+    return builder.template term<RenderBatch>()
+        .up(flecs::IsA)
+        .template term<RenderTexture>()
+        .up(flecs::IsA)
+        .template with<RenderOrder>()
+        .instanced();
+}
+
+template<typename TBuilder>
+decltype(auto) with_rect_observer_terms(TBuilder&& builder)
+{
+    return builder.template term<const RenderBounds>()
+        .filter()
+        .template term<const RenderableRect>()
+        .filter()
+        .template term<RenderBatch>()
+        .up(flecs::IsA)
+        .filter()
+        .template term<RenderTexture>()
+        .up(flecs::IsA)
+        .filter();
+}
+}
+
 RectDrawer::RectDrawer(State& state, size_t rect_capacity)
   : _texture_bindings({ DivisionIdWithBinding {
         .id = state.white_texture_id,
         .shader_location = TEXTURE_LOCATION,
     } })
+  , _render_queue(state.render_queue)
+  , _scroll_translations(state.scroll_translations)
   , _ctx(state.context)
-  , _screen_size_uniform(DivisionIdWithBinding {
-        .id = state.screen_size_uniform_id,
-        .shader_location = SCREEN_SIZE_UNIFORM_LOCATION,
+  , _uniforms({
+        DivisionIdWithBinding {
+            .id = state.screen_size_uniform_id,
+            .shader_location = SCREEN_SIZE_UNIFORM_LOCATION,
+        },
+        DivisionIdWithBinding {
+            .id = state.scroll_translations.uniform_id(),
+            .shader_location = ScrollTranslations::UNIFORM_LOCATION,
+        },
     })
   , _vertex_buffer_id(make_vertex_buffer(_ctx, rect_capacity))
   , _instance_capacity(rect_capacity)
@@ -53,112 +91,379 @@ RectDrawer::RectDrawer(State& state, size_t rect_capacity)
                 DIVISION_ALPHA_BLEND_OP_ADD
             )
             .build();
-
-    _query =
-        state.world
-            .query_builder<
-                const RenderBounds,
-                const RenderableRect,
-                const RenderOrder,
-                const RenderTexture>()
-            .term<RenderBatch>()
-            .up(flecs::IsA)
-            .term<RenderTexture>()
-            .up(flecs::IsA)
-            .order_by<RenderOrder>(
-                [](auto, const RenderOrder* x, auto, const RenderOrder* y)
-                { return x->compare(*y); }
-            )
-            .instanced()
-            .build();
 }
 
 RectDrawer::~RectDrawer()
 {
+    for (auto& system : _systems)
+    {
+        system.destruct();
+    }
+
+    for (auto& observer : _observers)
+    {
+        observer.destruct();
+    }
+
+    _render_queue.release_passes(this);
+
     _ctx.delete_shader(_shader_id);
     _ctx.delete_vertex_buffer(_vertex_buffer_id);
 }
 
-void RectDrawer::fill_render_queue(State& state)
+void RectDrawer::register_systems(State& state)
 {
-    auto overall_instance_count = 0;
+    _order_index.observe(
+        state.world, [](auto&& builder) { return with_rect_observer_terms(builder); }
+    );
 
-    const auto needed_capacity = _query.count();
-    if (_instance_capacity < needed_capacity)
+    // Batch textures are shared through IsA, which the change detection of
+    // the renderer tables doesn't see
+    _observers.push_back(state.world.observer<const RenderTexture>()
+                             .event(flecs::OnSet)
+                             .each([this](flecs::entity, const RenderTexture&)
+                                   { _textures_changed = true; }));
+
+    _change_query = with_rect_terms(state.world.query_builder<
+                                        const RenderBounds,
+                                        const RenderableRect,
+                                        const RenderTexture,
+                                        const RenderClip*,
+                                        const RenderTranslation*>())
+                        .build();
+
+    _systems.push_back(state.world.system()
+                           .kind(state.render_phase)
+                           .iter([this, &state](flecs::iter&) { reserve_instances(state); }));
+
+    _systems.push_back(
+        with_rect_terms(state.world.system<
+                        const RenderBounds,
+                        const RenderableRect,
+                        const RenderTexture,
+                        const RenderClip*,
+                        const RenderTranslation*>())
+            .kind(state.render_phase)
+            .multi_threaded()
+            .iter(
+                [this](
+                    flecs::iter& it,
+                    const RenderBounds* render_bounds,
+                    const RenderableRect* rects,
+                    const RenderTexture* textures,
+                    const RenderClip* clips,
+                    const RenderTranslation* translations
+                )
+                {
+                    fill_instances(
+                        it, render_bounds, rects, textures, clips, translations
+                    );
+                }
+            )
+    );
+
+    _systems.push_back(state.world.system()
+                           .kind(state.render_phase)
+                           .iter([this, &state](flecs::iter&) { enqueue_passes(state); }));
+}
+
+void RectDrawer::reserve_instances(State& state)
+{
+    const auto order_changed = _order_index.apply_pending();
+    state.immediate.sort();
+
+    // The change state of the tables is read and reset here on the main
+    // thread, the fill workers only look the changed tables up
+    _changed_tables.clear();
+    const auto data_changed = _change_query.changed();
+    if (data_changed)
+    {
+        _change_query.iter(
+            [this](
+                flecs::iter& it,
+                const RenderBounds*,
+                const RenderableRect*,
+                const RenderTexture*,
+                const RenderClip*,
+                const RenderTranslation*
+            )
+            {
+                if (it.changed())
+                {
+                    _changed_tables.insert(it.table().get_table());
+                }
+            }
+        );
+    }
+
+    const auto retained_count = _order_index.size();
+    const auto immediate_rects = state.immediate.rects();
+    const auto instance_count = retained_count + immediate_rects.size();
+
+    auto resized = false;
+    if (_instance_capacity < instance_count)
     {
         _ctx.resize_vertex_buffer(
             _vertex_buffer_id,
             DivisionVertexBufferSize {
                 .vertex_count = RECT_VERTICES.size(),
                 .index_count = RECT_INDICES.size(),
-                .instance_count = static_cast<uint32_t>(needed_capacity) }
+                .instance_count = static_cast<uint32_t>(instance_count) }
         );
-        _instance_capacity = needed_capacity;
+        _instance_capacity = instance_count;
+        resized = true;
     }
 
-    auto data =
-        _ctx.borrow_vertex_buffer_data<RectVertex, RectInstance>(_vertex_buffer_id);
-    auto instances = data.per_instance_data();
+    // The translated instances are culled again when the content scrolled out
+    // of the cull rects
+    const auto translations_changed =
+        _translations_version != _scroll_translations.version();
+    _translations_version = _scroll_translations.version();
 
-    _query.iter(
-        [&](flecs::iter& it,
-            const RenderBounds* render_bounds,
-            const RenderableRect* rects,
-            const RenderOrder* ord_ptr,
-            const RenderTexture* tex_ptr)
+    _refill_all = order_changed || resized || _textures_changed ||
+                  translations_changed || state.screen_size_changed();
+    _retained_dirty = _refill_all || data_changed;
+    _textures_changed = false;
+
+    if (_refill_all)
+    {
+        _slot_textures.assign(retained_count, NO_TEXTURE);
+        _slot_bounds.resize(retained_count);
+    }
+
+    // The instances of the unchanged frames stay in the buffer
+    if (instance_count == 0 || (!_retained_dirty && immediate_rects.empty()))
+    {
+        return;
+    }
+
+    _vertex_buffer_data.emplace(
+        _ctx.borrow_vertex_buffer_data<RectVertex, RectInstance>(_vertex_buffer_id)
+    );
+    _instances = _vertex_buffer_data->per_instance_data();
+
+    for (size_t i = 0; i < immediate_rects.size(); i++)
+    {
+        const auto& item = immediate_rects[i];
+        _instances[retained_count + i] = make_instance(item.bounds, item.rect);
+    }
+}
+
+void RectDrawer::fill_instances(
+    flecs::iter& it,
+    const RenderBounds* render_bounds,
+    const RenderableRect* rects,
+    const RenderTexture* textures,
+    const RenderClip* clips,
+    const RenderTranslation* translations
+)
+{
+    if (!_retained_dirty || _instances.empty() ||
+        !(_refill_all || _changed_tables.contains(it.table().get_table())))
+    {
+        return;
+    }
+
+    // The texture is inherited from the batch, so it is shared by the whole result
+    const auto texture_id = textures->texture_id;
+
+    for (const auto i : it)
+    {
+        const auto slot = _order_index.slot(it.entity(i));
+        if (slot == RenderOrderIndex::NO_SLOT)
         {
-            auto new_texture_binding = DivisionIdWithBinding {
-                .id = tex_ptr->texture_id,
-                .shader_location = TEXTURE_LOCATION,
-            };
-
-            auto insert_pos_iter = utility::algorithm::sorted_insert(
-                _texture_bindings,
-                new_texture_binding,
-                [](const auto& x, const auto& y) { return x.id < y.id; }
-            );
+            continue;
+        }
 
-            const auto texture_index =
-                std::distance(_texture_bindings.begin(), insert_pos_iter);
+        const auto& bounds = render_bounds[i].value;
+        const auto translation_index = translations != nullptr
+                                           ? translations[i].index
+                                           : ScrollTranslations::NO_TRANSLATION;
 
-            const auto first_instance = overall_instance_count;
-            const auto rect_count = it.count();
+        // The bounds and the clips of the scrolled renderers are in the content
+        // space, so they are culled by the content near the viewport, and the
+        // viewport stands for their screen area
+        const auto translated = translation_index != ScrollTranslations::NO_TRANSLATION;
+        const auto visible_rect = _scroll_translations.visible_rect(
+            translation_index, clips != nullptr ? &clips[i].value : nullptr
+        );
+        if (visible_rect.has_value() && !visible_rect->intersects(bounds))
+        {
+            // The culled slots have no texture, so they split the passes
+            _slot_textures[slot] = NO_TEXTURE;
+            continue;
+        }
 
-            auto batch_instances = instances.subspan(first_instance, rect_count);
-            uint32_t order = 0;
+        _instances[slot] = make_instance(
+            bounds,
+            rects[i],
+            clips != nullptr ? clips[i].clip_rect() : RenderClip::NO_CLIP_RECT,
+            translation_index
+        );
+        _slot_textures[slot] = texture_id;
+        _slot_bounds[slot] =
+            translated ? _scroll_translations.viewport(translation_index) : bounds;
+    }
+}
 
-            for (auto i : it)
-            {
-                const auto& rect = rects[i];
-                const auto& bounds = render_bounds[i].value;
+void RectDrawer::enqueue_passes(State& state)
+{
+    const auto entries = _order_index.entries();
+    const auto immediate_rects = state.immediate.rects();
+    const auto split_keys = state.immediate.split_keys();
+    const auto binding_count = _texture_bindings.size();
 
-                batch_instances[i] = RectInstance {
-                    .size = bounds.size(),
-                    .position = glm::vec2 { bounds.left(), bounds.bottom() },
-                    .color = rect.color,
-                    .trbl_border_radius = rect.border_radius.top_left_right_bottom
-                };
+    const auto ranges_changed =
+        _retained_dirty || !std::ranges::equal(split_keys, _split_keys);
+    if (ranges_changed)
+    {
+        build_retained_ranges(split_keys);
+    }
 
-                order = ord_ptr[i].order;
+    _immediate_ranges.clear();
+    for_each_render_run(
+        immediate_rects.size(),
+        split_keys,
+        [&](size_t i) { return immediate_rects[i].order.sort_key(); },
+        [&](size_t i) { return immediate_rects[i].texture_id; },
+        [&](size_t first, size_t last)
+        {
+            const auto& item = immediate_rects[first];
+            auto bounds = item.bounds;
+            for (size_t i = first + 1; i < last; i++)
+            {
+                bounds = bounds.united(immediate_rects[i].bounds);
             }
 
-            overall_instance_count += static_cast<int>(rect_count);
+            add_texture_binding(item.texture_id);
+            _immediate_ranges.push_back(InstanceRange {
+                .first_instance = entries.size() + first,
+                .count = last - first,
+                .texture_id = item.texture_id,
+                .order = item.order,
+                .bounds = bounds,
+            });
+        }
+    );
+
+    // The passes point into the bindings, so all of them are retained again
+    // once a binding is inserted
+    const auto bindings_moved = _texture_bindings.size() != binding_count;
+    if (ranges_changed || bindings_moved)
+    {
+        _retained_layers.commit(
+            state.render_queue,
+            this,
+            bindings_moved,
+            [this](const InstanceRange& range) { return make_render_pass(range); }
+        );
+    }
+
+    _retained_layers.for_each_range([&](const InstanceRange& range)
+                                    { state.texture_manager.touch(range.texture_id); });
+
+    for (const auto& range : _immediate_ranges)
+    {
+        state.texture_manager.touch(range.texture_id);
+        const auto pass = make_render_pass(range);
+        state.render_queue.enqueue_pass(pass.instance, pass.order, pass.bounds);
+    }
+
+    _instances = {};
+    _vertex_buffer_data.reset();
+}
 
-            if (rect_count == 0)
+void RectDrawer::build_retained_ranges(std::span<const uint64_t> split_keys)
+{
+    const auto entries = _order_index.entries();
+    _split_keys.assign(split_keys.begin(), split_keys.end());
+    _retained_layers.begin();
+
+    // Runs don't cross layers, so every layer is retained on its own
+    for_each_render_run(
+        _slot_textures.size(),
+        split_keys,
+        [&](size_t i) { return entries[i].order.sort_key(); },
+        [&](size_t i)
+        { return std::make_pair(entries[i].order.layer, _slot_textures[i]); },
+        [&](size_t first, size_t last)
+        {
+            const auto texture_id = _slot_textures[first];
+            if (texture_id == NO_TEXTURE)
             {
                 return;
             }
-            
-            state.render_queue.enqueue_pass(
-                make_render_pass_instance(
-                    &_texture_bindings[texture_index], first_instance, rect_count
-                ),
-                order
+
+            add_texture_binding(texture_id);
+
+            // The whole run is a single pass, the damage path redraws only
+            // the blocks of it inside of the damaged regions
+            std::vector<Rect> block_bounds;
+            for (auto block_first = first; block_first < last;
+                 block_first += RenderQueue::BLOCK_INSTANCES)
+            {
+                const auto block_last =
+                    std::min(block_first + RenderQueue::BLOCK_INSTANCES, last);
+
+                auto bounds = _slot_bounds[block_first];
+                for (auto i = block_first + 1; i < block_last; i++)
+                {
+                    bounds = bounds.united(_slot_bounds[i]);
+                }
+                block_bounds.push_back(bounds);
+            }
+
+            auto bounds = block_bounds.front();
+            for (const auto& block : block_bounds)
+            {
+                bounds = bounds.united(block);
+            }
+
+            _retained_layers.add(
+                entries[first].order.layer,
+                InstanceRange {
+                    .first_instance = first,
+                    .count = last - first,
+                    .texture_id = texture_id,
+                    .order = entries[first].order,
+                    .bounds = bounds,
+                    .block_bounds = std::move(block_bounds),
+                }
             );
         }
     );
 }
 
+void RectDrawer::add_texture_binding(DivisionId texture_id)
+{
+    utility::algorithm::sorted_insert(
+        _texture_bindings,
+        DivisionIdWithBinding {
+            .id = texture_id,
+            .shader_location = TEXTURE_LOCATION,
+        },
+        [](const auto& x, const auto& y) { return x.id < y.id; }
+    );
+}
+
+RectDrawer::RectInstance RectDrawer::make_instance(
+    const Rect& bounds,
+    const RenderableRect& rect,
+    const glm::vec4& clip_rect,
+    uint32_t translation_index
+)
+{
+    return RectInstance {
+        .size = bounds.size(),
+        .position = glm::vec2 { bounds.left(), bounds.bottom() },
+        .color = rect.color,
+        .trbl_border_radius = rect.border_radius.top_left_right_bottom,
+        .uv_rect = rect.uv_rect,
+        .clip_rect = clip_rect,
+        .translation_index = static_cast<float>(translation_index),
+    };
+}
+
 DivisionId
 RectDrawer::make_vertex_buffer(core::Context& context_helper, uint32_t instance_capacity)
 {
@@ -179,19 +484,27 @@ RectDrawer::make_vertex_buffer(core::Context& context_helper, uint32_t instance_
     return id;
 }
 
-DivisionRenderPassInstance RectDrawer::make_render_pass_instance(
-    DivisionIdWithBinding* texture_ptr,
-    size_t first_instance,
-    size_t instance_count
-)
+RenderQueue::Pass RectDrawer::make_render_pass(const InstanceRange& range)
 {
-    return core::RenderPassInstanceBuilder { _render_pass_descriptor_id }
-        .uniform_fragment_buffers({ &_screen_size_uniform, 1 })
-        .uniform_vertex_buffers({ &_screen_size_uniform, 1 })
-        .fragment_textures({ texture_ptr, 1 })
-        .vertices(RECT_VERTICES.size())
-        .indices(RECT_INDICES.size())
-        .instances(instance_count, first_instance)
-        .build();
+    auto texture_it = std::lower_bound(
+        _texture_bindings.begin(),
+        _texture_bindings.end(),
+        range.texture_id,
+        [](const auto& binding, DivisionId id) { return binding.id < id; }
+    );
+
+    return RenderQueue::Pass {
+        .instance = core::RenderPassInstanceBuilder { _render_pass_descriptor_id }
+                        .uniform_fragment_buffers({ _uniforms.data(), 1 })
+                        .uniform_vertex_buffers(_uniforms)
+                        .fragment_textures({ &*texture_it, 1 })
+                        .vertices(RECT_VERTICES.size())
+                        .indices(RECT_INDICES.size())
+                        .instances(range.count, range.first_instance)
+                        .build(),
+        .order = range.order,
+        .bounds = range.bounds,
+        .block_bounds = range.block_bounds,
+    };
 }
 }
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include "canvas/render_order_index.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <ranges>
+
+namespace division_engine::canvas
+{
+namespace
+{
+bool less_order(const RenderOrderIndex::Entry& x, const RenderOrderIndex::Entry& y)
+{
+    return x.order.sort_key() < y.order.sort_key();
+}
+}
+
+RenderOrderIndex::~RenderOrderIndex()
+{
+    for (auto& observer : _observers)
+    {
+        observer.destruct();
+    }
+}
+
+void RenderOrderIndex::upsert(flecs::entity_t entity, const components::RenderOrder& order)
+{
+    if (order.is_idle())
+    {
+        remove(entity);
+        return;
+    }
+
+    _pending.push_back(PendingChange {
+        .entity = entity,
+        .order = order,
+        .removed = false,
+    });
+}
+
+void RenderOrderIndex::remove(flecs::entity_t entity)
+{
+    _pending.push_back(PendingChange {
+        .entity = entity,
+        .order = {},
+        .removed = true,
+    });
+}
+
+bool RenderOrderIndex::apply_pending()
+{
+    if (_pending.empty())
+    {
+        return false;
+    }
+
+    // Only the last change of every entity is applied
+    std::ranges::stable_sort(_pending, {}, &PendingChange::entity);
+
+    _inserted.clear();
+    size_t removed_count = 0;
+
+    for (size_t i = 0; i < _pending.size(); i++)
+    {
+        const auto& change = _pending[i];
+        if (i + 1 < _pending.size() && _pending[i + 1].entity == change.entity)
+        {
+            continue;
+        }
+
+        const auto current_slot = slot(change.entity);
+        if (current_slot != NO_SLOT)
+        {
+            auto& entry = _entries[current_slot];
+            if (!change.removed && entry.order.sort_key() == change.order.sort_key())
+            {
+                continue;
+            }
+
+            entry.entity = 0;
+            removed_count++;
+        }
+
+        if (!change.removed)
+        {
+            _inserted.push_back(Entry { .order = change.order, .entity = change.entity });
+        }
+    }
+
+    _pending.clear();
+
+    if (removed_count == 0 && _inserted.empty())
+    {
+        return false;
+    }
+
+    if (removed_count > 0)
+    {
+        std::erase_if(_entries, [](const Entry& entry) { return entry.entity == 0; });
+    }
+
+    std::ranges::sort(_inserted, less_order);
+
+    const auto merged_count = static_cast<std::ptrdiff_t>(_entries.size());
+    _entries.insert(_entries.end(), _inserted.begin(), _inserted.end());
+    std::inplace_merge(
+        _entries.begin(), _entries.begin() + merged_count, _entries.end(), less_order
+    );
+
+    for (uint32_t slot = 0; slot < _entries.size(); slot++)
+    {
+        const auto index = entity_index(_entries[slot].entity);
+        if (index >= _slots.size())
+        {
+            _slots.resize(index + 1, NO_SLOT);
+        }
+
+        _slots[index] = slot;
+    }
+
+    return true;
+}
+}
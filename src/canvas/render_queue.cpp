@@ -1,43 +1,433 @@
 #include "canvas/render_queue.hpp"
 
-#include "canvas/state.hpp"
+#include "canvas/damage_tracker.hpp"
+#include "core/render_pass_instance_builder.hpp"
 
 #include <division_engine_core/context.h>
 #include <division_engine_core/render_pass_instance.h>
 #include <division_engine_core/types/color.h>
 
 #include <algorithm>
+#include <filesystem>
+#include <iterator>
+#include <limits>
 #include <ranges>
 
 namespace division_engine::canvas
 {
-void RenderQueue::enqueue_pass(const DivisionRenderPassInstance& pass, uint32_t order)
+namespace
 {
-    _render_passes.push_back({ pass, order });
+const auto CLEAR_VERTEX_COUNT = 4;
+const auto CLEAR_INDICES = std::array { 0u, 1u, 2u, 2u, 3u, 0u };
+const auto SCREEN_SIZE_UNIFORM_LOCATION = 1;
+
+bool intersects(const RenderQueue::Pass& pass, const Rect& region)
+{
+    return !pass.bounds.has_value() || pass.bounds->intersects(region);
+}
 }
 
-void RenderQueue::draw(DivisionContext* context, const glm::vec4& clear_color)
+RenderQueue::RenderQueue(core::Context& context, DivisionId screen_size_uniform_id)
+  : _ctx(context)
+  , _screen_size_uniform(DivisionIdWithBinding {
+        .id = screen_size_uniform_id,
+        .shader_location = SCREEN_SIZE_UNIFORM_LOCATION,
+    })
 {
-    std::ranges::sort(
-        _render_passes, [](const auto& x, const auto& y) { return x.second < y.second; }
+    for (size_t i = 0; i <= DamageTracker::MAX_REGIONS; i++)
+    {
+        _scissor_uniform_ids.push_back(_ctx.create_uniform<glm::vec4>());
+    }
+
+    const auto lowest = std::numeric_limits<float>::lowest();
+    const auto highest = std::numeric_limits<float>::max();
+    auto full_screen_scissor = _ctx.get_uniform_data<glm::vec4>(_scissor_uniform_ids[0]);
+    *full_screen_scissor.data_ptr = glm::vec4 { lowest, lowest, highest, highest };
+
+    _clear_shader_id = _ctx.create_bundled_shader(
+        std::filesystem::path { "resources" } / "shaders" / "canvas" / "clear"
+    );
+
+    _clear_vertex_buffer_id = _ctx.create_vertex_buffer<ClearVertex, ClearInstance>(
+        core::VertexBufferSize {
+            .vertex_count = CLEAR_VERTEX_COUNT,
+            .index_count = CLEAR_INDICES.size(),
+            .instance_count = DamageTracker::MAX_REGIONS,
+        },
+        core::Topology::DIVISION_TOPOLOGY_TRIANGLES
+    );
+
+    auto data = _ctx.borrow_vertex_buffer_data<ClearVertex, ClearInstance>(
+        _clear_vertex_buffer_id
     );
-    
-    _sorted_passes.resize(_render_passes.size());
-    std::transform(
-        _render_passes.begin(),
-        _render_passes.end(),
-        _sorted_passes.begin(),
-        [](const auto& pair) { return pair.first; }
+    std::ranges::copy(
+        std::array {
+            ClearVertex { glm::vec2 { 0, 0 } },
+            ClearVertex { glm::vec2 { 1, 0 } },
+            ClearVertex { glm::vec2 { 1, 1 } },
+            ClearVertex { glm::vec2 { 0, 1 } },
+        },
+        data.per_vertex_data().data()
     );
+    std::ranges::copy(CLEAR_INDICES, data.index_data().data());
+
+    _clear_render_pass_descriptor_id = _ctx.render_pass_descriptor_builder()
+                                           .shader(_clear_shader_id)
+                                           .vertex_buffer(_clear_vertex_buffer_id)
+                                           .build();
+}
+
+RenderQueue::~RenderQueue()
+{
+    for (const auto uniform_id : _scissor_uniform_ids)
+    {
+        _ctx.delete_uniform(uniform_id);
+    }
+
+    _ctx.delete_vertex_buffer(_clear_vertex_buffer_id);
+    _ctx.delete_shader(_clear_shader_id);
+}
+
+void RenderQueue::enqueue_pass(
+    const DivisionRenderPassInstance& pass,
+    const components::RenderOrder& order,
+    const std::optional<Rect>& bounds
+)
+{
+    auto& layer = _layers[order.layer];
+    layer.transient.push_back(Pass {
+        .instance = pass,
+        .order = order,
+        .bounds = bounds,
+    });
+    layer.dirty = true;
+}
+
+void RenderQueue::retain_passes(
+    const void* source,
+    uint32_t layer_index,
+    std::span<const Pass> passes
+)
+{
+    auto& layer = _layers[layer_index];
+    auto it = std::ranges::find(layer.retained, source, &RetainedPasses::source);
+
+    if (passes.empty())
+    {
+        if (it != layer.retained.end())
+        {
+            layer.retained.erase(it);
+        }
+    }
+    else if (it == layer.retained.end())
+    {
+        layer.retained.push_back(RetainedPasses {
+            .source = source,
+            .passes = { passes.begin(), passes.end() },
+        });
+    }
+    else
+    {
+        it->passes.assign(passes.begin(), passes.end());
+    }
+
+    layer.dirty = true;
+}
+
+void RenderQueue::release_passes(const void* source)
+{
+    for (auto& [_, layer] : _layers)
+    {
+        const auto erased = std::erase_if(
+            layer.retained, [&](const auto& x) { return x.source == source; }
+        );
+        layer.dirty |= erased > 0;
+    }
+}
+
+size_t RenderQueue::pass_count() const
+{
+    size_t count = 0;
+    for (const auto& [_, layer] : _layers)
+    {
+        count += layer.transient.size();
+        for (const auto& retained : layer.retained)
+        {
+            count += retained.passes.size();
+        }
+    }
+    return count;
+}
 
+void RenderQueue::draw(DivisionContext* context, const glm::vec4& clear_color)
+{
+    update_layers();
+
+    if (_changed)
+    {
+        size_t uniform_count = 0;
+        for (const auto& [_, layer] : _layers)
+        {
+            for (const auto& pass : layer.sorted)
+            {
+                uniform_count += pass.instance.uniform_fragment_buffer_count + 1;
+            }
+        }
+
+        // The passes point into the uniforms, so they are never reallocated
+        _sorted_passes.clear();
+        _fragment_uniforms.clear();
+        _fragment_uniforms.reserve(uniform_count);
+
+        for (const auto& [_, layer] : _layers)
+        {
+            for (const auto& pass : layer.sorted)
+            {
+                append_scissored_pass(
+                    _sorted_passes,
+                    _fragment_uniforms,
+                    pass.instance,
+                    _scissor_uniform_ids[0]
+                );
+            }
+        }
+
+        _changed = false;
+    }
+
+    submit(context, _sorted_passes, &clear_color);
+}
+
+void RenderQueue::draw(
+    DivisionContext* context,
+    const glm::vec4& clear_color,
+    DamageTracker& damage,
+    FrameBufferContents contents
+)
+{
+    damage.resolve(_ctx.get_screen_size());
+
+    const auto regions = damage.regions();
+    if (damage.full() || contents == FrameBufferContents::Discarded)
+    {
+        draw(context, clear_color);
+        damage.clear();
+        return;
+    }
+
+    update_layers();
+
+    // The frame is still presented, so the loaded contents are submitted
+    if (regions.empty())
+    {
+        submit(context, {}, nullptr);
+        damage.clear();
+        return;
+    }
+
+    {
+        auto data = _ctx.borrow_vertex_buffer_data<ClearVertex, ClearInstance>(
+            _clear_vertex_buffer_id
+        );
+        auto clear_instances = data.per_instance_data();
+
+        for (size_t i = 0; i < regions.size(); i++)
+        {
+            const auto& region = regions[i];
+            const auto scissor_rect = glm::vec4 {
+                region.left(),
+                region.bottom(),
+                region.right(),
+                region.top(),
+            };
+
+            auto scissor = _ctx.get_uniform_data<glm::vec4>(_scissor_uniform_ids[i + 1]);
+            *scissor.data_ptr = scissor_rect;
+            clear_instances[i] = ClearInstance {
+                .rect = scissor_rect,
+                .color = clear_color,
+            };
+        }
+    }
+
+    // The regions don't overlap, so every region is drawn on its own
+    _damaged_runs.clear();
+    for (size_t i = 0; i < regions.size(); i++)
+    {
+        for (const auto& [_, layer] : _layers)
+        {
+            for (const auto& pass : layer.sorted)
+            {
+                if (intersects(pass, regions[i]))
+                {
+                    add_damaged_runs(_damaged_runs, pass, regions[i], i);
+                }
+            }
+        }
+    }
+
+    size_t uniform_count = 0;
+    for (const auto& run : _damaged_runs)
+    {
+        uniform_count += run.pass->uniform_fragment_buffer_count + 1;
+    }
+
+    _damaged_passes.clear();
+    _damaged_fragment_uniforms.clear();
+    _damaged_fragment_uniforms.reserve(uniform_count);
+
+    _damaged_passes.push_back(
+        core::RenderPassInstanceBuilder { _clear_render_pass_descriptor_id }
+            .uniform_vertex_buffers({ &_screen_size_uniform, 1 })
+            .vertices(CLEAR_VERTEX_COUNT)
+            .indices(CLEAR_INDICES.size())
+            .instances(regions.size())
+            .build()
+    );
+
+    for (const auto& run : _damaged_runs)
+    {
+        append_scissored_pass(
+            _damaged_passes,
+            _damaged_fragment_uniforms,
+            *run.pass,
+            _scissor_uniform_ids[run.region + 1]
+        );
+
+        auto& pass = _damaged_passes.back();
+        pass.first_instance = run.first_instance;
+        pass.instance_count = run.instance_count;
+    }
+
+    submit(context, _damaged_passes, nullptr);
+    damage.clear();
+}
+
+void RenderQueue::update_layers()
+{
+    for (auto it = _layers.begin(); it != _layers.end();)
+    {
+        auto& layer = it->second;
+        if (layer.dirty)
+        {
+            sort_layer(layer);
+            _changed = true;
+        }
+
+        // The transient passes are dropped after the frame, so their layer is
+        // sorted again in the next one
+        layer.dirty = !layer.transient.empty();
+        layer.transient.clear();
+
+        if (layer.retained.empty() && layer.sorted.empty() && !layer.dirty)
+        {
+            it = _layers.erase(it);
+        }
+        else
+        {
+            it++;
+        }
+    }
+}
+
+void RenderQueue::submit(
+    DivisionContext* context,
+    std::span<const DivisionRenderPassInstance> passes,
+    const glm::vec4* clear_color
+)
+{
     division_engine_render_pass_instance_draw(
         context,
-        reinterpret_cast<const DivisionColor*>(&clear_color), //NOLINT
-        _sorted_passes.data(),
-        static_cast<uint32_t>(_sorted_passes.size())
+        reinterpret_cast<const DivisionColor*>(clear_color), //NOLINT
+        passes.data(),
+        static_cast<uint32_t>(passes.size())
+    );
+}
+
+void RenderQueue::sort_layer(Layer& layer)
+{
+    layer.sorted.clear();
+    for (const auto& retained : layer.retained)
+    {
+        layer.sorted.insert(
+            layer.sorted.end(), retained.passes.begin(), retained.passes.end()
+        );
+    }
+    layer.sorted.insert(
+        layer.sorted.end(), layer.transient.begin(), layer.transient.end()
     );
 
-    _render_passes.clear();
-    _sorted_passes.clear();
+    std::ranges::stable_sort(
+        layer.sorted,
+        [](const auto& x, const auto& y) { return x.order.order < y.order.order; }
+    );
+}
+
+void RenderQueue::add_damaged_runs(
+    std::vector<DamagedRun>& runs,
+    const Pass& pass,
+    const Rect& region,
+    size_t region_index
+)
+{
+    const auto& instance = pass.instance;
+    if (pass.block_bounds.empty())
+    {
+        runs.push_back(DamagedRun {
+            .pass = &instance,
+            .first_instance = instance.first_instance,
+            .instance_count = instance.instance_count,
+            .region = region_index,
+        });
+        return;
+    }
+
+    const auto block_count = pass.block_bounds.size();
+    for (size_t block = 0; block < block_count;)
+    {
+        if (!pass.block_bounds[block].intersects(region))
+        {
+            block++;
+            continue;
+        }
+
+        const auto first_block = block;
+        while (block < block_count && pass.block_bounds[block].intersects(region))
+        {
+            block++;
+        }
+
+        const auto first = first_block * BLOCK_INSTANCES;
+        const auto last = std::min(block * BLOCK_INSTANCES, instance.instance_count);
+        runs.push_back(DamagedRun {
+            .pass = &instance,
+            .first_instance = instance.first_instance + first,
+            .instance_count = last - first,
+            .region = region_index,
+        });
+    }
+}
+
+void RenderQueue::append_scissored_pass(
+    std::vector<DivisionRenderPassInstance>& passes,
+    std::vector<DivisionIdWithBinding>& fragment_uniforms,
+    const DivisionRenderPassInstance& pass,
+    DivisionId scissor_uniform_id
+)
+{
+    const auto first_uniform = fragment_uniforms.size();
+    fragment_uniforms.insert(
+        fragment_uniforms.end(),
+        pass.uniform_fragment_buffers,
+        pass.uniform_fragment_buffers + pass.uniform_fragment_buffer_count
+    );
+    fragment_uniforms.push_back(DivisionIdWithBinding {
+        .id = scissor_uniform_id,
+        .shader_location = SCISSOR_UNIFORM_LOCATION,
+    });
+
+    auto& scissored_pass = passes.emplace_back(pass);
+    scissored_pass.uniform_fragment_buffers = &fragment_uniforms[first_uniform];
+    scissored_pass.uniform_fragment_buffer_count += 1;
+}
 }
-}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#include "canvas/renderer_pool.hpp"
+
+#include "canvas/components/render_order.hpp"
+
+namespace division_engine::canvas
+{
+flecs::entity RendererPool::acquire(flecs::world& world, flecs::entity_t batch)
+{
+    const auto it = _idle.find(batch);
+    if (it == _idle.end() || it->second.empty())
+    {
+        return flecs::entity::null();
+    }
+
+    const auto renderer = it->second.back();
+    it->second.pop_back();
+    _idle_count--;
+
+    return flecs::entity { world, renderer };
+}
+
+void RendererPool::release(flecs::entity renderer, flecs::entity_t batch)
+{
+    renderer.set(components::RenderOrder::idle());
+    _idle[batch].push_back(renderer.id());
+    _idle_count++;
+}
+
+void RendererPool::trim(flecs::world& world)
+{
+    bool deferred = false;
+    for (auto& [_, renderers] : _idle)
+    {
+        while (renderers.size() > _max_idle_per_batch)
+        {
+            if (!deferred)
+            {
+                world.defer_begin();
+                deferred = true;
+            }
+
+            flecs::entity { world, renderers.back() }.destruct();
+            renderers.pop_back();
+            _idle_count--;
+        }
+    }
+
+    if (deferred)
+    {
+        world.defer_end();
+    }
+}
+}
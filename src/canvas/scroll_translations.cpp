@@ -0,0 +1,125 @@
+#include "canvas/scroll_translations.hpp"
+
+#include "canvas/components/render_clip.hpp"
+#include "core/exception.hpp"
+
+#include <algorithm>
+
+namespace division_engine::canvas
+{
+ScrollTranslations::ScrollTranslations(core::Context& context)
+  : _ctx(context)
+  , _uniform_id(_ctx.create_uniform<UniformBlock>())
+{
+    auto data = _ctx.get_uniform_data<UniformBlock>(_uniform_id);
+    data.data_ptr->offsets.fill(glm::vec4 { 0 });
+    // The renderers outside of the scroll views are not cut by a viewport
+    data.data_ptr->viewports.fill(components::RenderClip::NO_CLIP_RECT);
+
+    // Lower indices are handed out first
+    _free.reserve(CAPACITY - 1);
+    for (auto index = static_cast<uint32_t>(CAPACITY - 1); index > NO_TRANSLATION;
+         index--)
+    {
+        _free.push_back(index);
+    }
+}
+
+ScrollTranslations::~ScrollTranslations()
+{
+    _ctx.delete_uniform(_uniform_id);
+}
+
+uint32_t ScrollTranslations::acquire()
+{
+    if (_free.empty())
+    {
+        throw core::Exception { "Too many scroll views are rendered at once" };
+    }
+
+    const auto index = _free.back();
+    _free.pop_back();
+    _active.push_back(index);
+    return index;
+}
+
+void ScrollTranslations::release(uint32_t index)
+{
+    const auto it = std::ranges::find(_active, index);
+    if (it == _active.end())
+    {
+        return;
+    }
+
+    *it = _active.back();
+    _active.pop_back();
+    _free.push_back(index);
+
+    // The next owner starts from the zero offset and sets its viewport
+    set_offset(index, glm::vec2 { 0 });
+    _viewports[index] = Rect {};
+    _cull_rects[index] = Rect {};
+    write_viewport(index, components::RenderClip::NO_CLIP_RECT);
+}
+
+void ScrollTranslations::set_offset(uint32_t index, glm::vec2 offset)
+{
+    if (_offsets[index] == offset)
+    {
+        return;
+    }
+
+    _offsets[index] = offset;
+
+    auto data = _ctx.get_uniform_data<UniformBlock>(_uniform_id);
+    data.data_ptr->offsets[index] = glm::vec4 { offset.x, offset.y, 0, 0 };
+
+    update_cull_rect(index);
+}
+
+void ScrollTranslations::set_viewport(uint32_t index, const Rect& viewport)
+{
+    if (_viewports[index] == viewport)
+    {
+        return;
+    }
+
+    _viewports[index] = viewport;
+    write_viewport(index, components::RenderClip { viewport }.clip_rect());
+
+    // The drawers take the viewport for the screen area of the renderers
+    _version++;
+    update_cull_rect(index);
+}
+
+std::optional<Rect>
+ScrollTranslations::visible_rect(uint32_t index, const Rect* clip) const
+{
+    if (index == NO_TRANSLATION)
+    {
+        return clip != nullptr ? std::optional { *clip } : std::nullopt;
+    }
+
+    const auto& cull_rect = _cull_rects[index];
+    return clip != nullptr ? cull_rect.intersected(*clip) : cull_rect;
+}
+
+void ScrollTranslations::write_viewport(uint32_t index, const glm::vec4& viewport)
+{
+    auto data = _ctx.get_uniform_data<UniformBlock>(_uniform_id);
+    data.data_ptr->viewports[index] = viewport;
+}
+
+void ScrollTranslations::update_cull_rect(uint32_t index)
+{
+    const auto visible = _viewports[index].translated(-_offsets[index]);
+    if (_cull_rects[index].contains(visible))
+    {
+        return;
+    }
+
+    _cull_rects[index] =
+        Rect::from_center(visible.center, visible.size() * (1 + 2 * CULL_MARGIN_RATIO));
+    _version++;
+}
+}
@@ -14,6 +14,7 @@
 
 #include <algorithm>
 #include <filesystem>
+#include <numeric>
 #include <ranges>
 #include <string>
 #include <string_view>
@@ -28,16 +29,48 @@ const auto TEXTURE_LOCATION = 0;
 
 using namespace components;
 
+namespace
+{
+template<typename TBuilder>
+decltype(auto) with_text_terms(TBuilder&& builder)
+{
+    return builder.template term<RenderBatch>()
+        .up(flecs::IsA)
+        .template with<RenderOrder>();
+}
+
+template<typename TBuilder>
+decltype(auto) with_text_observer_terms(TBuilder&& builder)
+{
+    return builder.template term<const RenderBounds>()
+        .filter()
+        .template term<const RenderableText>()
+        .filter()
+        .template term<RenderBatch>()
+        .up(flecs::IsA)
+        .filter();
+}
+}
+
 TextDrawer::TextDrawer(State& state, const std::filesystem::path& font_path)
   : _font_texture(FontTexture {
         state.context,
+        state.texture_manager,
         font_path,
         static_cast<size_t>(RASTERIZED_FONT_SIZE),
     })
+  , _render_queue(state.render_queue)
+  , _scroll_translations(state.scroll_translations)
   , _ctx(state.context)
-  , _screen_size_uniform(DivisionIdWithBinding {
-        .id = state.screen_size_uniform_id,
-        .shader_location = SCREEN_SIZE_UNIFORM_LOCATION,
+  , _uniforms({
+        DivisionIdWithBinding {
+            .id = state.screen_size_uniform_id,
+            .shader_location = SCREEN_SIZE_UNIFORM_LOCATION,
+        },
+        DivisionIdWithBinding {
+            .id = state.scroll_translations.uniform_id(),
+            .shader_location = ScrollTranslations::UNIFORM_LOCATION,
+        },
     })
   , _shader_id(_ctx.create_bundled_shader(
         std::filesystem::path { "resources" } / "shaders" / "canvas" / "font"
@@ -63,6 +96,7 @@ TextDrawer::TextDrawer(State& state, const std::filesystem::path& font_path)
             )
             .build()
     )
+  , _instance_capacity(INSTANCE_CAPACITY)
 {
     auto vb_data =
         _ctx.borrow_vertex_buffer_data<TextCharVertex, TextCharInstance>(_vertex_buffer_id
@@ -76,22 +110,65 @@ TextDrawer::TextDrawer(State& state, const std::filesystem::path& font_path)
         .shader_location = TEXTURE_LOCATION,
     });
 
-    _query =
-        state.world
-            .query_builder<const RenderBounds, const RenderableText, const RenderOrder>()
-            .order_by<RenderOrder>([](auto, const auto* x, auto, const auto* y)
-                                   { return x->compare(*y); })
-            .term<RenderBatch>()
-            .up(flecs::IsA)
-            .build();
+    _query = with_text_terms(state.world.query_builder<
+                             const RenderBounds,
+                             const RenderableText,
+                             const RenderClip*,
+                             const RenderTranslation*>())
+                 .build();
 }
 
 TextDrawer::~TextDrawer()
 {
+    for (auto& system : _systems)
+    {
+        system.destruct();
+    }
+
+    _render_queue.release_passes(this);
     _ctx.delete_vertex_buffer(_vertex_buffer_id);
     _ctx.delete_shader(_shader_id);
 }
 
+void TextDrawer::register_systems(State& state)
+{
+    _order_index.observe(
+        state.world, [](auto&& builder) { return with_text_observer_terms(builder); }
+    );
+
+    _systems.push_back(state.world.system()
+                           .kind(state.render_phase)
+                           .iter([this, &state](flecs::iter&) { reserve_instances(state); }));
+
+    _systems.push_back(
+        with_text_terms(state.world.system<
+                        const RenderBounds,
+                        const RenderableText,
+                        const RenderClip*,
+                        const RenderTranslation*>())
+            .kind(state.render_phase)
+            .multi_threaded()
+            .iter(
+                [this](
+                    flecs::iter& it,
+                    const RenderBounds* bounds_ptr,
+                    const RenderableText* renderable_ptr,
+                    const RenderClip* clip_ptr,
+                    const RenderTranslation* translation_ptr
+                )
+                {
+                    fill_instances(
+                        it, bounds_ptr, renderable_ptr, clip_ptr, translation_ptr
+                    );
+                }
+            )
+    );
+
+    _systems.push_back(state.world.system()
+                           .kind(state.render_phase)
+                           .iter([this, &state](flecs::iter&) { enqueue_passes(state); }));
+}
+
 static inline core::
     VertexBufferData<TextDrawer::TextCharVertex, TextDrawer::TextCharInstance>
     borrow_vertex_buffer_data(core::Context& ctx, DivisionId vertex_buffer_id)
@@ -101,99 +178,336 @@ static inline core::
         TextDrawer::TextCharInstance>(vertex_buffer_id);
 }
 
-void TextDrawer::fill_render_queue(State& state)
+void TextDrawer::reserve_instances(State& state)
 {
-    using core::RenderPassInstanceBuilder;
+    const auto order_changed = _order_index.apply_pending();
+    state.immediate.sort();
 
-    size_t overall_instance_count = 0;
+    const auto retained_count = _order_index.size();
+    const auto immediate_texts = state.immediate.texts();
 
-    auto vb_instance_size =
-        borrow_vertex_buffer_data(_ctx, _vertex_buffer_id).per_instance_data().size();
+    // The translated texts are culled again when the content scrolled out of
+    // the cull rects
+    const auto translations_changed =
+        _translations_version != _scroll_translations.version();
+    _translations_version = _scroll_translations.version();
 
-    if (_query.count() == 0)
+    // Text lengths move the instances of the following texts, so any change
+    // refills all the retained texts
+    _retained_dirty = order_changed || _query.changed() || translations_changed ||
+                      state.screen_size_changed();
+
+    if (_retained_dirty)
+    {
+        _renderable_instance_offsets.assign(retained_count + 1, 0);
+        _slot_bounds.resize(retained_count);
+
+        // Glyphs are reserved here, so the fill workers only read the font texture
+        _font_texture.reserve_character(' ');
+
+        _query.iter(
+            [&](flecs::iter& it,
+                const RenderBounds* bounds_ptr,
+                const RenderableText* renderable_ptr,
+                const RenderClip* clip_ptr,
+                const RenderTranslation* translation_ptr)
+            {
+                for (const auto i : it)
+                {
+                    const auto slot = _order_index.slot(it.entity(i));
+                    if (slot == RenderOrderIndex::NO_SLOT)
+                    {
+                        continue;
+                    }
+
+                    // The bounds and the clips of the scrolled texts are in
+                    // the content space, so the viewport stands for their
+                    // screen area
+                    const auto translation_index =
+                        translation_ptr != nullptr
+                            ? translation_ptr[i].index
+                            : ScrollTranslations::NO_TRANSLATION;
+                    _slot_bounds[slot] =
+                        translation_index != ScrollTranslations::NO_TRANSLATION
+                            ? _scroll_translations.viewport(translation_index)
+                            : bounds_ptr[i].value;
+
+                    // The texts outside of the area they are drawn in reserve
+                    // no instances
+                    const auto visible_rect = _scroll_translations.visible_rect(
+                        translation_index,
+                        clip_ptr != nullptr ? &clip_ptr[i].value : nullptr
+                    );
+                    if (visible_rect.has_value() &&
+                        !visible_rect->intersects(bounds_ptr[i].value))
+                    {
+                        continue;
+                    }
+
+                    const auto& text_str = renderable_ptr[i].text;
+                    for (auto ch : text_str)
+                    {
+                        _font_texture.reserve_character(ch);
+                    }
+
+                    _renderable_instance_offsets[slot + 1] = text_str.size();
+                }
+            }
+        );
+
+        std::partial_sum(
+            _renderable_instance_offsets.begin(),
+            _renderable_instance_offsets.end(),
+            _renderable_instance_offsets.begin()
+        );
+    }
+
+    // The offsets of the immediate texts follow the retained ones
+    _renderable_instance_offsets.resize(retained_count + 1);
+    for (const auto& item : immediate_texts)
+    {
+        const auto text_str = state.immediate.text(item);
+        for (auto ch : text_str)
+        {
+            _font_texture.reserve_character(ch);
+        }
+
+        _renderable_instance_offsets.push_back(
+            _renderable_instance_offsets.back() + text_str.size()
+        );
+    }
+
+    const auto instance_count = _renderable_instance_offsets.back();
+    if (instance_count == 0)
     {
         return;
     }
 
-    _query.iter(
-        [&](flecs::iter& it,
-            const RenderBounds* bounds_ptr,
-            const RenderableText* renderable_ptr,
-            const RenderOrder* render_order_ptr)
+    if (_instance_capacity < instance_count)
+    {
+        _ctx.resize_vertex_buffer(
+            _vertex_buffer_id,
+            DivisionVertexBufferSize {
+                .vertex_count = RECT_VERTICES.size(),
+                .index_count = RECT_INDICES.size(),
+                .instance_count = static_cast<uint32_t>(instance_count) }
+        );
+        _instance_capacity = instance_count;
+        _retained_dirty = true;
+    }
+
+    // The instances of the unchanged frames stay in the buffer
+    if (!_retained_dirty && immediate_texts.empty())
+    {
+        return;
+    }
+
+    _vertex_buffer_data.emplace(borrow_vertex_buffer_data(_ctx, _vertex_buffer_id));
+    _instances = _vertex_buffer_data->per_instance_data();
+
+    for (size_t i = 0; i < immediate_texts.size(); i++)
+    {
+        const auto& item = immediate_texts[i];
+        fill_renderable_instances(
+            retained_count + i,
+            item.bounds,
+            state.immediate.text(item),
+            item.color,
+            item.font_size
+        );
+    }
+}
+
+void TextDrawer::fill_instances(
+    flecs::iter& it,
+    const RenderBounds* bounds_ptr,
+    const RenderableText* renderable_ptr,
+    const RenderClip* clip_ptr,
+    const RenderTranslation* translation_ptr
+)
+{
+    if (!_retained_dirty || _instances.empty())
+    {
+        return;
+    }
+
+    for (const auto i : it)
+    {
+        const auto slot = _order_index.slot(it.entity(i));
+        if (slot == RenderOrderIndex::NO_SLOT ||
+            _renderable_instance_offsets[slot] == _renderable_instance_offsets[slot + 1])
         {
-            for (const auto i : it)
-            {
-                const auto& bounds = bounds_ptr[i];
-                const auto& renderable = renderable_ptr[i];
-                const auto& text_str = renderable.text;
+            continue;
+        }
 
-                for (auto ch : text_str)
-                {
-                    _font_texture.reserve_character(ch);
-                }
+        const auto& renderable = renderable_ptr[i];
+        fill_renderable_instances(
+            slot,
+            bounds_ptr[i].value,
+            renderable.text,
+            renderable.color,
+            renderable.font_size,
+            clip_ptr != nullptr ? clip_ptr[i].clip_rect() : RenderClip::NO_CLIP_RECT,
+            translation_ptr != nullptr ? translation_ptr[i].index
+                                       : ScrollTranslations::NO_TRANSLATION
+        );
+    }
+}
 
-                const auto needed_capacity = overall_instance_count + text_str.size();
-                if (vb_instance_size < needed_capacity)
-                {
-                    _ctx.resize_vertex_buffer(
-                        _vertex_buffer_id,
-                        DivisionVertexBufferSize {
-                            .vertex_count = RECT_VERTICES.size(),
-                            .index_count = RECT_INDICES.size(),
-                            .instance_count = static_cast<uint32_t>(needed_capacity) }
-                    );
+void TextDrawer::fill_renderable_instances(
+    size_t renderable_index,
+    const Rect& bounds,
+    std::string_view text,
+    const glm::vec4& color,
+    float font_size,
+    const glm::vec4& clip_rect,
+    uint32_t translation_index
+)
+{
+    const auto first_instance = _renderable_instance_offsets[renderable_index];
+    const auto instance_count =
+        _renderable_instance_offsets[renderable_index + 1] - first_instance;
 
-                    vb_instance_size = needed_capacity;
-                }
+    auto renderable_instances = _instances.subspan(first_instance, instance_count);
+    const auto rendered_char_count = add_renderable_to_vertex_buffer(
+        renderable_instances, bounds, text, color, font_size
+    );
+
+    for (auto& instance : renderable_instances.first(rendered_char_count))
+    {
+        instance.clip_rect = clip_rect;
+        instance.translation_index = static_cast<float>(translation_index);
+    }
+
+    std::ranges::fill(
+        renderable_instances.subspan(rendered_char_count), TextCharInstance {}
+    );
+}
 
-                auto vb_data = borrow_vertex_buffer_data(_ctx, _vertex_buffer_id);
-                auto instances = vb_data.per_instance_data();
+void TextDrawer::enqueue_passes(State& state)
+{
+    const auto retained_count = _order_index.size();
+    const auto immediate_texts = state.immediate.texts();
+    const auto split_keys = state.immediate.split_keys();
 
-                auto subinstances =
-                    instances.last(instances.size() - overall_instance_count);
+    if (_retained_dirty || !std::ranges::equal(split_keys, _split_keys))
+    {
+        build_retained_ranges(split_keys);
+        _retained_layers.commit(
+            state.render_queue,
+            this,
+            false,
+            [this](const InstanceRange& range) { return make_render_pass(range); }
+        );
+    }
 
-                size_t rendered_char_count =
-                    add_renderable_to_vertex_buffer(subinstances, bounds, renderable);
+    for_each_render_run(
+        immediate_texts.size(),
+        split_keys,
+        [&](size_t i) { return immediate_texts[i].order.sort_key(); },
+        [](size_t) { return 0; },
+        [&](size_t first, size_t last)
+        {
+            auto bounds = immediate_texts[first].bounds;
+            for (auto i = first + 1; i < last; i++)
+            {
+                bounds = bounds.united(immediate_texts[i].bounds);
+            }
 
-                overall_instance_count += rendered_char_count;
+            const auto first_instance =
+                _renderable_instance_offsets[retained_count + first];
+            const auto range = InstanceRange {
+                .first_instance = first_instance,
+                .count = _renderable_instance_offsets[retained_count + last] -
+                         first_instance,
+                .order = immediate_texts[first].order,
+                .bounds = bounds,
+            };
+
+            if (range.count > 0)
+            {
+                const auto pass = make_render_pass(range);
+                state.render_queue.enqueue_pass(pass.instance, pass.order, pass.bounds);
             }
+        }
+    );
+
+    _instances = {};
+    _vertex_buffer_data.reset();
+
+    _font_texture.upload_texture();
+}
 
-            if (overall_instance_count == 0)
+void TextDrawer::build_retained_ranges(std::span<const uint64_t> split_keys)
+{
+    const auto entries = _order_index.entries();
+    _split_keys.assign(split_keys.begin(), split_keys.end());
+    _retained_layers.begin();
+
+    // Runs don't cross layers, so every layer is retained on its own
+    for_each_render_run(
+        entries.size(),
+        split_keys,
+        [&](size_t i) { return entries[i].order.sort_key(); },
+        [&](size_t i) { return entries[i].order.layer; },
+        [&](size_t first, size_t last)
+        {
+            const auto first_instance = _renderable_instance_offsets[first];
+            const auto count = _renderable_instance_offsets[last] - first_instance;
+            if (count == 0)
             {
                 return;
             }
 
-            const auto pass =
-                RenderPassInstanceBuilder { _render_pass_descriptor_id }
-                    .instances(overall_instance_count)
-                    .vertices(RECT_VERTICES.size())
-                    .indices(RECT_INDICES.size())
-                    .fragment_textures({ &_texture_bindings[0], 1 })
-                    .uniform_fragment_buffers({ &_screen_size_uniform, 1 })
-                    .uniform_vertex_buffers({ &_screen_size_uniform, 1 })
-                    .build();
-
-            state.render_queue.enqueue_pass(pass, render_order_ptr[0].order);
+            auto bounds = _slot_bounds[first];
+            for (auto i = first + 1; i < last; i++)
+            {
+                bounds = bounds.united(_slot_bounds[i]);
+            }
+
+            _retained_layers.add(
+                entries[first].order.layer,
+                InstanceRange {
+                    .first_instance = first_instance,
+                    .count = count,
+                    .order = entries[first].order,
+                    .bounds = bounds,
+                }
+            );
         }
     );
+}
 
-    _font_texture.upload_texture();
+RenderQueue::Pass TextDrawer::make_render_pass(const InstanceRange& range)
+{
+    return RenderQueue::Pass {
+        .instance = core::RenderPassInstanceBuilder { _render_pass_descriptor_id }
+                        .instances(range.count, range.first_instance)
+                        .vertices(RECT_VERTICES.size())
+                        .indices(RECT_INDICES.size())
+                        .fragment_textures({ &_texture_bindings[0], 1 })
+                        .uniform_fragment_buffers({ _uniforms.data(), 1 })
+                        .uniform_vertex_buffers(_uniforms)
+                        .build(),
+        .order = range.order,
+        .bounds = range.bounds,
+    };
 }
 
 size_t TextDrawer::add_renderable_to_vertex_buffer(
     std::span<TextCharInstance> instances,
-    const RenderBounds& bounds,
-    const RenderableText& renderable
-)
+    const Rect& bounds,
+    std::string_view text_str,
+    const glm::vec4& color,
+    float font_size
+) const
 {
-    const auto& text_str = renderable.text;
-    const auto font_scale = renderable.font_size / RASTERIZED_FONT_SIZE;
-    const auto space_index = _font_texture.reserve_character(' ');
+    const auto font_scale = font_size / RASTERIZED_FONT_SIZE;
+    const auto space_index = _font_texture.glyph_index(' ');
     const auto space_glyph = _font_texture.glyph_at(space_index);
     const auto space_advance_x = static_cast<float>(space_glyph.advance_x) * font_scale;
 
-    const auto bounds_rect = bounds.value;
-    const auto font_size = renderable.font_size;
+    const auto bounds_rect = bounds;
 
     glm::vec2 pen_pos { bounds_rect.left(), bounds_rect.top() - font_size };
     size_t rendered_char_count = 0;
@@ -224,7 +538,7 @@ size_t TextDrawer::add_renderable_to_vertex_buffer(
             break;
         }
 
-        using str_diff_type = std::string::difference_type;
+        using str_diff_type = std::string_view::difference_type;
 
         const auto word_start_it = text_str.begin() + static_cast<str_diff_type>(i);
         const auto word = get_next_word(
@@ -252,7 +566,7 @@ size_t TextDrawer::add_renderable_to_vertex_buffer(
         add_word_to_vertex_buffer(
             { word_start_it, word_end_it },
             pen_pos,
-            renderable.color,
+            color,
             font_scale,
             word_instances
         );
@@ -294,7 +608,7 @@ void TextDrawer::add_word_to_vertex_buffer(
     const glm::vec4& color,
     float font_scale,
     std::span<TextCharInstance> instances
-)
+) const
 {
     auto word_pos = position;
     for (int i = 0; i < word.size(); i++)
@@ -305,6 +619,7 @@ void TextDrawer::add_word_to_vertex_buffer(
 
         if (glyph.width <= 0)
         {
+            instances[i] = TextCharInstance {};
             continue;
         }
 
@@ -8,6 +8,8 @@ CoreRunner::CoreRunner(std::string window_title, glm::uvec2 window_size)
   : _ctx(new DivisionContext)
   , _window_title(std::move(window_title))
   , _window_size(window_size)
+  , _frame_scheduler(std::make_shared<FrameScheduler>())
+  , _input_queue(std::make_shared<InputQueue>(_frame_scheduler.get()))
 {
     DivisionSettings settings {
         .window_width = _window_size.x,
@@ -34,6 +36,15 @@ void CoreRunner::execute(const DivisionLifecycle* lifecycle)
     division_engine_renderer_run_loop(_ctx);
 }
 
+bool CoreRunner::begin_frame(DivisionContext* context_ptr, FrameScheduler& scheduler)
+{
+    const auto* renderer_context = context_ptr->renderer_context;
+    return scheduler.begin_frame(glm::vec2 {
+        renderer_context->frame_buffer_width,
+        renderer_context->frame_buffer_height,
+    });
+}
+
 void* CoreRunner::get_context_user_data(DivisionContext* context_ptr)
 {
     return context_ptr->user_data;
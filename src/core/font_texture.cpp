@@ -9,6 +9,7 @@ namespace division_engine::core
 {
 FontTexture::FontTexture(
     Context& context,
+    TextureManager& texture_manager,
     const std::filesystem::path& font_path,
     size_t font_size,
     glm::ivec2 resolution
@@ -18,15 +19,17 @@ FontTexture::FontTexture(
   , _glyph_positions()
   , _free_rows_space()
   , _ctx(context)
+  , _texture_manager(texture_manager)
   , _resolution(resolution)
   , _font_size(font_size)
   , _rasterizer_buffer_capacity(0)
   , _pixel_buffer(static_cast<uint8_t*>(std::malloc(resolution.x * resolution.y)))
   , _rasterizer_buffer(nullptr)
   , _font_id(_ctx.create_font(font_path, static_cast<uint32_t>(font_size)))
-  , _texture_id(context.create_texture(
+  , _texture_id(texture_manager.acquire(
         resolution,
-        DivisionTextureFormat::DIVISION_TEXTURE_FORMAT_R8Uint
+        DivisionTextureFormat::DIVISION_TEXTURE_FORMAT_R8Uint,
+        TextureSubsystem::Font
     ))
   , _texture_was_changed(false)
 {
@@ -48,7 +51,7 @@ FontTexture::~FontTexture()
 {
     if (!_pixel_buffer) return;
     
-    _ctx.delete_texture(_texture_id);
+    _texture_manager.release(_texture_id);
     _ctx.delete_font(_font_id);
 
     std::free(_pixel_buffer);
@@ -0,0 +1,63 @@
+#include "core/frame_scheduler.hpp"
+
+namespace division_engine::core
+{
+void FrameScheduler::set_mode(RenderMode mode)
+{
+    _mode.store(mode, std::memory_order_relaxed);
+
+    // The loop shouldn't wait for the idle timeout to switch the mode
+    invalidate();
+}
+
+void FrameScheduler::set_idle_timeout(std::chrono::milliseconds timeout)
+{
+    std::lock_guard lock { _mutex };
+    _idle_timeout = timeout;
+}
+
+void FrameScheduler::invalidate()
+{
+    {
+        std::lock_guard lock { _mutex };
+        _frame_requested = true;
+    }
+
+    _frame_requested_condition.notify_one();
+}
+
+void FrameScheduler::request_animation_frame()
+{
+    // Only the loop thread calls it during the frame, so nobody waits
+    std::lock_guard lock { _mutex };
+    _frame_requested = true;
+}
+
+bool FrameScheduler::begin_frame(glm::vec2 frame_buffer_size)
+{
+    std::unique_lock lock { _mutex };
+
+    if (frame_buffer_size != _frame_buffer_size)
+    {
+        _frame_buffer_size = frame_buffer_size;
+        _frame_requested = true;
+    }
+
+    if (mode() == RenderMode::OnDemand)
+    {
+        _frame_requested_condition.wait_for(
+            lock, _idle_timeout, [this] { return _frame_requested; }
+        );
+
+        if (!_frame_requested)
+        {
+            _skipped_frame_count.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    _frame_requested = false;
+    _drawn_frame_count.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+}
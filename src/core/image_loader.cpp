@@ -0,0 +1,338 @@
+#include "core/image_loader.hpp"
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_JPEG
+#define STBI_ONLY_PNG
+#include <stb_image.h>
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <utility>
+
+namespace division_engine::core
+{
+namespace
+{
+const int RGBA_CHANNELS = 4;
+}
+
+ImageLoader::ImageLoader(
+    Context& context,
+    TextureManager& texture_manager,
+    DivisionId placeholder_texture_id,
+    size_t worker_count,
+    size_t upload_budget_bytes
+)
+  : _ctx(context)
+  , _texture_manager(texture_manager)
+  , _placeholder_texture_id(placeholder_texture_id)
+  , _upload_budget_bytes(upload_budget_bytes)
+  , _stopping(false)
+{
+    worker_count = std::max<size_t>(worker_count, 1);
+    _workers.reserve(worker_count);
+
+    for (size_t i = 0; i < worker_count; i++)
+    {
+        _workers.emplace_back([this] { run_worker(); });
+    }
+}
+
+ImageLoader::~ImageLoader()
+{
+    {
+        std::lock_guard lock { _jobs_mutex };
+        _stopping = true;
+    }
+    _jobs_condition.notify_all();
+
+    for (auto& worker : _workers)
+    {
+        worker.join();
+    }
+
+    for (const auto& image : _images)
+    {
+        if (image.status == ImageStatus::Ready)
+        {
+            _texture_manager.release(image.texture_id);
+        }
+    }
+}
+
+ImageHandle
+ImageLoader::load(const std::filesystem::path& path, TextureCallback on_texture_changed)
+{
+    ImageHandle handle {};
+    auto image = Image {
+        .status = ImageStatus::Loading,
+        .texture_id = _placeholder_texture_id,
+        .size = glm::ivec2 { 0 },
+        .on_texture_changed = std::move(on_texture_changed),
+        .error = {},
+        .path = path,
+    };
+
+    if (_free_indices.empty())
+    {
+        handle.index = static_cast<uint32_t>(_images.size());
+        _images.push_back(std::move(image));
+    }
+    else
+    {
+        handle.index = _free_indices.back();
+        _free_indices.pop_back();
+        _images[handle.index] = std::move(image);
+    }
+
+    {
+        std::lock_guard lock { _jobs_mutex };
+        _jobs.push_back(Job { .handle = handle, .path = path });
+    }
+    _jobs_condition.notify_one();
+
+    return handle;
+}
+
+void ImageLoader::update()
+{
+    size_t uploaded_bytes = 0;
+
+    while (uploaded_bytes < _upload_budget_bytes)
+    {
+        DecodedImage decoded;
+        {
+            std::lock_guard lock { _decoded_mutex };
+            if (_decoded.empty())
+            {
+                return;
+            }
+
+            decoded = std::move(_decoded.front());
+            _decoded.pop_front();
+        }
+
+        if (!decoded.error.empty())
+        {
+            auto& image = _images[decoded.handle.index];
+            image.status = ImageStatus::Failed;
+            image.error = std::move(decoded.error);
+            continue;
+        }
+
+        // Acquiring may evict other images, so the record is taken after it
+        const auto texture_id = _texture_manager.acquire(
+            decoded.size,
+            DivisionTextureFormat::DIVISION_TEXTURE_FORMAT_RGBA32Uint,
+            TextureSubsystem::Image,
+            [this](DivisionId texture_id) { evict(texture_id); }
+        );
+        _ctx.set_texture_data(texture_id, decoded.pixels.get());
+        decoded.pixels.reset();
+
+        uploaded_bytes += static_cast<size_t>(decoded.size.x * decoded.size.y) *
+                          RGBA_CHANNELS;
+
+        auto& image = _images[decoded.handle.index];
+        image.texture_id = texture_id;
+        image.size = decoded.size;
+        image.status = ImageStatus::Ready;
+
+        // The callback may load more images and move the image records
+        const auto on_texture_changed = image.on_texture_changed;
+        if (on_texture_changed)
+        {
+            on_texture_changed(texture_id);
+        }
+    }
+}
+
+void ImageLoader::reload(ImageHandle handle)
+{
+    auto& image = _images[handle.index];
+    if (image.status != ImageStatus::Evicted)
+    {
+        return;
+    }
+
+    image.status = ImageStatus::Loading;
+    {
+        std::lock_guard lock { _jobs_mutex };
+        _jobs.push_back(Job { .handle = handle, .path = image.path });
+    }
+    _jobs_condition.notify_one();
+}
+
+void ImageLoader::release(ImageHandle handle)
+{
+    auto& image = _images[handle.index];
+    if (image.status == ImageStatus::Loading)
+    {
+        throw Exception { "Can't release an image that is still loading" };
+    }
+
+    if (image.status == ImageStatus::Ready)
+    {
+        _texture_manager.release(image.texture_id);
+    }
+
+    image = Image {
+        .status = ImageStatus::Failed,
+        .texture_id = _placeholder_texture_id,
+        .size = glm::ivec2 { 0 },
+        .on_texture_changed = {},
+        .error = {},
+        .path = {},
+    };
+    _free_indices.push_back(handle.index);
+}
+
+void ImageLoader::evict(DivisionId texture_id)
+{
+    const auto it = std::ranges::find_if(
+        _images,
+        [&](const Image& image)
+        { return image.status == ImageStatus::Ready && image.texture_id == texture_id; }
+    );
+    if (it == _images.end())
+    {
+        return;
+    }
+
+    it->status = ImageStatus::Evicted;
+    it->texture_id = _placeholder_texture_id;
+
+    const auto on_texture_changed = it->on_texture_changed;
+    if (on_texture_changed)
+    {
+        on_texture_changed(_placeholder_texture_id);
+    }
+}
+
+void ImageLoader::run_worker()
+{
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock lock { _jobs_mutex };
+            _jobs_condition.wait(lock, [this] { return _stopping || !_jobs.empty(); });
+
+            if (_stopping)
+            {
+                return;
+            }
+
+            job = std::move(_jobs.front());
+            _jobs.pop_front();
+        }
+
+        auto decoded = decode(job);
+
+        std::lock_guard lock { _decoded_mutex };
+        _decoded.push_back(std::move(decoded));
+    }
+}
+
+ImageLoader::DecodedImage ImageLoader::decode(const Job& job)
+{
+    DecodedImage decoded {
+        .handle = job.handle,
+        .size = glm::ivec2 { 0 },
+        .pixels = nullptr,
+        .error = {},
+    };
+
+    std::ifstream file { job.path, std::ios::binary | std::ios::ate };
+    if (!file.is_open())
+    {
+        decoded.error = "Can't open the image file " + job.path.string();
+        return decoded;
+    }
+
+    const auto end_position = file.tellg();
+    if (end_position < 0 || end_position > std::numeric_limits<int>::max())
+    {
+        decoded.error = "Can't get the size of the image file " + job.path.string();
+        return decoded;
+    }
+
+    const auto file_size = static_cast<size_t>(end_position);
+    auto file_bytes = _buffer_pool.acquire(file_size);
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(file_bytes.data()), end_position); // NOLINT
+    if (!file)
+    {
+        _buffer_pool.release(std::move(file_bytes));
+        decoded.error = "Can't read the image file " + job.path.string();
+        return decoded;
+    }
+
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    decoded.pixels.reset(stbi_load_from_memory(
+        file_bytes.data(),
+        static_cast<int>(file_size),
+        &width,
+        &height,
+        &channels,
+        RGBA_CHANNELS
+    ));
+    _buffer_pool.release(std::move(file_bytes));
+
+    if (decoded.pixels == nullptr)
+    {
+        decoded.error = "Can't decode the image file " + job.path.string() + ": " +
+                        stbi_failure_reason();
+        return decoded;
+    }
+
+    decoded.size = glm::ivec2 { width, height };
+
+    return decoded;
+}
+
+void ImageLoader::PixelsDeleter::operator()(uint8_t* pixels) const
+{
+    stbi_image_free(pixels);
+}
+
+std::vector<uint8_t> ImageLoader::BufferPool::acquire(size_t size)
+{
+    std::vector<uint8_t> buffer;
+    {
+        std::lock_guard lock { _mutex };
+
+        // The smallest free buffer that fits wastes the least memory
+        auto best_it = _free_buffers.end();
+        for (auto it = _free_buffers.begin(); it != _free_buffers.end(); it++)
+        {
+            if (it->capacity() >= size &&
+                (best_it == _free_buffers.end() || it->capacity() < best_it->capacity()))
+            {
+                best_it = it;
+            }
+        }
+
+        if (best_it != _free_buffers.end())
+        {
+            buffer = std::move(*best_it);
+            _free_buffers.erase(best_it);
+        }
+    }
+
+    buffer.resize(size);
+    return buffer;
+}
+
+void ImageLoader::BufferPool::release(std::vector<uint8_t>&& buffer)
+{
+    std::lock_guard lock { _mutex };
+    if (_free_buffers.size() < MAX_FREE_BUFFERS)
+    {
+        _free_buffers.push_back(std::move(buffer));
+    }
+}
+}
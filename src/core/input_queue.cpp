@@ -0,0 +1,28 @@
+#include "core/input_queue.hpp"
+
+#include <utility>
+
+namespace division_engine::core
+{
+void InputQueue::post(const InputEvent& event)
+{
+    {
+        std::lock_guard lock { _mutex };
+        _events.push_back(event);
+    }
+
+    if (_frame_scheduler != nullptr)
+    {
+        _frame_scheduler->invalidate();
+    }
+}
+
+void InputQueue::take(std::vector<InputEvent>& events)
+{
+    events.clear();
+
+    // The buffers are swapped, so neither side allocates after warming up
+    std::lock_guard lock { _mutex };
+    std::swap(events, _events);
+}
+}
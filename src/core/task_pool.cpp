@@ -0,0 +1,157 @@
+#include "core/task_pool.hpp"
+
+#include <algorithm>
+
+namespace division_engine::core
+{
+TaskPool::TaskPool(size_t worker_count)
+  : _generation(0)
+  , _stopping(false)
+  , _task(nullptr)
+  , _remaining(0)
+{
+    _queues.reserve(worker_count + 1);
+    for (size_t i = 0; i < worker_count + 1; i++)
+    {
+        _queues.push_back(std::make_unique<Queue>());
+    }
+
+    _workers.reserve(worker_count);
+    for (size_t i = 0; i < worker_count; i++)
+    {
+        _workers.emplace_back([this, i] { run_worker(i); });
+    }
+}
+
+TaskPool::~TaskPool()
+{
+    {
+        std::lock_guard lock { _mutex };
+        _stopping = true;
+    }
+    _work_condition.notify_all();
+
+    for (auto& worker : _workers)
+    {
+        worker.join();
+    }
+}
+
+size_t TaskPool::default_worker_count()
+{
+    const auto hardware_threads = std::thread::hardware_concurrency();
+    return hardware_threads > 1 ? hardware_threads - 1 : 0;
+}
+
+void TaskPool::parallel_for(size_t task_count, const TaskFunction& task)
+{
+    if (task_count == 0)
+    {
+        return;
+    }
+
+    if (_workers.empty() || task_count == 1)
+    {
+        for (size_t i = 0; i < task_count; i++)
+        {
+            task(i);
+        }
+        return;
+    }
+
+    _task = &task;
+    _remaining.store(task_count);
+
+    // Neighbouring tasks go to the same queue, the thieves take the far end
+    const auto queue_count = _queues.size();
+    for (size_t q = 0; q < queue_count; q++)
+    {
+        auto& queue = *_queues[q];
+        const auto first = task_count * q / queue_count;
+        const auto last = task_count * (q + 1) / queue_count;
+
+        std::lock_guard lock { queue.mutex };
+        for (auto i = first; i < last; i++)
+        {
+            queue.tasks.push_back(i);
+        }
+    }
+
+    {
+        std::lock_guard lock { _mutex };
+        _generation++;
+    }
+    _work_condition.notify_all();
+
+    run_tasks(queue_count - 1);
+
+    std::unique_lock lock { _mutex };
+    _done_condition.wait(lock, [this] { return _remaining.load() == 0; });
+}
+
+void TaskPool::run_worker(size_t queue_index)
+{
+    size_t seen_generation = 0;
+    while (true)
+    {
+        {
+            std::unique_lock lock { _mutex };
+            _work_condition.wait(
+                lock,
+                [&] { return _stopping || _generation != seen_generation; }
+            );
+
+            if (_stopping)
+            {
+                return;
+            }
+            seen_generation = _generation;
+        }
+
+        run_tasks(queue_index);
+    }
+}
+
+void TaskPool::run_tasks(size_t queue_index)
+{
+    size_t task_index = 0;
+    while (pop_task(queue_index, task_index))
+    {
+        (*_task)(task_index);
+
+        if (_remaining.fetch_sub(1) == 1)
+        {
+            std::lock_guard lock { _mutex };
+            _done_condition.notify_all();
+        }
+    }
+}
+
+bool TaskPool::pop_task(size_t queue_index, size_t& task_index)
+{
+    {
+        auto& own = *_queues[queue_index];
+        std::lock_guard lock { own.mutex };
+        if (!own.tasks.empty())
+        {
+            task_index = own.tasks.back();
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    for (size_t offset = 1; offset < _queues.size(); offset++)
+    {
+        auto& victim = *_queues[(queue_index + offset) % _queues.size()];
+        std::lock_guard lock { victim.mutex };
+        if (!victim.tasks.empty())
+        {
+            task_index = victim.tasks.front();
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+}
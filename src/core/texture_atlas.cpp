@@ -0,0 +1,174 @@
+#include "core/texture_atlas.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace division_engine::core
+{
+namespace
+{
+// Keeps the linear filtering from sampling the neighbour images
+const int32_t IMAGE_GAP = 1;
+}
+
+TextureAtlas::TextureAtlas(
+    Context& context,
+    TextureManager& texture_manager,
+    glm::ivec2 page_size,
+    PageEvictionCallback on_page_evicted
+)
+  : _ctx(context)
+  , _texture_manager(texture_manager)
+  , _page_size(page_size)
+  , _pages()
+  , _on_page_evicted(std::move(on_page_evicted))
+{
+}
+
+TextureAtlas::~TextureAtlas()
+{
+    for (const auto& page : _pages)
+    {
+        _texture_manager.release(page.texture_id);
+    }
+}
+
+AtlasRegion TextureAtlas::add_image(glm::ivec2 size, std::span<const uint8_t> pixels)
+{
+    if (size.x > _page_size.x || size.y > _page_size.y)
+    {
+        throw Exception { "The image is larger than the atlas page" };
+    }
+
+    if (pixels.size() < static_cast<size_t>(size.x * size.y) * BYTES_PER_PIXEL)
+    {
+        throw Exception { "The image pixels don't match the image size" };
+    }
+
+    glm::ivec2 position {};
+    Page* page_ptr = nullptr;
+    for (auto& page : _pages)
+    {
+        if (try_place(page, size, position))
+        {
+            page_ptr = &page;
+            break;
+        }
+    }
+
+    if (page_ptr == nullptr)
+    {
+        page_ptr = &add_page();
+        try_place(*page_ptr, size, position);
+    }
+
+    auto& page = *page_ptr;
+    const auto row_bytes = static_cast<size_t>(size.x) * BYTES_PER_PIXEL;
+    const auto page_row_bytes = static_cast<size_t>(_page_size.x) * BYTES_PER_PIXEL;
+
+    for (int32_t row = 0; row < size.y; row++)
+    {
+        const auto* src_ptr = pixels.data() + row_bytes * row;
+        auto* dst_ptr = page.pixels.data() + page_row_bytes * (position.y + row) +
+                        static_cast<size_t>(position.x) * BYTES_PER_PIXEL;
+        std::memcpy(dst_ptr, src_ptr, row_bytes);
+    }
+
+    page.changed = true;
+
+    const auto page_size = glm::vec2 { _page_size };
+    return AtlasRegion {
+        .texture_id = page.texture_id,
+        .uv_rect = glm::vec4 { glm::vec2 { position } / page_size,
+                               glm::vec2 { size } / page_size },
+        .size = size,
+    };
+}
+
+void TextureAtlas::upload_pages()
+{
+    for (auto& page : _pages)
+    {
+        if (!page.changed)
+        {
+            continue;
+        }
+
+        _ctx.set_texture_data(page.texture_id, page.pixels.data());
+        page.changed = false;
+    }
+}
+
+bool TextureAtlas::try_place(Page& page, glm::ivec2 size, glm::ivec2& position)
+{
+    const auto gapped_size = size + IMAGE_GAP;
+
+    // The lowest shelf the image fits into wastes the least height
+    Shelf* best_shelf = nullptr;
+    for (auto& shelf : page.shelves)
+    {
+        const auto fits = shelf.height >= size.y &&
+                          shelf.next_x + size.x <= _page_size.x;
+        if (fits && (best_shelf == nullptr || shelf.height < best_shelf->height))
+        {
+            best_shelf = &shelf;
+        }
+    }
+
+    if (best_shelf == nullptr)
+    {
+        if (page.next_shelf_y + size.y > _page_size.y)
+        {
+            return false;
+        }
+
+        page.shelves.push_back(Shelf {
+            .y = page.next_shelf_y,
+            .height = size.y,
+            .next_x = 0,
+        });
+        page.next_shelf_y += gapped_size.y;
+        best_shelf = &page.shelves.back();
+    }
+
+    position = glm::ivec2 { best_shelf->next_x, best_shelf->y };
+    best_shelf->next_x += gapped_size.x;
+
+    return true;
+}
+
+TextureAtlas::Page& TextureAtlas::add_page()
+{
+    const auto page_bytes =
+        static_cast<size_t>(_page_size.x * _page_size.y) * BYTES_PER_PIXEL;
+
+    TextureManager::EvictionCallback on_evicted {};
+    if (_on_page_evicted)
+    {
+        on_evicted = [this](DivisionId texture_id) { evict_page(texture_id); };
+    }
+
+    // Acquiring may evict the other pages, so the page is added after it
+    const auto texture_id = _texture_manager.acquire(
+        _page_size,
+        DivisionTextureFormat::DIVISION_TEXTURE_FORMAT_RGBA32Uint,
+        TextureSubsystem::Atlas,
+        std::move(on_evicted)
+    );
+
+    return _pages.emplace_back(Page {
+        .texture_id = texture_id,
+        .pixels = std::vector<uint8_t>(page_bytes, 0),
+        .shelves = {},
+        .next_shelf_y = 0,
+        .changed = true,
+    });
+}
+
+void TextureAtlas::evict_page(DivisionId texture_id)
+{
+    std::erase_if(_pages, [&](const Page& page) { return page.texture_id == texture_id; });
+    _on_page_evicted(texture_id);
+}
+}
@@ -0,0 +1,192 @@
+#include "core/texture_manager.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace division_engine::core
+{
+TextureManager::TextureManager(Context& context, size_t budget_bytes)
+  : _ctx(context)
+  , _textures()
+  , _pools()
+  , _subsystem_bytes()
+  , _budget_bytes(budget_bytes)
+  , _live_bytes(0)
+  , _pooled_bytes(0)
+  , _peak_bytes(0)
+  , _frame(0)
+{
+}
+
+TextureManager::~TextureManager()
+{
+    for (const auto& [texture_id, _] : _textures)
+    {
+        _ctx.delete_texture(texture_id);
+    }
+
+    free_pools();
+}
+
+DivisionId TextureManager::acquire(
+    glm::ivec2 size,
+    DivisionTextureFormat format,
+    TextureSubsystem subsystem,
+    EvictionCallback on_evicted
+)
+{
+    const auto bytes = texture_bytes(size, format);
+    DivisionId texture_id {};
+
+    auto& pool = _pools[BucketKey { size, format }];
+    if (!pool.empty())
+    {
+        texture_id = pool.back();
+        pool.pop_back();
+        _pooled_bytes -= bytes;
+    }
+    else
+    {
+        enforce_budget(bytes);
+        texture_id = _ctx.create_texture(size, format);
+    }
+
+    _textures.insert_or_assign(
+        texture_id,
+        Texture {
+            .size = size,
+            .format = format,
+            .subsystem = subsystem,
+            .last_used_frame = _frame,
+            .on_evicted = std::move(on_evicted),
+        }
+    );
+
+    _live_bytes += bytes;
+    _subsystem_bytes[static_cast<size_t>(subsystem)] += bytes;
+    _peak_bytes = std::max(_peak_bytes, current_bytes());
+
+    return texture_id;
+}
+
+void TextureManager::release(DivisionId texture_id)
+{
+    const auto it = _textures.find(texture_id);
+    if (it == _textures.end())
+    {
+        throw Exception { "The texture isn't owned by the texture manager" };
+    }
+
+    const auto& texture = it->second;
+    const auto bytes = texture_bytes(texture.size, texture.format);
+
+    _live_bytes -= bytes;
+    _subsystem_bytes[static_cast<size_t>(texture.subsystem)] -= bytes;
+
+    if (current_bytes() + bytes <= _budget_bytes)
+    {
+        _pools[BucketKey { texture.size, texture.format }].push_back(texture_id);
+        _pooled_bytes += bytes;
+    }
+    else
+    {
+        _ctx.delete_texture(texture_id);
+    }
+
+    _textures.erase(it);
+}
+
+void TextureManager::set_budget(size_t budget_bytes)
+{
+    _budget_bytes = budget_bytes;
+    enforce_budget(0);
+}
+
+size_t TextureManager::texture_bytes(glm::ivec2 size, DivisionTextureFormat format)
+{
+    size_t bytes_per_pixel = 0;
+    switch (format)
+    {
+        case DIVISION_TEXTURE_FORMAT_R8Uint:
+            bytes_per_pixel = 1;
+            break;
+        case DIVISION_TEXTURE_FORMAT_RGB24Uint:
+            bytes_per_pixel = 3;
+            break;
+        case DIVISION_TEXTURE_FORMAT_RGBA32Uint:
+            bytes_per_pixel = 4;
+            break;
+    }
+
+    return static_cast<size_t>(size.x) * static_cast<size_t>(size.y) * bytes_per_pixel;
+}
+
+void TextureManager::enforce_budget(size_t incoming_bytes)
+{
+    const auto over_budget = [&]
+    { return current_bytes() + incoming_bytes > _budget_bytes; };
+
+    if (!over_budget())
+    {
+        return;
+    }
+
+    free_pools();
+
+    // The budget is soft: the textures that can't be evicted stay alive
+    while (over_budget() && evict_least_recently_used())
+    {
+    }
+}
+
+void TextureManager::free_pools()
+{
+    for (auto& [key, pool] : _pools)
+    {
+        for (const auto texture_id : pool)
+        {
+            _ctx.delete_texture(texture_id);
+        }
+        pool.clear();
+    }
+
+    _pooled_bytes = 0;
+}
+
+bool TextureManager::evict_least_recently_used()
+{
+    auto lru_it = _textures.end();
+    for (auto it = _textures.begin(); it != _textures.end(); it++)
+    {
+        // The textures of the current frame may already be bound to its passes,
+        // the ones of the previous frame are still on screen
+        if (!it->second.on_evicted || it->second.last_used_frame + 1 >= _frame)
+        {
+            continue;
+        }
+
+        if (lru_it == _textures.end() ||
+            it->second.last_used_frame < lru_it->second.last_used_frame)
+        {
+            lru_it = it;
+        }
+    }
+
+    if (lru_it == _textures.end())
+    {
+        return false;
+    }
+
+    const auto texture_id = lru_it->first;
+    const auto texture = std::move(lru_it->second);
+    const auto bytes = texture_bytes(texture.size, texture.format);
+
+    _textures.erase(lru_it);
+    _live_bytes -= bytes;
+    _subsystem_bytes[static_cast<size_t>(texture.subsystem)] -= bytes;
+    _ctx.delete_texture(texture_id);
+
+    texture.on_evicted(texture_id);
+    return true;
+}
+}
@@ -0,0 +1,126 @@
+#include "recording_backend.hpp"
+
+#include "division_engine/canvas/animator.hpp"
+#include "division_engine/canvas/components/animated.hpp"
+#include "division_engine/canvas/components/render_bounds.hpp"
+#include "division_engine/canvas/components/renderable_rect.hpp"
+#include "division_engine/canvas/rect.hpp"
+#include "division_engine/canvas/render_manager.hpp"
+#include "division_engine/canvas/state.hpp"
+#include "division_engine/canvas/view_tree/decorated_box.hpp"
+#include "division_engine/color.hpp"
+
+#include <flecs.h>
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <tuple>
+
+using namespace division_engine;
+using namespace division_engine::canvas;
+using namespace division_engine::canvas::view_tree;
+using division_engine::tests::RecordingBackend;
+
+namespace
+{
+const auto SCREEN_SIZE = glm::vec2 { 512 };
+const float EPSILON = 1e-3;
+
+flecs::entity create_rect(State& state, RenderManager& render_manager)
+{
+    return render_manager.create_renderer(
+        state,
+        std::make_tuple(
+            components::RenderableRect { .color = color::RED },
+            components::RenderBounds {
+                Rect::from_center(glm::vec2 { 0 }, glm::vec2 { 10 }) }
+        )
+    );
+}
+
+float center_x(flecs::entity entity)
+{
+    return entity.get<components::RenderBounds>()->value.center.x;
+}
+
+bool near(float value, float expected)
+{
+    return std::abs(value - expected) < EPSILON;
+}
+
+void move_x(State& state, flecs::entity entity, float x, float duration)
+{
+    state.animator.move_to(entity, glm::vec2 { x, 0 }, duration, Easing::Linear);
+}
+}
+
+int main()
+{
+    RecordingBackend backend { SCREEN_SIZE };
+    State state { backend.context() };
+    RenderManager render_manager;
+
+    const auto first = create_rect(state, render_manager);
+    const auto second = create_rect(state, render_manager);
+    const auto third = create_rect(state, render_manager);
+
+    move_x(state, first, 100, 1);
+    move_x(state, second, 100, 2);
+    move_x(state, third, 100, 4);
+    DIVISION_CHECK(state.animator.size() == 3);
+
+    state.world.progress(0.5f);
+    DIVISION_CHECK(near(center_x(first), 50));
+    DIVISION_CHECK(near(center_x(second), 25));
+    DIVISION_CHECK(near(center_x(third), 12.5f));
+
+    // The finished tween writes the target, then the last tween is moved into
+    // its place and keeps running from where it was
+    state.world.progress(0.5f);
+    DIVISION_CHECK(near(center_x(first), 100));
+    state.world.progress(0.5f);
+    DIVISION_CHECK(state.animator.size() == 2);
+    DIVISION_CHECK(!first.has<components::Animated>());
+    DIVISION_CHECK(near(center_x(first), 100));
+    DIVISION_CHECK(near(center_x(second), 75));
+    DIVISION_CHECK(near(center_x(third), 37.5f));
+
+    // A stopped tween keeps the last written value
+    state.animator.stop(second, AnimatedProperty::Position);
+    state.world.progress(0.5f);
+    state.world.progress(0.5f);
+    DIVISION_CHECK(state.animator.size() == 1);
+    DIVISION_CHECK(near(center_x(second), 75));
+    DIVISION_CHECK(near(center_x(third), 62.5f));
+
+    // A replaced tween continues from the current value to the new target
+    move_x(state, third, 0, 1);
+    DIVISION_CHECK(state.animator.size() == 1);
+    state.world.progress(0.5f);
+    DIVISION_CHECK(near(center_x(third), 31.25f));
+    state.world.progress(0.5f);
+    state.world.progress(0.5f);
+    DIVISION_CHECK(state.animator.size() == 0);
+    DIVISION_CHECK(near(center_x(third), 0));
+
+    // The view tree renderer writes its view only when the view changes, so
+    // a finished tween of its color stays
+    {
+        const DecoratedBox view { .background_color = color::RED };
+        DecoratedBox::Renderer renderer { state, render_manager, view };
+        auto rect = Rect::from_center(glm::vec2 { 0 }, glm::vec2 { 10 });
+        renderer.render(state, render_manager, rect, view);
+
+        state.animator.fade_to(renderer.entity, color::GREEN, 0.5f, Easing::Linear);
+        state.world.progress(0.5f);
+        state.world.progress(0.5f);
+        renderer.render(state, render_manager, rect, view);
+        DIVISION_CHECK(
+            renderer.entity.get<components::RenderableRect>()->color == color::GREEN
+        );
+    }
+
+    return division_engine::tests::failure_count == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
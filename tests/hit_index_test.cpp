@@ -0,0 +1,199 @@
+#include "recording_backend.hpp"
+
+#include "division_engine/canvas/components/pointer_handler.hpp"
+#include "division_engine/canvas/components/render_bounds.hpp"
+#include "division_engine/canvas/components/renderable_rect.hpp"
+#include "division_engine/canvas/hit_index.hpp"
+#include "division_engine/canvas/rect.hpp"
+#include "division_engine/canvas/render_manager.hpp"
+#include "division_engine/canvas/state.hpp"
+#include "division_engine/core/input_event.hpp"
+#include "division_engine/core/input_queue.hpp"
+
+#include <flecs.h>
+#include <glm/vec2.hpp>
+
+#include <cstdlib>
+#include <tuple>
+#include <vector>
+
+using namespace division_engine;
+using namespace division_engine::canvas;
+using division_engine::tests::RecordingBackend;
+
+namespace
+{
+const auto SCREEN_SIZE = glm::vec2 { 512 };
+const size_t SMALL_RENDERER_COUNT = 2000;
+const float SMALL_RENDERER_SIZE = 4;
+const size_t LARGE_RENDERER_COUNT = 200;
+const float LARGE_RENDERER_SIZE = 300;
+
+struct Hit
+{
+    flecs::entity_t entity;
+    core::InputEventType type;
+};
+
+core::InputEvent pointer_down(glm::vec2 position)
+{
+    return core::InputEvent { .type = core::InputEventType::PointerDown,
+                              .position = position };
+}
+
+flecs::entity create_target(
+    State& state,
+    RenderManager& render_manager,
+    const Rect& bounds,
+    std::vector<Hit>& hits
+)
+{
+    return render_manager.create_renderer(
+        state,
+        std::make_tuple(
+            components::RenderableRect {},
+            components::RenderBounds { bounds },
+            components::PointerHandler {
+                [&hits](flecs::entity entity, const core::InputEvent& event)
+                { hits.push_back(Hit { entity.id(), event.type }); } }
+        )
+    );
+}
+}
+
+int main()
+{
+    RecordingBackend backend { SCREEN_SIZE };
+    State state { backend.context() };
+    RenderManager render_manager;
+    core::InputQueue input_queue;
+    std::vector<Hit> hits;
+
+    const auto below = create_target(
+        state,
+        render_manager,
+        Rect::from_bottom_left(glm::vec2 { 0 }, glm::vec2 { 200 }),
+        hits
+    );
+    const auto above = create_target(
+        state,
+        render_manager,
+        Rect::from_bottom_left(glm::vec2 { 100 }, glm::vec2 { 200 }),
+        hits
+    );
+    render_manager.update(state);
+
+    // The events reach the topmost renderer under the pointer in the posted
+    // order, and the ones over nothing are dropped
+    input_queue.post(pointer_down(glm::vec2 { 50 }));
+    input_queue.post(pointer_down(glm::vec2 { 150 }));
+    input_queue.post(core::InputEvent { .type = core::InputEventType::PointerUp,
+                                        .position = glm::vec2 { 250 } });
+    input_queue.post(pointer_down(glm::vec2 { 450 }));
+    state.dispatch_input(input_queue);
+    DIVISION_CHECK(hits.size() == 3);
+    if (hits.size() == 3)
+    {
+        DIVISION_CHECK(hits[0].entity == below.id());
+        DIVISION_CHECK(hits[1].entity == above.id());
+        DIVISION_CHECK(hits[2].entity == above.id());
+        DIVISION_CHECK(hits[2].type == core::InputEventType::PointerUp);
+    }
+    hits.clear();
+
+    // The bounds written in place by a system are reindexed in the same frame
+    bool move_above = true;
+    auto mover = state.world.system<components::RenderBounds>().each(
+        [&](flecs::entity entity, components::RenderBounds& bounds)
+        {
+            if (move_above && entity == above)
+            {
+                bounds.value =
+                    Rect::from_bottom_left(glm::vec2 { 300 }, glm::vec2 { 200 });
+            }
+        }
+    );
+    render_manager.update(state);
+    move_above = false;
+
+    input_queue.post(pointer_down(glm::vec2 { 150 }));
+    input_queue.post(pointer_down(glm::vec2 { 450 }));
+    state.dispatch_input(input_queue);
+    DIVISION_CHECK(hits.size() == 2);
+    if (hits.size() == 2)
+    {
+        DIVISION_CHECK(hits[0].entity == below.id());
+        DIVISION_CHECK(hits[1].entity == above.id());
+    }
+    hits.clear();
+    mover.destruct();
+
+    // Many small renderers shrink the cells, and the queries still find the
+    // renderers after the grid is rebuilt
+    DIVISION_CHECK(state.hit_index.cell_size() == HitIndex::DEFAULT_CELL_SIZE);
+    std::vector<Hit> small_hits;
+    flecs::entity last_small;
+    for (size_t i = 0; i < SMALL_RENDERER_COUNT; i++)
+    {
+        const auto column = static_cast<float>(i % 100);
+        const auto row = static_cast<float>(i / 100);
+        last_small = create_target(
+            state,
+            render_manager,
+            Rect::from_bottom_left(
+                glm::vec2 { column, row } * SMALL_RENDERER_SIZE,
+                glm::vec2 { SMALL_RENDERER_SIZE }
+            ),
+            small_hits
+        );
+    }
+    render_manager.update(state);
+    DIVISION_CHECK(state.hit_index.cell_size() < HitIndex::DEFAULT_CELL_SIZE);
+
+    const auto last_center = last_small.get<components::RenderBounds>()->value.center;
+    input_queue.post(pointer_down(last_center));
+    input_queue.post(pointer_down(glm::vec2 { 450 }));
+    state.dispatch_input(input_queue);
+    DIVISION_CHECK(small_hits.size() == 1);
+    DIVISION_CHECK(!small_hits.empty() && small_hits[0].entity == last_small.id());
+    DIVISION_CHECK(hits.size() == 1);
+    DIVISION_CHECK(!hits.empty() && hits[0].entity == above.id());
+    hits.clear();
+
+    // Many renderers spanning too many cells go to the coarse cells, so the
+    // queries don't check each of them
+    std::vector<Hit> large_hits;
+    std::vector<flecs::entity> large;
+    for (size_t i = 0; i < LARGE_RENDERER_COUNT; i++)
+    {
+        large.push_back(create_target(
+            state,
+            render_manager,
+            Rect::from_bottom_left(
+                glm::vec2 { static_cast<float>(i) }, glm::vec2 { LARGE_RENDERER_SIZE }
+            ),
+            large_hits
+        ));
+    }
+    render_manager.update(state);
+    const auto cells_per_side = LARGE_RENDERER_SIZE / state.hit_index.cell_size();
+    DIVISION_CHECK(
+        cells_per_side * cells_per_side >
+        static_cast<float>(HitIndex::MAX_CELLS_PER_RENDERER)
+    );
+    DIVISION_CHECK(state.hit_index.unbounded_size() == 0);
+
+    input_queue.post(pointer_down(glm::vec2 { 250 }));
+    input_queue.post(pointer_down(glm::vec2 { 2.5f }));
+    state.dispatch_input(input_queue);
+    DIVISION_CHECK(large_hits.size() == 2);
+    if (large_hits.size() == 2)
+    {
+        DIVISION_CHECK(large_hits[0].entity == large.back().id());
+        DIVISION_CHECK(large_hits[1].entity == large[2].id());
+    }
+    DIVISION_CHECK(small_hits.size() == 1);
+    DIVISION_CHECK(hits.empty());
+
+    return division_engine::tests::failure_count == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,117 @@
+#include "recording_backend.hpp"
+
+#include "division_engine/canvas/components/render_bounds.hpp"
+#include "division_engine/canvas/components/render_texture.hpp"
+#include "division_engine/canvas/components/renderable_rect.hpp"
+#include "division_engine/canvas/rect.hpp"
+#include "division_engine/canvas/rect_drawer.hpp"
+#include "division_engine/canvas/render_manager.hpp"
+#include "division_engine/canvas/state.hpp"
+
+#include <flecs.h>
+#include <glm/vec2.hpp>
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <thread>
+
+using namespace division_engine;
+using namespace division_engine::canvas;
+using division_engine::tests::RecordingBackend;
+
+namespace
+{
+const auto SCREEN_SIZE = glm::vec2 { 512 };
+const auto IMAGE_PATH = std::filesystem::path { "resources" } / "images" / "nevsky.jpg";
+const size_t MAX_WAIT_FRAMES = 5000;
+const auto WAIT_FRAME_DURATION = std::chrono::milliseconds { 1 };
+
+void draw_frame(State& state, RenderManager& render_manager)
+{
+    state.update();
+    render_manager.update(state);
+    state.render_queue.draw(state.context.get_ptr(), state.clear_color);
+}
+
+bool is_uploaded(State& state, flecs::entity image_batch)
+{
+    return image_batch.get<components::RenderTexture>()->texture_id !=
+           state.white_texture_id;
+}
+
+// Draws the frames until the image of the batch is uploaded
+bool wait_upload(State& state, RenderManager& render_manager, flecs::entity image_batch)
+{
+    for (size_t i = 0; i < MAX_WAIT_FRAMES && !is_uploaded(state, image_batch); i++)
+    {
+        std::this_thread::sleep_for(WAIT_FRAME_DURATION);
+        draw_frame(state, render_manager);
+    }
+
+    return is_uploaded(state, image_batch);
+}
+
+flecs::entity draw_image(
+    State& state,
+    RenderManager& render_manager,
+    flecs::entity image_batch,
+    glm::vec2 center
+)
+{
+    return render_manager.acquire_renderer(
+        state,
+        RectDrawer::renderable_type {
+            components::RenderableRect {},
+            components::RenderBounds { Rect::from_center(center, glm::vec2 { 64 }) },
+        },
+        image_batch.id()
+    );
+}
+}
+
+int main()
+{
+    RecordingBackend backend { SCREEN_SIZE };
+    State state { backend.context() };
+    RenderManager render_manager;
+    render_manager.register_renderer<RectDrawer>(state);
+
+    const auto visible_batch = state.load_image(IMAGE_PATH);
+    const auto visible =
+        draw_image(state, render_manager, visible_batch, glm::vec2 { 100 });
+    DIVISION_CHECK(wait_upload(state, render_manager, visible_batch));
+    draw_frame(state, render_manager);
+
+    // The budget only fits the visible image, so the next upload goes over it
+    // instead of evicting the image on screen
+    state.texture_manager.set_budget(state.texture_manager.current_bytes() + 1);
+
+    const auto streamed_batch = state.load_image(IMAGE_PATH);
+    draw_image(state, render_manager, streamed_batch, glm::vec2 { 300 });
+    DIVISION_CHECK(wait_upload(state, render_manager, streamed_batch));
+    draw_frame(state, render_manager);
+    DIVISION_CHECK(is_uploaded(state, visible_batch));
+
+    // An image that is no longer drawn is evicted by the next upload
+    state.renderer_pool.release(
+        visible,
+        render_manager.batch_for<components::RenderableRect, components::RenderBounds>(
+            state, visible_batch.id()
+        )
+    );
+    draw_frame(state, render_manager);
+    draw_frame(state, render_manager);
+
+    const auto third_batch = state.load_image(IMAGE_PATH);
+    draw_image(state, render_manager, third_batch, glm::vec2 { 400 });
+    DIVISION_CHECK(wait_upload(state, render_manager, third_batch));
+    DIVISION_CHECK(!is_uploaded(state, visible_batch));
+    DIVISION_CHECK(is_uploaded(state, streamed_batch));
+
+    // Drawing the batch again reloads the evicted image
+    draw_image(state, render_manager, visible_batch, glm::vec2 { 100 });
+    DIVISION_CHECK(wait_upload(state, render_manager, visible_batch));
+
+    return division_engine::tests::failure_count == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,108 @@
+#include "recording_backend.hpp"
+
+#include "division_engine/canvas/components/render_order.hpp"
+#include "division_engine/canvas/rect.hpp"
+#include "division_engine/canvas/render_manager.hpp"
+#include "division_engine/canvas/state.hpp"
+#include "division_engine/canvas/view_tree/decorated_box.hpp"
+#include "division_engine/canvas/view_tree/keyed_list.hpp"
+#include "division_engine/canvas/view_tree/list.hpp"
+#include "division_engine/canvas/view_tree/render_entities.hpp"
+#include "division_engine/color.hpp"
+
+#include <flecs.h>
+#include <glm/vec2.hpp>
+
+#include <cstdlib>
+#include <initializer_list>
+#include <vector>
+
+using namespace division_engine;
+using namespace division_engine::canvas;
+using namespace division_engine::canvas::view_tree;
+using division_engine::tests::RecordingBackend;
+
+namespace
+{
+const auto SCREEN_SIZE = glm::vec2 { 512 };
+
+using keyed_list_type = KeyedList<int, DecoratedBox>;
+// The overlay follows the list in the tree, so it is drawn above every item
+using tree_type = VerticalList<keyed_list_type, DecoratedBox>;
+
+tree_type make_tree(std::initializer_list<int> keys)
+{
+    keyed_list_type list;
+    for (const auto key : keys)
+    {
+        list.items.push_back(keyed_list_type::Item {
+            .key = key,
+            .view = DecoratedBox { .background_color = color::RED },
+        });
+    }
+
+    return tree_type { list, DecoratedBox { .background_color = color::BLUE } };
+}
+
+uint64_t render_order_of(flecs::entity entity)
+{
+    return entity.get<components::RenderOrder>()->sort_key();
+}
+
+// The items are drawn in the list order and the overlay above all of them
+void check_orders(const tree_type::Renderer& renderer)
+{
+    std::vector<flecs::entity> entities;
+    collect_render_entities(renderer, entities);
+    DIVISION_CHECK(entities.size() >= 2);
+
+    for (size_t i = 1; i < entities.size(); i++)
+    {
+        DIVISION_CHECK(render_order_of(entities[i - 1]) < render_order_of(entities[i]));
+    }
+}
+
+void render(
+    State& state,
+    RenderManager& render_manager,
+    tree_type::Renderer& renderer,
+    const tree_type& tree
+)
+{
+    auto rect = Rect::from_bottom_left(glm::vec2 { 0 }, SCREEN_SIZE);
+    renderer.render(state, render_manager, rect, tree);
+}
+}
+
+int main()
+{
+    RecordingBackend backend { SCREEN_SIZE };
+    State state { backend.context() };
+    RenderManager render_manager;
+
+    auto tree = make_tree({ 1, 2, 3 });
+    tree_type::Renderer renderer { state, render_manager, tree };
+    render(state, render_manager, renderer, tree);
+    check_orders(renderer);
+
+    // Appended items are created on top of the layer and placed under the
+    // overlay
+    tree = make_tree({ 1, 2, 3, 4, 5 });
+    render(state, render_manager, renderer, tree);
+    check_orders(renderer);
+
+    // The moved items are placed between their new neighbours or under the
+    // overlay
+    tree = make_tree({ 5, 1, 3, 2, 6, 4 });
+    render(state, render_manager, renderer, tree);
+    check_orders(renderer);
+
+    // A list emptied and filled again keeps the overlay on top
+    tree = make_tree({});
+    render(state, render_manager, renderer, tree);
+    tree = make_tree({ 7, 8 });
+    render(state, render_manager, renderer, tree);
+    check_orders(renderer);
+
+    return division_engine::tests::failure_count == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,104 @@
+#include "recording_backend.hpp"
+
+#include "division_engine/canvas/components/render_bounds.hpp"
+#include "division_engine/canvas/flat_layout.hpp"
+#include "division_engine/canvas/rect.hpp"
+#include "division_engine/canvas/render_manager.hpp"
+#include "division_engine/canvas/size.hpp"
+#include "division_engine/canvas/state.hpp"
+#include "division_engine/canvas/view_tree/decorated_box.hpp"
+#include "division_engine/canvas/view_tree/flat_render.hpp"
+#include "division_engine/canvas/view_tree/list.hpp"
+#include "division_engine/canvas/view_tree/render_entities.hpp"
+#include "division_engine/canvas/view_tree/sized_box.hpp"
+#include "division_engine/color.hpp"
+
+#include <flecs.h>
+#include <glm/vec2.hpp>
+
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+using namespace division_engine;
+using namespace division_engine::canvas;
+using namespace division_engine::canvas::view_tree;
+using division_engine::tests::RecordingBackend;
+
+namespace
+{
+const auto SCREEN_SIZE = glm::vec2 { 512 };
+const auto SCREEN_RECT = Rect::from_bottom_left(glm::vec2 { 0 }, SCREEN_SIZE);
+const auto FIXED_SIZE = glm::vec2 { 100, 300 };
+const float EPSILON = 1e-3;
+
+using fixed_type = SizedBox<DecoratedBox>;
+using tree_type = VerticalList<fixed_type, fixed_type, DecoratedBox>;
+
+tree_type make_tree()
+{
+    const fixed_type fixed { Size { FIXED_SIZE }, DecoratedBox {} };
+    return tree_type { fixed, fixed, DecoratedBox { .background_color = color::RED } };
+}
+
+bool near(const Rect& rect, const Rect& expected)
+{
+    return std::abs(rect.left() - expected.left()) < EPSILON &&
+           std::abs(rect.right() - expected.right()) < EPSILON &&
+           std::abs(rect.bottom() - expected.bottom()) < EPSILON &&
+           std::abs(rect.top() - expected.top()) < EPSILON;
+}
+
+void check_bounds(const tree_type::Renderer& renderer)
+{
+    // The second fixed child is clamped to the space the first one left, and
+    // the filled child gets none of it
+    const auto top = SCREEN_RECT.top();
+    const auto clamped_extent = SCREEN_SIZE.y - FIXED_SIZE.y;
+    const std::array expected {
+        Rect::from_top_left(glm::vec2 { 0, top }, FIXED_SIZE),
+        Rect::from_top_left(
+            glm::vec2 { 0, top - FIXED_SIZE.y },
+            glm::vec2 { FIXED_SIZE.x, clamped_extent }
+        ),
+        Rect::from_top_left(glm::vec2 { 0, 0 }, glm::vec2 { SCREEN_SIZE.x, 0 }),
+    };
+
+    std::vector<flecs::entity> entities;
+    collect_render_entities(renderer, entities);
+    DIVISION_CHECK(entities.size() == expected.size());
+    for (size_t i = 0; i < entities.size() && i < expected.size(); i++)
+    {
+        const auto& bounds = entities[i].get<components::RenderBounds>()->value;
+        DIVISION_CHECK(near(bounds, expected[i]));
+    }
+}
+}
+
+int main()
+{
+    RecordingBackend backend { SCREEN_SIZE };
+    State state { backend.context() };
+    RenderManager render_manager;
+    const auto tree = make_tree();
+
+    // The children are measured once against the space left by the previous
+    // ones, and placed with these sizes
+    {
+        tree_type::Renderer renderer { state, render_manager, tree };
+        auto rect = SCREEN_RECT;
+        renderer.render(state, render_manager, rect, tree);
+        check_bounds(renderer);
+    }
+
+    // The flat layout places the children the same way
+    {
+        tree_type::Renderer renderer { state, render_manager, tree };
+        FlatLayout layout;
+        render_flat(state, render_manager, layout, renderer, tree, SCREEN_RECT);
+        check_bounds(renderer);
+    }
+
+    return division_engine::tests::failure_count == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,300 @@
+#include "recording_backend.hpp"
+
+#include <division_engine_core/context.h>
+#include <division_engine_core/font.h>
+#include <division_engine_core/render_pass_descriptor.h>
+#include <division_engine_core/render_pass_instance.h>
+#include <division_engine_core/renderer.h>
+#include <division_engine_core/shader.h>
+#include <division_engine_core/texture.h>
+#include <division_engine_core/uniform_buffer.h>
+#include <division_engine_core/vertex_buffer.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace division_engine::tests
+{
+namespace
+{
+// Larger than every vertex and instance struct of the engine, since the
+// attribute settings don't tell the padding of the structs
+const size_t MAX_ELEMENT_BYTES = 256;
+const int32_t GLYPH_SIZE = 8;
+
+RecordingBackend* current_backend = nullptr;
+}
+
+RecordingBackend::RecordingBackend(glm::vec2 screen_size)
+  : _renderer_context()
+  , _context()
+  , _next_id(1)
+{
+    assert(current_backend == nullptr);
+    current_backend = this;
+
+    _renderer_context.frame_buffer_width = screen_size.x;
+    _renderer_context.frame_buffer_height = screen_size.y;
+    _context.renderer_context = &_renderer_context;
+    _context.user_data = this;
+}
+
+RecordingBackend::~RecordingBackend()
+{
+    current_backend = nullptr;
+}
+
+RecordingBackend& RecordingBackend::current()
+{
+    assert(current_backend != nullptr);
+    return *current_backend;
+}
+
+DivisionId RecordingBackend::create_uniform(size_t size)
+{
+    const auto id = create_resource();
+    _uniforms[id].resize(size);
+    return id;
+}
+
+void* RecordingBackend::uniform_data(DivisionId uniform_id)
+{
+    return _uniforms.at(uniform_id).data();
+}
+
+DivisionId
+RecordingBackend::create_vertex_buffer(const DivisionVertexBufferConstSettings& settings)
+{
+    const auto id = create_resource();
+    _vertex_buffers.emplace(id, VertexBuffer {});
+    resize_vertex_buffer(id, settings.size);
+    return id;
+}
+
+void RecordingBackend::resize_vertex_buffer(
+    DivisionId vertex_buffer_id,
+    DivisionVertexBufferSize size
+)
+{
+    auto& buffer = _vertex_buffers.at(vertex_buffer_id);
+    buffer.size = size;
+    buffer.vertices.resize(size.vertex_count * MAX_ELEMENT_BYTES);
+    buffer.instances.resize(size.instance_count * MAX_ELEMENT_BYTES);
+    buffer.indices.resize(size.index_count);
+}
+
+DivisionVertexBufferBorrowedData
+RecordingBackend::borrow_vertex_buffer(DivisionId vertex_buffer_id)
+{
+    auto& buffer = _vertex_buffers.at(vertex_buffer_id);
+
+    DivisionVertexBufferBorrowedData data {};
+    data.vertex_data_ptr = buffer.vertices.data();
+    data.instance_data_ptr = buffer.instances.data();
+    data.index_data_ptr = buffer.indices.data();
+    data.size = buffer.size;
+    return data;
+}
+
+void RecordingBackend::free_resource(DivisionId id)
+{
+    _uniforms.erase(id);
+    _vertex_buffers.erase(id);
+}
+
+void RecordingBackend::record_draw(
+    std::span<const DivisionRenderPassInstance> passes,
+    bool cleared
+)
+{
+    _draw_calls.push_back(DrawCall {
+        .cleared = cleared,
+        .passes = { passes.begin(), passes.end() },
+    });
+}
+}
+
+using division_engine::tests::GLYPH_SIZE;
+using division_engine::tests::RecordingBackend;
+
+extern "C"
+{
+bool division_engine_context_initialize(const DivisionSettings*, DivisionContext*)
+{
+    return true;
+}
+
+void division_engine_context_finalize(DivisionContext*) {}
+
+void division_engine_context_register_lifecycle(
+    DivisionContext*,
+    const DivisionLifecycle*
+)
+{
+}
+
+void division_engine_renderer_run_loop(DivisionContext*) {}
+
+bool division_engine_shader_program_alloc(
+    DivisionContext*,
+    const DivisionShaderSourceDescriptor*,
+    int32_t,
+    DivisionId* out_shader_program_id
+)
+{
+    *out_shader_program_id = RecordingBackend::current().create_resource();
+    return true;
+}
+
+void division_engine_shader_program_free(DivisionContext*, DivisionId) {}
+
+bool division_engine_vertex_buffer_alloc(
+    DivisionContext*,
+    const DivisionVertexBufferConstSettings* settings,
+    DivisionId* out_vertex_buffer_id
+)
+{
+    *out_vertex_buffer_id = RecordingBackend::current().create_vertex_buffer(*settings);
+    return true;
+}
+
+bool division_engine_vertex_buffer_resize(
+    DivisionContext*,
+    DivisionId vertex_buffer_id,
+    DivisionVertexBufferSize new_size
+)
+{
+    RecordingBackend::current().resize_vertex_buffer(vertex_buffer_id, new_size);
+    return true;
+}
+
+bool division_engine_vertex_buffer_borrow_data(
+    DivisionContext*,
+    DivisionId vertex_buffer_id,
+    DivisionVertexBufferBorrowedData* out_borrow_data
+)
+{
+    *out_borrow_data = RecordingBackend::current().borrow_vertex_buffer(vertex_buffer_id);
+    return true;
+}
+
+void division_engine_vertex_buffer_return_data(
+    DivisionContext*,
+    DivisionId,
+    DivisionVertexBufferBorrowedData*
+)
+{
+}
+
+void division_engine_vertex_buffer_free(DivisionContext*, DivisionId vertex_buffer_id)
+{
+    RecordingBackend::current().free_resource(vertex_buffer_id);
+}
+
+bool division_engine_uniform_buffer_alloc(
+    DivisionContext*,
+    DivisionUniformBufferDescriptor descriptor,
+    DivisionId* out_buffer_id
+)
+{
+    *out_buffer_id = RecordingBackend::current().create_uniform(descriptor.data_bytes);
+    return true;
+}
+
+void* division_engine_uniform_buffer_borrow_data_pointer(
+    DivisionContext*,
+    DivisionId buffer_id
+)
+{
+    return RecordingBackend::current().uniform_data(buffer_id);
+}
+
+void division_engine_uniform_buffer_return_data_pointer(
+    DivisionContext*,
+    DivisionId,
+    void*
+)
+{
+}
+
+void division_engine_uniform_buffer_free(DivisionContext*, DivisionId buffer_id)
+{
+    RecordingBackend::current().free_resource(buffer_id);
+}
+
+bool division_engine_texture_alloc(
+    DivisionContext*,
+    const DivisionTexture*,
+    DivisionId* out_texture_id
+)
+{
+    *out_texture_id = RecordingBackend::current().create_resource();
+    return true;
+}
+
+void division_engine_texture_set_data(DivisionContext*, DivisionId, const uint8_t*) {}
+
+void division_engine_texture_free(DivisionContext*, DivisionId) {}
+
+bool division_engine_render_pass_descriptor_alloc(
+    DivisionContext*,
+    const DivisionRenderPassDescriptor*,
+    DivisionId* out_render_pass_descriptor_id
+)
+{
+    *out_render_pass_descriptor_id = RecordingBackend::current().create_resource();
+    return true;
+}
+
+void division_engine_render_pass_instance_draw(
+    DivisionContext*,
+    const DivisionColor* clear_color,
+    const DivisionRenderPassInstance* render_pass_instances,
+    uint32_t render_pass_instance_count
+)
+{
+    RecordingBackend::current().record_draw(
+        { render_pass_instances, render_pass_instance_count }, clear_color != nullptr
+    );
+}
+
+bool division_engine_font_alloc(
+    DivisionContext*,
+    const char*,
+    uint32_t,
+    DivisionId* out_font_id
+)
+{
+    *out_font_id = RecordingBackend::current().create_resource();
+    return true;
+}
+
+bool division_engine_font_get_glyph(
+    DivisionContext*,
+    DivisionId,
+    int32_t,
+    DivisionFontGlyph* out_glyph
+)
+{
+    *out_glyph = DivisionFontGlyph {};
+    out_glyph->top = GLYPH_SIZE;
+    out_glyph->width = GLYPH_SIZE;
+    out_glyph->height = GLYPH_SIZE;
+    out_glyph->advance_x = GLYPH_SIZE;
+    return true;
+}
+
+bool division_engine_font_rasterize_glyph(
+    DivisionContext*,
+    DivisionId,
+    int32_t,
+    uint8_t* bitmap
+)
+{
+    std::memset(bitmap, 0, GLYPH_SIZE * GLYPH_SIZE);
+    return true;
+}
+
+void division_engine_font_free(DivisionContext*, DivisionId) {}
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <division_engine_core/context.h>
+#include <division_engine_core/types/render_pass_instance.h>
+#include <division_engine_core/types/vertex_buffer.h>
+#include <glm/vec2.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace division_engine::tests
+{
+// Stands in for division_engine_core: the resources live in memory, nothing
+// is drawn and every draw call is recorded. A single backend exists at a time
+class RecordingBackend
+{
+public:
+    struct DrawCall
+    {
+        // False when the frame buffer contents are loaded instead of cleared
+        bool cleared;
+        std::vector<DivisionRenderPassInstance> passes;
+    };
+
+    explicit RecordingBackend(glm::vec2 screen_size);
+    RecordingBackend(const RecordingBackend&) = delete;
+    RecordingBackend& operator=(const RecordingBackend&) = delete;
+    ~RecordingBackend();
+
+    DivisionContext* context() { return &_context; }
+
+    std::span<const DrawCall> draw_calls() const { return _draw_calls; }
+    void clear_draw_calls() { _draw_calls.clear(); }
+
+    static RecordingBackend& current();
+
+    // Used by the core functions
+    DivisionId create_resource() { return _next_id++; }
+    DivisionId create_uniform(size_t size);
+    void* uniform_data(DivisionId uniform_id);
+    DivisionId create_vertex_buffer(const DivisionVertexBufferConstSettings& settings);
+    void resize_vertex_buffer(DivisionId vertex_buffer_id, DivisionVertexBufferSize size);
+    DivisionVertexBufferBorrowedData borrow_vertex_buffer(DivisionId vertex_buffer_id);
+    void free_resource(DivisionId id);
+    void record_draw(std::span<const DivisionRenderPassInstance> passes, bool cleared);
+
+private:
+    struct VertexBuffer
+    {
+        DivisionVertexBufferSize size;
+        std::vector<uint8_t> vertices;
+        std::vector<uint8_t> instances;
+        std::vector<uint32_t> indices;
+    };
+
+    DivisionRendererContext _renderer_context;
+    DivisionContext _context;
+    std::unordered_map<DivisionId, std::vector<uint8_t>> _uniforms;
+    std::unordered_map<DivisionId, VertexBuffer> _vertex_buffers;
+    std::vector<DrawCall> _draw_calls;
+    DivisionId _next_id;
+};
+
+inline int failure_count = 0;
+
+// Reports the failed check and lets the test continue
+#define DIVISION_CHECK(condition)                                                      \
+    do                                                                                 \
+    {                                                                                  \
+        if (!(condition))                                                              \
+        {                                                                              \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #condition \
+                      << std::endl;                                                    \
+            division_engine::tests::failure_count++;                                   \
+        }                                                                              \
+    } while (false)
+}
@@ -0,0 +1,160 @@
+#include "recording_backend.hpp"
+
+#include "division_engine/canvas/components/render_order.hpp"
+#include "division_engine/canvas/damage_tracker.hpp"
+#include "division_engine/canvas/rect.hpp"
+#include "division_engine/canvas/render_queue.hpp"
+#include "division_engine/core/context.hpp"
+
+#include <glm/vec2.hpp>
+#include <glm/vec4.hpp>
+
+#include <cstdlib>
+#include <vector>
+
+using namespace division_engine;
+using namespace division_engine::canvas;
+using division_engine::tests::RecordingBackend;
+
+namespace
+{
+const auto SCREEN_SIZE = glm::vec2 { 512 };
+const auto CLEAR_COLOR = glm::vec4 { 1 };
+const auto PRESERVED = FrameBufferContents::Preserved;
+const size_t BLOCK_COUNT = 4;
+const size_t BLOCK_INSTANCES = RenderQueue::BLOCK_INSTANCES;
+const float BLOCK_WIDTH = 128;
+
+// A pass of BLOCK_COUNT blocks laid out from left to right
+RenderQueue::Pass make_blocked_pass()
+{
+    RenderQueue::Pass pass {
+        .instance = DivisionRenderPassInstance {},
+        .order = components::RenderOrder {},
+    };
+    pass.instance.instance_count = BLOCK_COUNT * BLOCK_INSTANCES;
+
+    for (size_t i = 0; i < BLOCK_COUNT; i++)
+    {
+        pass.block_bounds.push_back(Rect::from_bottom_left(
+            glm::vec2 { static_cast<float>(i) * BLOCK_WIDTH, 0 },
+            glm::vec2 { BLOCK_WIDTH, 64 }
+        ));
+    }
+
+    pass.bounds = pass.block_bounds.front().united(pass.block_bounds.back());
+    return pass;
+}
+
+Rect block_point(size_t block)
+{
+    return Rect::from_center(
+        glm::vec2 { (static_cast<float>(block) + 0.5f) * BLOCK_WIDTH, 32 },
+        glm::vec2 { 4 }
+    );
+}
+}
+
+int main()
+{
+    RecordingBackend backend { SCREEN_SIZE };
+    core::Context context { backend.context() };
+
+    const auto screen_size_uniform_id = context.create_uniform<glm::vec2>();
+    RenderQueue queue { context, screen_size_uniform_id };
+    DamageTracker damage;
+
+    const auto blocked_pass = make_blocked_pass();
+    const int source = 0;
+    queue.retain_passes(&source, 0, { &blocked_pass, 1 });
+
+    // The first frame is always redrawn whole
+    queue.draw(backend.context(), CLEAR_COLOR, damage, PRESERVED);
+    DIVISION_CHECK(backend.draw_calls().size() == 1);
+    DIVISION_CHECK(backend.draw_calls()[0].cleared);
+    DIVISION_CHECK(backend.draw_calls()[0].passes.size() == 1);
+    DIVISION_CHECK(
+        backend.draw_calls()[0].passes[0].instance_count == BLOCK_COUNT * BLOCK_INSTANCES
+    );
+    backend.clear_draw_calls();
+
+    // A frame without damage loads the previous contents and draws nothing
+    queue.draw(backend.context(), CLEAR_COLOR, damage, PRESERVED);
+    DIVISION_CHECK(backend.draw_calls().size() == 1);
+    DIVISION_CHECK(!backend.draw_calls().empty() && !backend.draw_calls()[0].cleared);
+    DIVISION_CHECK(
+        !backend.draw_calls().empty() && backend.draw_calls()[0].passes.empty()
+    );
+    backend.clear_draw_calls();
+
+    // The frame is redrawn whole when the backend discards its contents
+    queue.draw(backend.context(), CLEAR_COLOR, damage, FrameBufferContents::Discarded);
+    DIVISION_CHECK(backend.draw_calls().size() == 1);
+    DIVISION_CHECK(!backend.draw_calls().empty() && backend.draw_calls()[0].cleared);
+    backend.clear_draw_calls();
+
+    // A region inside of a block redraws only that block, over the loaded frame
+    damage.add(block_point(2));
+    queue.draw(backend.context(), CLEAR_COLOR, damage, PRESERVED);
+    DIVISION_CHECK(backend.draw_calls().size() == 1);
+    if (backend.draw_calls().size() == 1)
+    {
+        const auto& draw_call = backend.draw_calls()[0];
+        DIVISION_CHECK(!draw_call.cleared);
+        // The clear pass of the regions, then the trimmed pass
+        DIVISION_CHECK(draw_call.passes.size() == 2);
+        DIVISION_CHECK(draw_call.passes[0].instance_count == 1);
+        DIVISION_CHECK(draw_call.passes[1].first_instance == 2 * BLOCK_INSTANCES);
+        DIVISION_CHECK(draw_call.passes[1].instance_count == BLOCK_INSTANCES);
+    }
+    backend.clear_draw_calls();
+
+    // The neighbouring blocks of a region are merged into a single run, and
+    // every region gets its own runs
+    damage.add(Rect::from_min_max(
+        glm::vec2 { BLOCK_WIDTH * 0.5f, 30 }, glm::vec2 { BLOCK_WIDTH * 1.5f, 34 }
+    ));
+    damage.add(block_point(3));
+    queue.draw(backend.context(), CLEAR_COLOR, damage, PRESERVED);
+    DIVISION_CHECK(backend.draw_calls().size() == 1);
+    if (backend.draw_calls().size() == 1)
+    {
+        const auto& draw_call = backend.draw_calls()[0];
+        DIVISION_CHECK(!draw_call.cleared);
+        DIVISION_CHECK(draw_call.passes.size() == 3);
+        DIVISION_CHECK(draw_call.passes[0].instance_count == 2);
+        DIVISION_CHECK(draw_call.passes[1].first_instance == 0);
+        DIVISION_CHECK(draw_call.passes[1].instance_count == 2 * BLOCK_INSTANCES);
+        DIVISION_CHECK(draw_call.passes[2].first_instance == 3 * BLOCK_INSTANCES);
+        DIVISION_CHECK(draw_call.passes[2].instance_count == BLOCK_INSTANCES);
+    }
+    backend.clear_draw_calls();
+
+    // A pass without blocks is redrawn whole
+    auto unblocked_pass = make_blocked_pass();
+    unblocked_pass.block_bounds.clear();
+    queue.retain_passes(&source, 0, { &unblocked_pass, 1 });
+    damage.add(block_point(1));
+    queue.draw(backend.context(), CLEAR_COLOR, damage, PRESERVED);
+    DIVISION_CHECK(backend.draw_calls().size() == 1);
+    if (backend.draw_calls().size() == 1)
+    {
+        const auto& draw_call = backend.draw_calls()[0];
+        DIVISION_CHECK(draw_call.passes.size() == 2);
+        DIVISION_CHECK(draw_call.passes[1].first_instance == 0);
+        DIVISION_CHECK(
+            draw_call.passes[1].instance_count == BLOCK_COUNT * BLOCK_INSTANCES
+        );
+    }
+    backend.clear_draw_calls();
+
+    // A damage over most of the screen clears and redraws the frame
+    damage.add(Rect::from_bottom_left(glm::vec2 { 0 }, SCREEN_SIZE));
+    queue.draw(backend.context(), CLEAR_COLOR, damage, PRESERVED);
+    DIVISION_CHECK(backend.draw_calls().size() == 1);
+    DIVISION_CHECK(!backend.draw_calls().empty() && backend.draw_calls()[0].cleared);
+
+    context.delete_uniform(screen_size_uniform_id);
+
+    return division_engine::tests::failure_count == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,118 @@
+#include "recording_backend.hpp"
+
+#include "division_engine/canvas/components/render_clip.hpp"
+#include "division_engine/canvas/rect.hpp"
+#include "division_engine/canvas/rect_drawer.hpp"
+#include "division_engine/canvas/render_manager.hpp"
+#include "division_engine/canvas/size.hpp"
+#include "division_engine/canvas/state.hpp"
+#include "division_engine/canvas/view_tree/clip.hpp"
+#include "division_engine/canvas/view_tree/decorated_box.hpp"
+#include "division_engine/canvas/view_tree/keyed_list.hpp"
+#include "division_engine/canvas/view_tree/render_entities.hpp"
+#include "division_engine/canvas/view_tree/scroll.hpp"
+#include "division_engine/canvas/view_tree/sized_box.hpp"
+#include "division_engine/color.hpp"
+
+#include <flecs.h>
+#include <glm/vec2.hpp>
+
+#include <cstdlib>
+#include <vector>
+
+using namespace division_engine;
+using namespace division_engine::canvas;
+using namespace division_engine::canvas::view_tree;
+using division_engine::tests::RecordingBackend;
+
+namespace
+{
+const auto SCREEN_SIZE = glm::vec2 { 512 };
+const auto SCREEN_RECT = Rect::from_bottom_left(glm::vec2 { 0 }, SCREEN_SIZE);
+const size_t ROW_COUNT = 1000;
+const float ROW_EXTENT = 20;
+
+using row_type = SizedBox<Clip<DecoratedBox>>;
+using tree_type = Scroll<KeyedList<int, row_type>>;
+
+tree_type make_tree(float offset)
+{
+    KeyedList<int, row_type> list;
+    for (size_t i = 0; i < ROW_COUNT; i++)
+    {
+        list.items.push_back(KeyedList<int, row_type>::Item {
+            .key = static_cast<int>(i),
+            .view = row_type {
+                Size { SCREEN_SIZE.x, ROW_EXTENT },
+                Clip { DecoratedBox { .background_color = color::RED } },
+            },
+        });
+    }
+
+    return tree_type { static_cast<float>(ROW_COUNT) * ROW_EXTENT, offset, list };
+}
+
+void draw_frame(
+    State& state,
+    RenderManager& render_manager,
+    tree_type::Renderer& renderer,
+    const tree_type& tree
+)
+{
+    auto rect = SCREEN_RECT;
+    state.update();
+    renderer.render(state, render_manager, rect, tree);
+    render_manager.update(state);
+    state.render_queue.draw(state.context.get_ptr(), state.clear_color);
+}
+
+uint32_t drawn_instance_count(const RecordingBackend& backend)
+{
+    uint32_t count = 0;
+    for (const auto& pass : backend.draw_calls().back().passes)
+    {
+        count += pass.instance_count;
+    }
+    return count;
+}
+}
+
+int main()
+{
+    RecordingBackend backend { SCREEN_SIZE };
+    State state { backend.context() };
+    RenderManager render_manager;
+    render_manager.register_renderer<RectDrawer>(state);
+
+    auto tree = make_tree(0);
+    tree_type::Renderer renderer { state, render_manager, tree };
+    draw_frame(state, render_manager, renderer, tree);
+
+    // Only the rows near the viewport are drawn
+    const auto visible_rows = static_cast<uint32_t>(SCREEN_SIZE.y / ROW_EXTENT);
+    DIVISION_CHECK(drawn_instance_count(backend) >= visible_rows);
+    DIVISION_CHECK(drawn_instance_count(backend) < ROW_COUNT / 2);
+
+    std::vector<flecs::entity> rows;
+    collect_render_entities(renderer, rows);
+    DIVISION_CHECK(rows.size() == ROW_COUNT);
+    const auto first_clip = rows[0].get<components::RenderClip>()->value;
+
+    // The clips are in the content space, so scrolling doesn't rewrite them
+    tree = make_tree(100);
+    draw_frame(state, render_manager, renderer, tree);
+    DIVISION_CHECK(rows[0].get<components::RenderClip>()->value == first_clip);
+    const auto& translations = state.scroll_translations;
+    DIVISION_CHECK(translations.offset(renderer.translation).y == 100);
+    DIVISION_CHECK(translations.viewport(renderer.translation) == SCREEN_RECT);
+
+    // Far from the culled rows the others are drawn instead
+    const auto version = translations.version();
+    tree = make_tree(10000);
+    draw_frame(state, render_manager, renderer, tree);
+    DIVISION_CHECK(translations.version() != version);
+    DIVISION_CHECK(drawn_instance_count(backend) >= visible_rows);
+    DIVISION_CHECK(drawn_instance_count(backend) < ROW_COUNT / 2);
+
+    return division_engine::tests::failure_count == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
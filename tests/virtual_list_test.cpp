@@ -0,0 +1,135 @@
+#include "recording_backend.hpp"
+
+#include "division_engine/canvas/components/render_bounds.hpp"
+#include "division_engine/canvas/components/render_order.hpp"
+#include "division_engine/canvas/flat_layout.hpp"
+#include "division_engine/canvas/rect.hpp"
+#include "division_engine/canvas/render_manager.hpp"
+#include "division_engine/canvas/state.hpp"
+#include "division_engine/canvas/view_tree/decorated_box.hpp"
+#include "division_engine/canvas/view_tree/flat_render.hpp"
+#include "division_engine/canvas/view_tree/list.hpp"
+#include "division_engine/canvas/view_tree/render_entities.hpp"
+#include "division_engine/canvas/view_tree/virtual_list.hpp"
+#include "division_engine/color.hpp"
+
+#include <flecs.h>
+#include <glm/vec2.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <tuple>
+#include <vector>
+
+using namespace division_engine;
+using namespace division_engine::canvas;
+using namespace division_engine::canvas::view_tree;
+using division_engine::tests::RecordingBackend;
+
+namespace
+{
+const auto SCREEN_SIZE = glm::vec2 { 512 };
+const auto SCREEN_RECT = Rect::from_bottom_left(glm::vec2 { 0 }, SCREEN_SIZE);
+const size_t ITEM_COUNT = 1000;
+const float ITEM_EXTENT = 20;
+const float EPSILON = 1e-3;
+
+using virtual_list_type = VirtualList<DecoratedBox>;
+// The overlay follows the list in the tree, so it is drawn above every row
+using tree_type = VerticalList<virtual_list_type, DecoratedBox>;
+
+tree_type make_tree(float scroll_offset)
+{
+    return tree_type {
+        virtual_list_type {
+            .item_count = ITEM_COUNT,
+            .item_extent = [](size_t) { return ITEM_EXTENT; },
+            .build_item = [](size_t)
+            { return DecoratedBox { .background_color = color::RED }; },
+            .scroll_offset = scroll_offset,
+        },
+        DecoratedBox { .background_color = color::BLUE },
+    };
+}
+
+uint64_t render_order_of(flecs::entity entity)
+{
+    return entity.get<components::RenderOrder>()->sort_key();
+}
+
+void check_overlay_on_top(const tree_type::Renderer& renderer)
+{
+    std::vector<flecs::entity> rows;
+    collect_render_entities(std::get<0>(renderer.children), rows);
+    DIVISION_CHECK(!rows.empty());
+
+    std::vector<flecs::entity> overlay;
+    collect_render_entities(std::get<1>(renderer.children), overlay);
+    DIVISION_CHECK(overlay.size() == 1);
+    if (overlay.size() != 1)
+    {
+        return;
+    }
+
+    for (auto row : rows)
+    {
+        DIVISION_CHECK(render_order_of(row) < render_order_of(overlay[0]));
+    }
+}
+}
+
+int main()
+{
+    RecordingBackend backend { SCREEN_SIZE };
+    State state { backend.context() };
+    RenderManager render_manager;
+
+    // The rows created and recycled while scrolling stay under the overlay
+    {
+        auto tree = make_tree(0);
+        tree_type::Renderer renderer { state, render_manager, tree };
+
+        for (const auto scroll_offset : { 0.f, 500.f, 510.f, 0.f, 5000.f })
+        {
+            tree = make_tree(scroll_offset);
+            auto rect = SCREEN_RECT;
+            renderer.render(state, render_manager, rect, tree);
+            check_overlay_on_top(renderer);
+        }
+    }
+
+    // The flat layout places the rows at their offsets from the scrolled start
+    {
+        const float scroll_offset = 105;
+        const auto tree = make_tree(scroll_offset);
+        tree_type::Renderer renderer { state, render_manager, tree };
+        FlatLayout layout;
+
+        // The first frame doesn't know the viewport extent yet
+        render_flat(state, render_manager, layout, renderer, tree, SCREEN_RECT);
+        render_flat(state, render_manager, layout, renderer, tree, SCREEN_RECT);
+        check_overlay_on_top(renderer);
+
+        const auto& list = std::get<0>(renderer.children);
+        const auto list_top = SCREEN_RECT.top();
+        const auto list_extent = SCREEN_SIZE.y / 2;
+        DIVISION_CHECK(list.viewport_extent == list_extent);
+        DIVISION_CHECK(
+            list.items.size() >= static_cast<size_t>(list_extent / ITEM_EXTENT)
+        );
+
+        std::vector<flecs::entity> rows;
+        collect_render_entities(list, rows);
+        for (size_t i = 0; i < rows.size(); i++)
+        {
+            const auto index = static_cast<float>(list.first_item + i);
+            const auto expected_top = list_top - (index * ITEM_EXTENT - scroll_offset);
+            const auto& bounds = rows[i].get<components::RenderBounds>()->value;
+            DIVISION_CHECK(std::abs(bounds.top() - expected_top) < EPSILON);
+            DIVISION_CHECK(std::abs(bounds.size().y - ITEM_EXTENT) < EPSILON);
+            DIVISION_CHECK(std::abs(bounds.size().x - SCREEN_SIZE.x) < EPSILON);
+        }
+    }
+
+    return division_engine::tests::failure_count == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}